@@ -0,0 +1,469 @@
+#include "engine/alloc-tracker.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace bty {
+
+/* About one allocation in this many has its stack sampled. */
+static constexpr uint32_t kSampleInterval = 4096;
+static constexpr int kStackDepth = 16;
+static constexpr size_t kMaxSites = 1024;
+static constexpr size_t kMaxScenes = 64;
+/* Stacks kept per watch; any more are only counted. */
+static constexpr int kMaxWatchStacks = 8;
+static constexpr size_t kNumTopSites = 10;
+/* Frames printed per call site, after operator new. */
+static constexpr int kFramesShown = 6;
+
+struct Stack {
+    void *frames[kStackDepth];
+    int depth;
+};
+
+struct Site {
+    Stack stack;
+    uint64_t samples;
+    uint64_t bytes;
+    uint64_t violations;
+    bool reported;
+};
+
+struct SceneTotals {
+    const char *name;
+    uint64_t frames;
+    uint64_t count;
+    uint64_t bytes;
+    uint64_t peak;
+};
+
+static std::atomic<uint64_t> sFrameCount {0};
+static std::atomic<uint64_t> sFrameBytes {0};
+static std::atomic<uint64_t> sNumViolations {0};
+static std::atomic<bool> sStrict {false};
+
+/* Sites are only touched when sampling or reporting, so one spin lock is
+    plenty, and a search over them is too. */
+static std::atomic_flag sSitesLock = ATOMIC_FLAG_INIT;
+static Site sSites[kMaxSites];
+static size_t sNumSites {0};
+
+/* Main thread only. */
+static SceneTotals sScenes[kMaxScenes];
+static size_t sNumScenes {0};
+static size_t sCurScene {kMaxScenes};
+
+/* Set while the hook or a report is running, so their own allocations
+    aren't counted. */
+static thread_local bool tUntracked {false};
+static thread_local uint32_t tUntilSample {kSampleInterval};
+static thread_local bool tWatching {false};
+static thread_local uint64_t tWatchCount {0};
+static thread_local Stack tWatchStacks[kMaxWatchStacks];
+static thread_local int tNumWatchStacks {0};
+
+class SitesLock {
+public:
+    SitesLock()
+    {
+        while (sSitesLock.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+    ~SitesLock()
+    {
+        sSitesLock.clear(std::memory_order_release);
+    }
+};
+
+static void captureStack(Stack &stack)
+{
+#if defined(__GLIBC__)
+    stack.depth = backtrace(stack.frames, kStackDepth);
+#elif defined(_WIN32)
+    stack.depth = CaptureStackBackTrace(0, kStackDepth, stack.frames, nullptr);
+#else
+    stack.depth = 0;
+#endif
+}
+
+/* Call with sSitesLock held. Returns null once the table is full. */
+static Site *findSite(const Stack &stack)
+{
+    for (size_t i = 0; i < sNumSites; i++) {
+        auto &site = sSites[i];
+        if (site.stack.depth == stack.depth && std::memcmp(site.stack.frames, stack.frames, sizeof(void *) * stack.depth) == 0) {
+            return &site;
+        }
+    }
+
+    if (sNumSites == kMaxSites) {
+        return nullptr;
+    }
+
+    auto &site = sSites[sNumSites++];
+    site = {};
+    site.stack = stack;
+    return &site;
+}
+
+/* Names need exported symbols (ENABLE_EXPORTS, i.e. -rdynamic); without
+    them, or off glibc, this is a list of addresses. */
+static std::string describe(const Stack &stack)
+{
+    std::string text;
+
+#if defined(__GLIBC__)
+    char **symbols = backtrace_symbols(stack.frames, stack.depth);
+    if (symbols) {
+        /* Skip the tracker itself, up to and including operator new. */
+        int first = 0;
+        for (int i = 0; i < stack.depth; i++) {
+            if (std::strstr(symbols[i], "(_Znw") || std::strstr(symbols[i], "(_Zna")) {
+                first = i + 1;
+            }
+        }
+
+        for (int i = first; i < stack.depth && i < first + kFramesShown; i++) {
+            text += fmt::format("\n    {}", symbols[i]);
+        }
+        std::free(symbols);
+        return text;
+    }
+#endif
+
+    for (int i = 0; i < stack.depth && i < kFramesShown; i++) {
+        text += fmt::format("\n    {}", stack.frames[i]);
+    }
+    return text;
+}
+
+[[maybe_unused]] static void noteAllocation(size_t size)
+{
+    if (tUntracked) {
+        return;
+    }
+    tUntracked = true;
+
+    sFrameCount.fetch_add(1, std::memory_order_relaxed);
+    sFrameBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (tWatching) {
+        tWatchCount++;
+        if (tNumWatchStacks < kMaxWatchStacks) {
+            captureStack(tWatchStacks[tNumWatchStacks++]);
+        }
+    }
+
+    if (--tUntilSample == 0) {
+        tUntilSample = kSampleInterval;
+
+        Stack stack;
+        captureStack(stack);
+
+        SitesLock lock;
+        if (auto *site = findSite(stack)) {
+            site->samples++;
+            site->bytes += size;
+        }
+    }
+
+    tUntracked = false;
+}
+
+void AllocTracker::setScene(const char *name)
+{
+    for (size_t i = 0; i < sNumScenes; i++) {
+        if (std::strcmp(sScenes[i].name, name) == 0) {
+            sCurScene = i;
+            return;
+        }
+    }
+
+    if (sNumScenes == kMaxScenes) {
+        sCurScene = kMaxScenes;
+        return;
+    }
+
+    sScenes[sNumScenes] = {name, 0, 0, 0, 0};
+    sCurScene = sNumScenes++;
+}
+
+AllocCounts AllocTracker::endFrame()
+{
+    AllocCounts counts;
+    counts.count = sFrameCount.exchange(0, std::memory_order_relaxed);
+    counts.bytes = sFrameBytes.exchange(0, std::memory_order_relaxed);
+
+    if (sCurScene < sNumScenes) {
+        auto &scene = sScenes[sCurScene];
+        scene.frames++;
+        scene.count += counts.count;
+        scene.bytes += counts.bytes;
+        scene.peak = std::max(scene.peak, counts.count);
+    }
+
+    return counts;
+}
+
+void AllocTracker::setStrict(bool strict)
+{
+    sStrict.store(strict, std::memory_order_relaxed);
+}
+
+bool AllocTracker::strict()
+{
+    return sStrict.load(std::memory_order_relaxed);
+}
+
+void AllocTracker::watch()
+{
+    tWatching = true;
+    tWatchCount = 0;
+    tNumWatchStacks = 0;
+}
+
+uint64_t AllocTracker::endWatch(bool steady)
+{
+    tWatching = false;
+
+    const auto count = tWatchCount;
+    if (!steady || count == 0) {
+        return count;
+    }
+
+    sNumViolations.fetch_add(count, std::memory_order_relaxed);
+
+    tUntracked = true;
+
+    std::vector<Stack> newSites;
+    {
+        SitesLock lock;
+        for (int i = 0; i < tNumWatchStacks; i++) {
+            auto *site = findSite(tWatchStacks[i]);
+            if (!site) {
+                continue;
+            }
+            site->violations++;
+            if (!site->reported) {
+                site->reported = true;
+                newSites.push_back(site->stack);
+            }
+        }
+    }
+
+    if (strict()) {
+        for (const auto &stack : newSites) {
+            spdlog::warn("AllocTracker: allocation in a steady frame ({} this frame) at:{}", count, describe(stack));
+        }
+    }
+
+    tUntracked = false;
+
+    return count;
+}
+
+uint64_t AllocTracker::numViolations()
+{
+    return sNumViolations.load(std::memory_order_relaxed);
+}
+
+void AllocTracker::dump()
+{
+    if (!kCompiledIn) {
+        return;
+    }
+
+    tUntracked = true;
+
+    spdlog::info("AllocTracker: {:<12} {:>7} {:>12} {:>10} {:>6}", "scene", "frames", "allocs/frame", "KB/frame", "peak");
+    for (size_t i = 0; i < sNumScenes; i++) {
+        const auto &scene = sScenes[i];
+        if (scene.frames == 0) {
+            continue;
+        }
+        spdlog::info("AllocTracker: {:<12} {:>7} {:>12.1f} {:>10.2f} {:>6}",
+                     scene.name,
+                     scene.frames,
+                     static_cast<double>(scene.count) / scene.frames,
+                     static_cast<double>(scene.bytes) / scene.frames / 1024.0,
+                     scene.peak);
+    }
+
+    std::vector<Site> sites;
+    {
+        SitesLock lock;
+        sites.assign(sSites, sSites + sNumSites);
+    }
+
+    std::sort(sites.begin(), sites.end(), [](const Site &a, const Site &b) {
+        return a.samples > b.samples;
+    });
+
+    for (size_t i = 0; i < sites.size() && i < kNumTopSites && sites[i].samples > 0; i++) {
+        spdlog::info("AllocTracker: ~{} allocations, ~{}K at:{}", sites[i].samples * kSampleInterval, sites[i].bytes * kSampleInterval / 1024, describe(sites[i].stack));
+    }
+
+    for (const auto &site : sites) {
+        if (site.violations > 0) {
+            spdlog::warn("AllocTracker: {} steady frames allocated at:{}", site.violations, describe(site.stack));
+        }
+    }
+
+    spdlog::info("AllocTracker: {} allocations in steady frames", numViolations());
+
+    tUntracked = false;
+}
+
+}    // namespace bty
+
+#ifdef BTY_TRACK_ALLOCS
+
+static void *allocate(std::size_t size)
+{
+    bty::noteAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+static void *allocateAligned(std::size_t size, std::align_val_t align)
+{
+    bty::noteAllocation(size);
+    const auto alignment = static_cast<std::size_t>(align);
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, alignment);
+#else
+    /* aligned_alloc wants a non-zero multiple of the alignment. */
+    return std::aligned_alloc(alignment, std::max(alignment, (size + alignment - 1) / alignment * alignment));
+#endif
+}
+
+static void freeAligned(void *ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void *operator new(std::size_t size)
+{
+    if (void *ptr = allocate(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    if (void *ptr = allocateAligned(size, align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t align)
+{
+    return operator new(size, align);
+}
+
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept
+{
+    return allocateAligned(size, align);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept
+{
+    return allocateAligned(size, align);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    freeAligned(ptr);
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef BTY_ENGINE_ALLOC_TRACKER_HPP_
+#define BTY_ENGINE_ALLOC_TRACKER_HPP_
+
+#include <cstdint>
+
+namespace bty {
+
+struct AllocCounts {
+    uint64_t count {0};
+    uint64_t bytes {0};
+};
+
+/* Counts heap allocations by replacing the global operator new, which only
+    happens when built with BTY_TRACK_ALLOCS. Without it every call here is a
+    no-op returning zeros.
+
+    Totals are kept per frame (all threads) and per scene, and one allocation
+    in every few thousand has its call stack sampled. Code that should not
+    allocate can be watched; what the watch catches in a steady frame is a
+    violation, with the stack recorded. */
+class AllocTracker {
+public:
+#ifdef BTY_TRACK_ALLOCS
+    static constexpr bool kCompiledIn = true;
+#else
+    static constexpr bool kCompiledIn = false;
+#endif
+
+    /* Scene the following frames are attributed to. The name must stay valid
+        until dump(). */
+    static void setScene(const char *name);
+    /* Returns the allocations made since the last call and adds them to the
+        current scene. */
+    static AllocCounts endFrame();
+
+    /* Logs each new violating call site as it is found. */
+    static void setStrict(bool strict);
+    static bool strict();
+
+    /* Watches allocations made on this thread until endWatch(). If the work
+        in between was steady they count as violations, otherwise they are
+        dropped. Returns how many there were either way. */
+    static void watch();
+    static uint64_t endWatch(bool steady);
+    static uint64_t numViolations();
+
+    /* Logs the per-scene totals, the busiest sampled call sites and every
+        violating one. */
+    static void dump();
+};
+
+}    // namespace bty
+
+#endif    // BTY_ENGINE_ALLOC_TRACKER_HPP_
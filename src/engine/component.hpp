@@ -1,6 +1,9 @@
 #ifndef BTY_ENGINE_COMPONENT_HPP
 #define BTY_ENGINE_COMPONENT_HPP
 
+#include <string>
+#include <vector>
+
 #include "engine/event-listener.hpp"
 
 class Component : public EventListener {
@@ -16,6 +19,16 @@ public:
     {
         return false;
     }
+    /* Textures load() will ask for, so they can be decoded ahead of time. */
+    virtual std::vector<std::string> getAssets() const
+    {
+        return {};
+    }
+    /* Holds state that must outlive a visit, so it is never evicted. */
+    virtual bool isPersistent() const
+    {
+        return false;
+    }
 };
 
 #endif    // BTY_ENGINE_COMPONENT_HPP
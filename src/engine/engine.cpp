@@ -2,27 +2,66 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <glm/gtc/matrix_transform.hpp>
-
+#include <sstream>
+
+#include "engine/frame-arena.hpp"
+#include "engine/job-system.hpp"
+#include "engine/metrics-server.hpp"
+#include "engine/profiler.hpp"
+#include "engine/task.hpp"
+#include "engine/timer-wheel.hpp"
 #include "game/ingame.hpp"
 #include "game/intro.hpp"
 #include "game/save.hpp"
+#include "game/state-mirror.hpp"
 #include "game/use-magic.hpp"
+#include "gfx/command-recorder.hpp"
 #include "gfx/gfx.hpp"
 #include "window/window.hpp"
 
 namespace bty {
 
+/* The simulation always advances in steps of kSimStep, however long frames
+    take. Rendering blends between the last two steps. */
+static constexpr float kSimStep = 1.0f / 60.0f;
+static_assert(kSimStep == TimerWheel::kTickSeconds, "the timer wheel ticks once per step");
+static constexpr int kMaxStepsPerFrame = 64;
+
+/* F4 cycles through these. Negative means as many steps as fit in
+    kUnlimitedBudget each frame. */
+static constexpr float kTimeScales[] = {0.0f, 1.0f, 2.0f, 8.0f, -1.0f};
+static constexpr const char *const kTimeScaleNames[] = {"PAUSED", "", "2X", "8X", "MAX"};
+static constexpr int kNumTimeScales = sizeof(kTimeScales) / sizeof(kTimeScales[0]);
+static constexpr std::chrono::milliseconds kUnlimitedBudget {12};
+
+static uint32_t microsecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
 Engine::Engine(Window &window)
-    : _inputLayer({.engine = this})
+    : _inputLayer {.engine = this}
     , _window(&window)
     , _view(glm::ortho(0.0f, 320.0f, 224.0f, 0.0f, -1.0f, 1.0f))
 {
+    BTY_PROFILE_ZONE("Engine::Engine");
+
     window_init_callbacks(_window, &_inputLayer);
     _btFPSLabel.create(1, 3, "FPS: ");
     _btFPS.create(5, 3, "");
+    _btTimeScale.create(33, 3, "");
+    for (int i = 0; i < 4; i++) {
+        _btFrameStats[i].create(1, 11 + i, "");
+    }
+    _btAllocs.create(1, 15, "");
+    for (int i = 0; i < static_cast<int>(GpuCategory::Count) + 1; i++) {
+        _btGpu[i].create(1, 4 + i, "");
+    }
 }
 
 void Engine::run()
@@ -31,123 +70,210 @@ void Engine::run()
 
     auto &sceneMan {SceneMan::instance()};
 
-    _ingame = new Ingame(*this);
-    _battle = new Battle(*this);
-    _garrison = new Garrison(*this);
-    _shop = new Shop(*this);
-    _town = new Town(*this);
-    _saveManager = new SaveManager(*this);
-    _saveManager->onLoad([this](const std::string &filename) {
-        loadState(filename);
-    });
-    _saveManager->onSave([this](const std::string &filename) {
-        saveState(filename);
-    });
+    /* Scenes are constructed the first time they are entered or asked for. */
+    auto createSaveManager = [this]() {
+        auto *saveManager = new SaveManager(*this);
+        saveManager->onLoad([this](const std::string &filename) {
+            loadState(filename);
+        });
+        saveManager->onSave([this](const std::string &filename) {
+            saveState(filename);
+        });
+        return saveManager;
+    };
 
     sceneMan.init(
 		_window, {
         {
             "intro",
-            new Intro(*this),
+            [this]() {
+                return new Intro(*this);
+            },
         },
         {
             "ingame",
-            _ingame,
+            [this]() {
+                return new Ingame(*this);
+            },
         },
         {
             "battle",
-            _battle,
+            [this]() {
+                return new Battle(*this);
+            },
         },
         {
             "victory",
-            new Victory(*this),
+            [this]() {
+                return new Victory(*this);
+            },
         },
         {
             "defeat",
-            new Defeat(*this),
+            [this]() {
+                return new Defeat(*this);
+            },
         },
         {
             "viewarmy",
-            new ViewArmy(*this),
+            [this]() {
+                return new ViewArmy(*this);
+            },
         },
         {
             "viewchar",
-            new ViewCharacter(*this),
+            [this]() {
+                return new ViewCharacter(*this);
+            },
         },
         {
             "viewcontinent",
-            new ViewContinent(*this),
+            [this]() {
+                return new ViewContinent(*this);
+            },
         },
         {
             "viewcontract",
-            new ViewContract(*this, _gui.getHUD().getContractSprite()),
+            [this]() {
+                return new ViewContract(*this, _gui.getHUD().getContractSprite());
+            },
         },
         {
             "viewpuzzle",
-            new ViewPuzzle(*this),
+            [this]() {
+                return new ViewPuzzle(*this);
+            },
         },
         {
             "controls",
-            new GameControls(*this),
+            [this]() {
+                return new GameControls(*this);
+            },
         },
         {
             "wizard",
-            new Wizard(*this),
+            [this]() {
+                return new Wizard(*this);
+            },
         },
         {
             "kingscastle",
-            new KingsCastle(*this),
+            [this]() {
+                return new KingsCastle(*this);
+            },
         },
         {
             "garrison",
-            _garrison,
+            [this]() {
+                return new Garrison(*this);
+            },
         },
         {
             "shop",
-            _shop,
+            [this]() {
+                return new Shop(*this);
+            },
         },
         {
             "town",
-            _town,
+            [this]() {
+                return new Town(*this);
+            },
         },
         {
             "usemagic",
-            new UseMagic(*this),
+            [this]() {
+                return new UseMagic(*this);
+            },
         },
         {
             "save",
-            _saveManager,
+            createSaveManager,
         },
     });
 
     sceneMan.setScene("intro");
 
+    /* Constructs Gfx, which must happen on this thread before the render
+        thread can use it. */
     GFX::instance().setView(_view);
 
+    _renderer.start(_window, _gameOptions.render_thread);
+    updateInstantWaits();
+    _flightRecorder.init(_gameOptions.slow_frame_ms);
+
     auto curTime = steady_clock::now();
     int frameCount = 0;
     int frameRate = 0;
+    float accumulator = 0;
 
     while (_run) {
+        BTY_PROFILE_ZONE("Engine::frame");
+
         auto lastTime = curTime;
         curTime = steady_clock::now();
         ++frameCount;
         if (time_point_cast<seconds>(curTime) != time_point_cast<seconds>(lastTime)) {
             frameRate = frameCount;
             frameCount = 0;
+            _frameStats.collect();
+            publishMetrics();
+            if (_gameOptions.debug) {
+                updateGpuStats();
+                updateFrameStats();
+            }
         }
 
         float dt = duration<float>(curTime - lastTime).count();
 
-        window_events(_window);
+        _frameStats.beginFrame();
 
-		_gui.update(dt);
-        sceneMan.update(dt);
+        window_events(_window);
+        drainInput();
+        collectInputLatency();
+        _frameStats.addPhase(FramePhase::Events, microsecondsSince(curTime));
+
+        const float timeScale = kTimeScales[_timeScale];
+
+        if (timeScale < 0) {
+            const auto budgetEnd = steady_clock::now() + kUnlimitedBudget;
+            do {
+                step();
+            } while (_run && steady_clock::now() < budgetEnd);
+            accumulator = 0;
+            Transformable::setInterpolation(1.0f);
+        }
+        else {
+            /* Clamp so a long hitch (loading, a breakpoint) doesn't turn into
+                a burst of catch-up steps. */
+            accumulator += std::min(dt, 0.25f) * timeScale;
+
+            int steps = 0;
+            while (accumulator >= kSimStep && steps < kMaxStepsPerFrame) {
+                step();
+                accumulator -= kSimStep;
+                steps++;
+            }
+
+            accumulator = std::min(accumulator, kSimStep);
+            Transformable::setInterpolation(accumulator / kSimStep);
+        }
 
         if (_gameOptions.debug) {
             _btFPS.setString(std::to_string(frameRate));
         }
 
+        if (_gameOptions.late_latch_input) {
+            const auto latchStart = steady_clock::now();
+            window_events(_window);
+            drainInput();
+            _frameStats.addPhase(FramePhase::Events, microsecondsSince(latchStart));
+        }
+
+        const auto renderStart = steady_clock::now();
+
+        const auto seq = _renderer.beginSnapshot().seq;
+
         GFX::instance().clear();
         sceneMan.render();
         _gui.render();
@@ -156,11 +282,66 @@ void Engine::run()
         if (_gameOptions.debug) {
             GFX::instance().drawText(_btFPSLabel);
             GFX::instance().drawText(_btFPS);
+            for (auto &text : _btGpu) {
+                GFX::instance().drawText(text);
+            }
+            for (auto &text : _btFrameStats) {
+                GFX::instance().drawText(text);
+            }
+            if (AllocTracker::kCompiledIn) {
+                GFX::instance().drawText(_btAllocs);
+            }
+        }
+
+        if (_timeScale != 1) {
+            GFX::instance().drawText(_btTimeScale);
+        }
+
+        _renderer.submit();
+
+        for (auto &input : _pendingInput) {
+            if (input.seq == 0) {
+                input.seq = seq;
+            }
+        }
+
+        _frameStats.addPhase(FramePhase::Render, microsecondsSince(renderStart));
+
+        const auto swapStart = steady_clock::now();
+        _renderer.pace(duration_cast<microseconds>(duration<float>(kSimStep)));
+        _frameStats.addPhase(FramePhase::Swap, microsecondsSince(swapStart));
+
+        const auto frameUs = microsecondsSince(curTime);
+        _frameStats.endFrame(frameUs);
+        _flightRecorder.endFrame(frameUs);
+
+        auto &metrics = Metrics::instance().getValues();
+        metrics.frames.fetch_add(1, std::memory_order_relaxed);
+
+        if (AllocTracker::kCompiledIn) {
+            _frameAllocs = AllocTracker::endFrame();
+            Profile::instance().counter("Allocations", static_cast<int64_t>(_frameAllocs.count));
+            metrics.allocations.fetch_add(_frameAllocs.count, std::memory_order_relaxed);
+            metrics.allocatedBytes.fetch_add(_frameAllocs.bytes, std::memory_order_relaxed);
         }
 
-        window_swap(_window);
+        /* Nothing from the frame arena may be held past this point. */
+        Profile::instance().counter("Frame arena bytes", static_cast<int64_t>(FrameArena::instance().used()));
+        FrameArena::instance().reset();
+
+        Profile::instance().endFrame();
     }
 
+    Profile::instance().finish();
+    _flightRecorder.deinit();
+
+    _renderer.stop();
+    Recorder::instance().stop();
+
+    exportFrameStats("frame-stats-last.csv");
+
+    /* The name points into the scene manager. */
+    Metrics::instance().getValues().scene.store("none", std::memory_order_relaxed);
     SceneMan::instance().deinit();
 }
 
@@ -185,6 +366,23 @@ void Engine::event(Event event)
             _gameOptions.debug = !_gameOptions.debug;
             return;
         }
+        else if (event.key == Key::F2) {
+            startCapture();
+            return;
+        }
+        else if (event.key == Key::F3) {
+            const auto stamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            exportFrameStats(fmt::format("frame-stats-{}.csv", stamp));
+            return;
+        }
+        else if (event.key == Key::F4) {
+            cycleTimeScale();
+            return;
+        }
+        else if (event.key == Key::F5) {
+            startTrace();
+            return;
+        }
         else if (event.key == Key::Q) {
             quit();
             return;
@@ -196,78 +394,256 @@ void Engine::event(Event event)
     }
 }
 
+void Engine::step()
+{
+    BTY_PROFILE_ZONE("Engine::step");
+
+    Transformable::beginSimStep();
+
+    auto start = std::chrono::steady_clock::now();
+    _gui.update(kSimStep);
+    _frameStats.addPhase(FramePhase::Gui, microsecondsSince(start));
+
+    start = std::chrono::steady_clock::now();
+    /* Timers run on scene time, which stands still during fades. */
+    const bool sceneTime = !SceneMan::instance().transitioning();
+    _scheduler.update(kSimStep);
+    SceneMan::instance().update(kSimStep);
+    if (sceneTime) {
+        Timers::instance().advance();
+    }
+    Metrics::instance().getValues().steps.fetch_add(1, std::memory_order_relaxed);
+    SharedState::instance().publish();
+    _frameStats.addPhase(FramePhase::Scene, microsecondsSince(start));
+
+    Transformable::endSimStep();
+}
+
+void Engine::drainInput()
+{
+    BTY_PROFILE_ZONE("Engine::drainInput");
+
+    InputEvent input;
+    while (_inputLayer.events.pop(input)) {
+        if (input.event.id == EventId::KeyDown) {
+            _pendingInput.push_back({input.time});
+        }
+        event(input.event);
+    }
+}
+
+void Engine::collectInputLatency()
+{
+    PresentedFrame frame;
+    while (_renderer.popPresented(frame)) {
+        std::erase_if(_pendingInput, [this, &frame](const PendingInput &input) {
+            if (input.seq == 0 || input.seq > frame.seq) {
+                return false;
+            }
+            const auto us = std::chrono::duration_cast<std::chrono::microseconds>(frame.time - input.time).count();
+            _frameStats.addInputLatency(static_cast<uint32_t>(us));
+            return true;
+        });
+    }
+}
+
+void Engine::cycleTimeScale()
+{
+    _timeScale = (_timeScale + 1) % kNumTimeScales;
+    _btTimeScale.setString(kTimeScaleNames[_timeScale]);
+    spdlog::info("Time scale: {}", _timeScale == 1 ? "1X" : kTimeScaleNames[_timeScale]);
+    updateInstantWaits();
+}
+
+void Engine::updateInstantWaits()
+{
+    /* Fast-forward skips scripted waits too, otherwise battles are still
+        paced by their delays. */
+    bty::Scheduler::setInstant(_gameOptions.instant_waits || kTimeScales[_timeScale] < 0);
+}
+
+void Engine::updateFrameStats()
+{
+    const auto &total = _frameStats.getHistogram(FramePhase::Total);
+
+    _btFrameStats[0].setString(fmt::format("p50  {:>6.2f}  p90  {:>6.2f}", total.percentile(50.0) / 1000.0f, total.percentile(90.0) / 1000.0f));
+    _btFrameStats[1].setString(fmt::format("p99  {:>6.2f}  p999 {:>6.2f}", total.percentile(99.0) / 1000.0f, total.percentile(99.9) / 1000.0f));
+    _btFrameStats[2].setString(fmt::format("max  {:>6.2f}  n {}", total.max() / 1000.0f, total.count()));
+
+    const auto &input = _frameStats.getInputLatency();
+    _btFrameStats[3].setString(fmt::format("input p50 {:>5.1f} p99 {:>5.1f}", input.percentile(50.0) / 1000.0f, input.percentile(99.0) / 1000.0f));
+
+    if (AllocTracker::kCompiledIn) {
+        _btAllocs.setString(fmt::format("alloc {:>5} {:>5}K steady {}", _frameAllocs.count, _frameAllocs.bytes / 1024, AllocTracker::numViolations()));
+    }
+}
+
+void Engine::exportFrameStats(const std::string &filename)
+{
+    if (!std::filesystem::exists("./stats")) {
+        if (!std::filesystem::create_directories("./stats")) {
+            spdlog::warn("Failed to create stats directory");
+            return;
+        }
+    }
+
+    _frameStats.collect();
+    _frameStats.exportCsv(fmt::format("stats/{}", filename));
+}
+
+void Engine::startCapture()
+{
+    if (!std::filesystem::exists("./captures")) {
+        if (!std::filesystem::create_directories("./captures")) {
+            spdlog::warn("Failed to create captures directory");
+            return;
+        }
+    }
+
+    const auto stamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    const auto path = fmt::format("captures/{}.btyc", stamp);
+
+    _renderer.requestCapture(path, _gameOptions.capture_frames, window_width(_window), window_height(_window));
+}
+
+void Engine::startTrace()
+{
+    const auto stamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    Profile::instance().capture(fmt::format("traces/{}.json", stamp), _gameOptions.trace_frames);
+}
+
+void Engine::updateGpuStats()
+{
+    auto &registry {GpuResources::instance()};
+
+    for (int i = 0; i < static_cast<int>(GpuCategory::Count); i++) {
+        const auto category = static_cast<GpuCategory>(i);
+        const auto &totals = registry.getTotals(category);
+        _btGpu[i].setString(fmt::format("{:<5} {:>4} {:>6}K", gpuCategoryName(category), totals.count, totals.bytes / 1024));
+    }
+
+    const auto totals = registry.getTotals();
+    _btGpu[static_cast<int>(GpuCategory::Count)].setString(fmt::format("GPU   {:>4} {:>6}K", totals.count, totals.bytes / 1024));
+}
+
+/* Once a second; the server only reads these, so anything that isn't an
+    atomic already is copied over here. */
+void Engine::publishMetrics()
+{
+    auto &metrics = Metrics::instance().getValues();
+
+    const auto &frameTimes = _frameStats.getHistogram(FramePhase::Total);
+    metrics.frameUsP50.store(frameTimes.percentile(50.0), std::memory_order_relaxed);
+    metrics.frameUsP90.store(frameTimes.percentile(90.0), std::memory_order_relaxed);
+    metrics.frameUsP99.store(frameTimes.percentile(99.0), std::memory_order_relaxed);
+    metrics.frameUsMax.store(frameTimes.max(), std::memory_order_relaxed);
+
+    for (int i = 0; i < static_cast<int>(GpuCategory::Count); i++) {
+        metrics.gpuBytes[i].store(GpuResources::instance().getTotals(static_cast<GpuCategory>(i)).bytes, std::memory_order_relaxed);
+    }
+
+    metrics.scene.store(SceneMan::instance().getCurrentSceneName(), std::memory_order_relaxed);
+}
+
 GUI &Engine::getGUI()
 {
     return _gui;
 }
 
+Scheduler &Engine::getScheduler()
+{
+    return _scheduler;
+}
+
 void Engine::startSiegeBattle(int castleId)
 {
+    Profile::instance().mark("Battle", fmt::format("siege, castle {}", castleId));
     SceneMan::instance().setScene("battle", true, [this, castleId]() {
-    	_battle->startSiegeBattle(castleId);
+    	SceneMan::instance().getScene<Battle>("battle")->startSiegeBattle(castleId);
 	});
 }
 
 void Engine::startEncounterBattle(int mobId)
 {
+    Profile::instance().mark("Battle", fmt::format("encounter, mob {}", mobId));
     SceneMan::instance().setScene("battle", true, [this, mobId]() {
-		_battle->startEncounterBattle(mobId);
+		SceneMan::instance().getScene<Battle>("battle")->startEncounterBattle(mobId);
 	});
 }
 
 void Engine::winSiegeBattle(int castleId)
 {
-    SceneMan::instance().setScene("ingame", true);
-    _ingame->winSiegeBattle(castleId);
+    Metrics::instance().getValues().battles.fetch_add(1, std::memory_order_relaxed);
+    _scheduler.spawn(winSiegeSequence(castleId));
 }
 
 void Engine::winEncounterBattle(int mobId)
 {
-    SceneMan::instance().setScene("ingame", true);
-    _ingame->winEncounterBattle(mobId);
+    Metrics::instance().getValues().battles.fetch_add(1, std::memory_order_relaxed);
+    _scheduler.spawn(winEncounterSequence(mobId));
+}
+
+Task Engine::winSiegeSequence(int castleId)
+{
+    co_await SceneMan::instance().fadeTo(_scheduler, "ingame");
+    /* Opened only once the overworld is back, or the end of the fade
+        would replace the garrison with it. */
+    SceneMan::instance().getScene<Ingame>("ingame")->winSiegeBattle(castleId);
+}
+
+Task Engine::winEncounterSequence(int mobId)
+{
+    co_await SceneMan::instance().fadeTo(_scheduler, "ingame");
+    SceneMan::instance().getScene<Ingame>("ingame")->winEncounterBattle(mobId);
 }
 
 void Engine::acceptWizardOffer()
 {
     SceneMan::instance().setScene("ingame");
-    _ingame->acceptWizardOffer();
+    SceneMan::instance().getScene<Ingame>("ingame")->acceptWizardOffer();
 }
 
 void Engine::openGarrison(int castleId)
 {
-    _garrison->setCastle(castleId);
+    SceneMan::instance().getScene<Garrison>("garrison")->setCastle(castleId);
     SceneMan::instance().setScene("garrison");
 }
 
 void Engine::openShop(ShopInfo &info)
 {
-    _shop->setShop(info);
+    SceneMan::instance().getScene<Shop>("shop")->setShop(info);
     SceneMan::instance().setScene("shop");
 }
 
 void Engine::openTown(TownGen *info)
 {
-    _town->setTown(info);
+    SceneMan::instance().getScene<Town>("town")->setTown(info);
     SceneMan::instance().setScene("town");
 }
 
 void Engine::setBoatPosition(float x, float y)
 {
-    _ingame->setBoatPosition(x, y);
+    SceneMan::instance().getScene<Ingame>("ingame")->setBoatPosition(x, y);
 }
 
 void Engine::loseBattle()
 {
-    _ingame->disgrace();
+    Metrics::instance().getValues().battles.fetch_add(1, std::memory_order_relaxed);
+    SceneMan::instance().getScene<Ingame>("ingame")->disgrace();
     SceneMan::instance().setScene("ingame", true);
 }
 
 void Engine::loadState(const std::string &filename)
 {
+    BTY_PROFILE_ZONE("Engine::loadState");
+    Profile::instance().mark("Load", filename);
+
     const auto path = fmt::format("saves/{}", filename);
 
     spdlog::info("Loading from {}", path);
 
+    Jobs::instance().wait(_saveWrites);
+
     std::ifstream f(path, std::ios::in | std::ios::binary);
 
     if (!f.good()) {
@@ -275,28 +651,63 @@ void Engine::loadState(const std::string &filename)
         return;
     }
 
-    _ingame->loadState(f);
+    SceneMan::instance().getScene<Ingame>("ingame")->loadState(f);
 }
 
 void Engine::saveState(const std::string &filename)
 {
+    BTY_PROFILE_ZONE("Engine::saveState");
+    Profile::instance().mark("Save", filename);
+
     const auto path = fmt::format("saves/{}", filename);
 
     spdlog::info("Saving to {}", path);
 
-    std::ofstream f(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    /* Serializing needs the game state as it is now, but writing the file
+        can happen in the background. */
+    std::ostringstream buffer(std::ios::out | std::ios::binary);
+    SceneMan::instance().getScene<Ingame>("ingame")->saveState(buffer);
 
-    if (!f.good()) {
-        spdlog::warn("Failed to open file '{}' for saving", path);
-        return;
-    }
+    /* One write at a time, so two saves to a slot can't interleave. */
+    Jobs::instance().wait(_saveWrites);
+
+    auto write = [path, data = buffer.str()]() {
+        BTY_PROFILE_ZONE("Engine::saveState write");
 
-    _ingame->saveState(f);
+        /* Written aside and renamed over the slot, so nothing ever
+            reads a half written save. */
+        const auto tempPath = path + ".tmp";
+
+        {
+            std::ofstream f(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+            if (!f.good()) {
+                spdlog::warn("Failed to open file '{}' for saving", tempPath);
+                return;
+            }
+
+            f.write(data.data(), data.size());
+
+            if (!f.good()) {
+                spdlog::warn("Failed to write '{}'", tempPath);
+                return;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            spdlog::warn("Failed to move '{}' to '{}': {}", tempPath, path, ec.message());
+        }
+    };
+    Jobs::instance().submit(write, &_saveWrites);
 }
 
 void Engine::openSaveManager(bool toLoad)
 {
-    _saveManager->setMode(toLoad);
+    /* The slot list should show the last save. */
+    Jobs::instance().wait(_saveWrites);
+    SceneMan::instance().getScene<SaveManager>("save")->setMode(toLoad);
     SceneMan::instance().setScene("save");
 }
 
@@ -1,19 +1,22 @@
 #ifndef BTY_ENGINE_ENGINE_HPP_
 #define BTY_ENGINE_ENGINE_HPP_
 
+#include <chrono>
+#include <vector>
+
+#include "engine/alloc-tracker.hpp"
 #include "engine/events.hpp"
+#include "engine/flight-recorder.hpp"
+#include "engine/frame-stats.hpp"
 #include "engine/gui.hpp"
+#include "engine/job-system.hpp"
 #include "engine/scene-manager.hpp"
 #include "game/game-options.hpp"
 #include "gfx/gfx.hpp"
+#include "gfx/gpu-registry.hpp"
+#include "gfx/renderer.hpp"
 #include "window/window-engine-interface.hpp"
 
-class Battle;
-class Ingame;
-class Garrison;
-class Shop;
-class Town;
-class SaveManager;
 struct ShopInfo;
 struct TownGen;
 
@@ -30,6 +33,8 @@ public:
     void event(Event event);
     GameOptions &getGameOptions();
     GUI &getGUI();
+    /* For sequences that outlive the scene that starts them. */
+    Scheduler &getScheduler();
 
     void startSiegeBattle(int castleId);
     void startEncounterBattle(int mobId);
@@ -50,25 +55,52 @@ public:
 
     void openSaveManager(bool toLoad);
 
+private:
+    void startCapture();
+    void startTrace();
+    void updateGpuStats();
+    void step();
+    void cycleTimeScale();
+    void updateInstantWaits();
+    void updateFrameStats();
+    void publishMetrics();
+    void exportFrameStats(const std::string &filename);
+    void drainInput();
+    void collectInputLatency();
+    Task winSiegeSequence(int castleId);
+    Task winEncounterSequence(int mobId);
+
 private:
     InputHandler _inputLayer;
     Window *_window {nullptr};
     glm::mat4 _view;
     GUI _gui;
+    Scheduler _scheduler;
     bool _run {true};
 
     Text _btFPSLabel;
     Text _btFPS;
+    Text _btGpu[static_cast<int>(GpuCategory::Count) + 1];
+    Text _btTimeScale;
+    Text _btFrameStats[4];
+    Text _btAllocs;
+    AllocCounts _frameAllocs;
+    int _timeScale {1};
+    FrameStats _frameStats;
+    FlightRecorder _flightRecorder;
+    /* The save file being written in the background, if any. */
+    JobCounter _saveWrites;
+    Renderer _renderer;
+
+    /* Handled key presses, tagged with the first snapshot recorded after
+        them once it is submitted (0 until then). */
+    struct PendingInput {
+        std::chrono::steady_clock::time_point time;
+        uint64_t seq {0};
+    };
+    std::vector<PendingInput> _pendingInput;
 
     GameOptions _gameOptions;
-
-    /* Components */
-    Battle *_battle;
-    Ingame *_ingame;
-    Garrison *_garrison;
-    Shop *_shop;
-    Town *_town;
-    SaveManager *_saveManager;
 };
 
 }    // namespace bty
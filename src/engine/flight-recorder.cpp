@@ -0,0 +1,88 @@
+#include "engine/flight-recorder.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+
+#include "engine/profiler.hpp"
+#include "gfx/gpu-registry.hpp"
+
+namespace bty {
+
+/* Dumps cover this much before the slow frame and this many frames after. */
+static constexpr int64_t kSecondsBefore = 3;
+static constexpr int kFramesAfter = 30;
+/* Keeps a run of hitches (or the dump itself) from filling the disk. */
+static constexpr int64_t kMinSecondsBetweenDumps = 10;
+static constexpr int kMaxDumps = 16;
+
+static constexpr int64_t kNsPerSecond = 1'000'000'000;
+
+void FlightRecorder::init(float budgetMs)
+{
+    _active = budgetMs > 0.0f;
+    if (!_active) {
+        return;
+    }
+
+    _budgetUs = static_cast<uint64_t>(budgetMs * 1000.0f);
+    Profile::instance().setRetained(true);
+
+    spdlog::info("FlightRecorder: dumping frames over {:.1f}ms", budgetMs);
+}
+
+void FlightRecorder::deinit()
+{
+    if (_active) {
+        Profile::instance().setRetained(false);
+        _active = false;
+    }
+}
+
+void FlightRecorder::endFrame(uint64_t frameUs)
+{
+    if (!_active) {
+        return;
+    }
+
+    _numFrames++;
+
+    Profile::instance().counter("GL upload bytes", static_cast<int64_t>(GpuResources::instance().takeUploads()));
+
+    if (_framesUntilDump > 0) {
+        if (--_framesUntilDump == 0) {
+            dump();
+        }
+        return;
+    }
+
+    if (frameUs <= _budgetUs || _numDumps >= kMaxDumps) {
+        return;
+    }
+
+    const auto now = Profiler::now();
+    if (_lastDumpNs != 0 && now - _lastDumpNs < kMinSecondsBetweenDumps * kNsPerSecond) {
+        return;
+    }
+
+    Profile::instance().mark("Slow frame", fmt::format("{:.2f}ms", frameUs / 1000.0));
+
+    _slowFrame = _numFrames;
+    _slowFrameUs = frameUs;
+    _slowFrameStartNs = now - static_cast<int64_t>(frameUs) * 1000;
+    _framesUntilDump = kFramesAfter;
+    _lastDumpNs = now;
+}
+
+void FlightRecorder::dump()
+{
+    const auto stamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    const auto path = fmt::format("flight/{}-frame{}.json", stamp, _slowFrame);
+
+    spdlog::warn("FlightRecorder: frame {} took {:.2f}ms, writing {}", _slowFrame, _slowFrameUs / 1000.0, path);
+
+    Profile::instance().writeTrace(path, _slowFrameStartNs - kSecondsBefore * kNsPerSecond, Profiler::now());
+    _numDumps++;
+}
+
+}    // namespace bty
@@ -0,0 +1,35 @@
+#ifndef BTY_ENGINE_FLIGHT_RECORDER_HPP_
+#define BTY_ENGINE_FLIGHT_RECORDER_HPP_
+
+#include <cstdint>
+
+namespace bty {
+
+/* Keeps the profiler recording all the time and, when a frame goes over
+    budget, writes the seconds around it to flight/ as a Chrome trace, the
+    same format F5 captures use. */
+class FlightRecorder {
+public:
+    /* A budget of zero or less leaves the recorder off. */
+    void init(float budgetMs);
+    void deinit();
+    void endFrame(uint64_t frameUs);
+
+private:
+    void dump();
+
+private:
+    bool _active {false};
+    uint64_t _budgetUs {0};
+    uint64_t _numFrames {0};
+    uint64_t _slowFrame {0};
+    uint64_t _slowFrameUs {0};
+    int64_t _slowFrameStartNs {0};
+    int _framesUntilDump {-1};
+    int64_t _lastDumpNs {0};
+    int _numDumps {0};
+};
+
+}    // namespace bty
+
+#endif    // BTY_ENGINE_FLIGHT_RECORDER_HPP_
@@ -0,0 +1,83 @@
+#include "engine/frame-arena.hpp"
+
+#include <cstdint>
+
+namespace bty {
+
+Arena::Arena(size_t blockSize)
+    : _blockSize(blockSize)
+{
+}
+
+void *Arena::allocate(size_t bytes, size_t alignment)
+{
+    while (_current < _blocks.size()) {
+        auto &block = _blocks[_current];
+        const auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        const auto start = ((base + _offset + alignment - 1) & ~(alignment - 1)) - base;
+        if (start + bytes <= block.size) {
+            _offset = start + bytes;
+            return block.data.get() + start;
+        }
+
+        /* Blocks left over from a rewind are reused before growing. */
+        _current++;
+        _offset = 0;
+    }
+
+    /* Sized so the allocation fits whatever the block's own alignment. */
+    const auto lastSize = _blocks.empty() ? _blockSize / 2 : _blocks.back().size;
+    const auto size = std::max({_blockSize, lastSize * 2, bytes + alignment});
+
+    _blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    _current = _blocks.size() - 1;
+    _offset = 0;
+
+    return allocate(bytes, alignment);
+}
+
+Arena::Mark Arena::mark() const
+{
+    return {_current, _offset};
+}
+
+void Arena::rewind(Mark mark)
+{
+    _current = mark.block;
+    _offset = mark.offset;
+}
+
+void Arena::reset()
+{
+    if (_blocks.size() > 1) {
+        size_t total = 0;
+        for (const auto &block : _blocks) {
+            total += block.size;
+        }
+        _blocks.clear();
+        _blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[total]), total});
+    }
+
+    _current = 0;
+    _offset = 0;
+}
+
+size_t Arena::used() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < _current && i < _blocks.size(); i++) {
+        total += _blocks[i].size;
+    }
+    return total + _offset;
+}
+
+size_t Arena::capacity() const
+{
+    size_t total = 0;
+    for (const auto &block : _blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+}    // namespace bty
@@ -0,0 +1,154 @@
+#ifndef BTY_ENGINE_FRAME_ARENA_HPP_
+#define BTY_ENGINE_FRAME_ARENA_HPP_
+
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "engine/singleton.hpp"
+
+namespace bty {
+
+/* Bump allocator: allocating moves a pointer, freeing does nothing and
+    reset() drops everything at once. When a block fills up another, bigger
+    one is chained on; the next reset() merges them so later rounds fit in
+    one block and stop touching the heap.
+
+    A local Arena is a scratch arena for load-time work, released when it
+    goes out of scope. The engine resets FrameArena at the end of every
+    frame. Neither is thread-safe. */
+class Arena {
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit Arena(size_t blockSize = kDefaultBlockSize);
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T *allocate(size_t count)
+    {
+        return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    /* Everything allocated after mark() is released by rewind(). */
+    Mark mark() const;
+    void rewind(Mark mark);
+    void reset();
+
+    size_t used() const;
+    size_t capacity() const;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> _blocks;
+    size_t _blockSize;
+    size_t _current {0};
+    size_t _offset {0};
+};
+
+/* Rewinds an arena to where it was when the scope was entered. */
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena &arena)
+        : _arena(arena)
+        , _mark(arena.mark())
+    {
+    }
+    ~ArenaScope()
+    {
+        _arena.rewind(_mark);
+    }
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+    Arena &_arena;
+    Arena::Mark _mark;
+};
+
+/* Lets standard containers allocate from an arena. Default constructed it
+    uses the frame arena. Memory is only given back when the arena is reset
+    or rewound, so containers that grow a lot should reserve up front. */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept
+        : _arena(&SingletonProvider<Arena>::instance())
+    {
+    }
+    explicit ArenaAllocator(Arena &arena) noexcept
+        : _arena(&arena)
+    {
+    }
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+        : _arena(other.arena())
+    {
+    }
+
+    T *allocate(size_t count)
+    {
+        return _arena->allocate<T>(count);
+    }
+    void deallocate(T *, size_t) noexcept
+    {
+    }
+
+    Arena *arena() const noexcept
+    {
+        return _arena;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const noexcept
+    {
+        return _arena == other.arena();
+    }
+
+private:
+    Arena *_arena;
+};
+
+/* Only valid until the end of the frame. */
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+/* Formats into the frame arena. Short strings format on the stack first,
+    so nothing touches the heap. */
+template <typename... Args>
+std::string_view frameFormat(fmt::format_string<Args...> format, Args &&...args)
+{
+    fmt::memory_buffer buffer;
+    fmt::format_to(std::back_inserter(buffer), format, std::forward<Args>(args)...);
+
+    auto *data = SingletonProvider<Arena>::instance().allocate<char>(buffer.size());
+    std::copy(buffer.begin(), buffer.end(), data);
+    return {data, buffer.size()};
+}
+
+}    // namespace bty
+
+using FrameArena = bty::SingletonProvider<bty::Arena>;
+
+#endif    // BTY_ENGINE_FRAME_ARENA_HPP_
@@ -0,0 +1,222 @@
+#include "engine/frame-stats.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+
+namespace bty {
+
+static constexpr const char *const kPhaseNames[] = {
+    "events",
+    "gui",
+    "scene",
+    "render",
+    "swap",
+    "total",
+};
+
+static constexpr double kPercentiles[] = {50.0, 90.0, 99.0, 99.9};
+static constexpr const char *const kPercentileNames[] = {"p50", "p90", "p99", "p99.9"};
+
+int FrameHistogram::bucketOf(uint32_t us)
+{
+    if (us < 2 * kSubCount) {
+        return static_cast<int>(us);
+    }
+    const int shift = std::bit_width(us) - 1 - kSubBits;
+    return (shift + 1) * kSubCount + static_cast<int>((us >> shift) - kSubCount);
+}
+
+uint32_t FrameHistogram::bucketValue(int bucket)
+{
+    if (bucket < 2 * kSubCount) {
+        return static_cast<uint32_t>(bucket);
+    }
+    /* Middle of the bucket's range. */
+    const int shift = bucket / kSubCount - 1;
+    const uint32_t low = static_cast<uint32_t>(bucket % kSubCount + kSubCount) << shift;
+    return low + ((1u << shift) >> 1);
+}
+
+void FrameHistogram::add(uint32_t us)
+{
+    _buckets[bucketOf(us)]++;
+    _count++;
+    _max = std::max(_max, us);
+}
+
+uint32_t FrameHistogram::percentile(double p) const
+{
+    if (_count == 0) {
+        return 0;
+    }
+
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100.0 * _count + 0.5));
+    uint64_t seen = 0;
+
+    for (int i = 0; i < kNumBuckets; i++) {
+        seen += _buckets[i];
+        if (seen >= rank) {
+            return std::min(bucketValue(i), _max);
+        }
+    }
+
+    return _max;
+}
+
+uint32_t FrameHistogram::max() const
+{
+    return _max;
+}
+
+uint64_t FrameHistogram::count() const
+{
+    return _count;
+}
+
+void FrameHistogram::reset()
+{
+    _buckets.fill(0);
+    _count = 0;
+    _max = 0;
+}
+
+void FrameStats::beginFrame()
+{
+    _current = {};
+    _current.frame = _frame++;
+}
+
+void FrameStats::addPhase(FramePhase phase, uint32_t us)
+{
+    _current.us[static_cast<int>(phase)] += us;
+}
+
+void FrameStats::endFrame(uint32_t totalUs)
+{
+    _current.us[static_cast<int>(FramePhase::Total)] = totalUs;
+    if (!_ring.push(_current)) {
+        _dropped++;
+    }
+}
+
+void FrameStats::addInputLatency(uint32_t us)
+{
+    _inputLatency.add(us);
+}
+
+void FrameStats::collect()
+{
+    if (_history.empty()) {
+        _history.resize(kHistorySize);
+    }
+
+    FrameSample sample;
+    while (_ring.pop(sample)) {
+        for (int i = 0; i < kNumFramePhases; i++) {
+            _histograms[i].add(sample.us[i]);
+        }
+
+        _history[_historyHead++ % kHistorySize] = sample;
+
+        const auto total = static_cast<int>(FramePhase::Total);
+        if (_worst.size() < kNumWorst || sample.us[total] > _worst.back().us[total]) {
+            auto it = std::upper_bound(_worst.begin(), _worst.end(), sample, [total](const FrameSample &a, const FrameSample &b) {
+                return a.us[total] > b.us[total];
+            });
+            _worst.insert(it, sample);
+            if (_worst.size() > kNumWorst) {
+                _worst.pop_back();
+            }
+        }
+    }
+}
+
+const FrameHistogram &FrameStats::getHistogram(FramePhase phase) const
+{
+    return _histograms[static_cast<int>(phase)];
+}
+
+const FrameHistogram &FrameStats::getInputLatency() const
+{
+    return _inputLatency;
+}
+
+const std::vector<FrameSample> &FrameStats::getWorst() const
+{
+    return _worst;
+}
+
+bool FrameStats::exportCsv(const std::string &path) const
+{
+    std::ofstream f(path, std::ios::out | std::ios::trunc);
+
+    if (!f.good()) {
+        spdlog::warn("FrameStats: failed to open '{}' for writing", path);
+        return false;
+    }
+
+    /* One table: percentile rows, then the worst frames, then the recent
+        history, all with a column per phase. Input latency isn't per frame,
+        so only the percentile rows fill its column. */
+    f << "row,frame";
+    for (const auto *name : kPhaseNames) {
+        f << ',' << name << "_ms";
+    }
+    f << ",input_latency_ms\n";
+
+    auto writeRow = [&f](const std::string &row, const std::string &frame, auto &&valueOf, const std::string &input = "") {
+        f << row << ',' << frame;
+        for (int i = 0; i < kNumFramePhases; i++) {
+            f << ',' << fmt::format("{:.3f}", valueOf(i) / 1000.0);
+        }
+        f << ',' << input << '\n';
+    };
+
+    for (int p = 0; p < 4; p++) {
+        const auto input = fmt::format("{:.3f}", _inputLatency.percentile(kPercentiles[p]) / 1000.0);
+        writeRow(
+            kPercentileNames[p], "", [&](int i) {
+                return _histograms[i].percentile(kPercentiles[p]);
+            },
+            input);
+    }
+    writeRow(
+        "max", "", [&](int i) {
+            return _histograms[i].max();
+        },
+        fmt::format("{:.3f}", _inputLatency.max() / 1000.0));
+
+    for (const auto &sample : _worst) {
+        writeRow("worst", std::to_string(sample.frame), [&](int i) {
+            return sample.us[i];
+        });
+    }
+
+    const size_t numHistory = std::min(_historyHead, kHistorySize);
+    for (size_t n = 0; n < numHistory; n++) {
+        const auto &sample = _history[(_historyHead - numHistory + n) % kHistorySize];
+        writeRow("frame", std::to_string(sample.frame), [&](int i) {
+            return sample.us[i];
+        });
+    }
+
+    spdlog::info("FrameStats: wrote {} frames to '{}' ({} dropped)", _histograms[0].count(), path, _dropped);
+
+    return true;
+}
+
+void FrameStats::reset()
+{
+    for (auto &histogram : _histograms) {
+        histogram.reset();
+    }
+    _inputLatency.reset();
+    _historyHead = 0;
+    _worst.clear();
+    _dropped = 0;
+}
+
+}    // namespace bty
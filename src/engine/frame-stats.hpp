@@ -0,0 +1,89 @@
+#ifndef BTY_ENGINE_FRAME_STATS_HPP_
+#define BTY_ENGINE_FRAME_STATS_HPP_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/spsc-ring.hpp"
+
+namespace bty {
+
+enum class FramePhase {
+    Events,
+    Gui,
+    Scene,
+    Render,
+    Swap,
+    Total,
+    Count,
+};
+
+inline constexpr int kNumFramePhases = static_cast<int>(FramePhase::Count);
+
+struct FrameSample {
+    uint64_t frame {0};
+    std::array<uint32_t, kNumFramePhases> us {};
+};
+
+/* Log-linear histogram of microsecond values, 128 linear buckets per power of
+    two, so any value up to ~71 minutes is reported within 1%. */
+class FrameHistogram {
+public:
+    void add(uint32_t us);
+    uint32_t percentile(double p) const;
+    uint32_t max() const;
+    uint64_t count() const;
+    void reset();
+
+private:
+    static constexpr int kSubBits = 7;
+    static constexpr int kSubCount = 1 << kSubBits;
+    static constexpr int kNumBuckets = (32 - kSubBits + 1) * kSubCount;
+
+    static int bucketOf(uint32_t us);
+    static uint32_t bucketValue(int bucket);
+
+    std::array<uint32_t, kNumBuckets> _buckets {};
+    uint64_t _count {0};
+    uint32_t _max {0};
+};
+
+/* Per-frame phase timings. The frame loop fills in a sample and submits it
+    to a lock-free ring; collect() drains the ring into the histograms, the
+    recent history and the worst-frame list. */
+class FrameStats {
+public:
+    void beginFrame();
+    void addPhase(FramePhase phase, uint32_t us);
+    void endFrame(uint32_t totalUs);
+    /* Time from an input event to the present of the first frame to reflect it. */
+    void addInputLatency(uint32_t us);
+
+    void collect();
+    const FrameHistogram &getHistogram(FramePhase phase) const;
+    const FrameHistogram &getInputLatency() const;
+    const std::vector<FrameSample> &getWorst() const;
+    bool exportCsv(const std::string &path) const;
+    void reset();
+
+private:
+    static constexpr size_t kHistorySize = 8192;
+    static constexpr size_t kNumWorst = 16;
+
+    FrameSample _current;
+    uint64_t _frame {0};
+    uint64_t _dropped {0};
+    SpscRing<FrameSample, 1024> _ring;
+
+    std::array<FrameHistogram, kNumFramePhases> _histograms;
+    FrameHistogram _inputLatency;
+    std::vector<FrameSample> _history;
+    size_t _historyHead {0};
+    std::vector<FrameSample> _worst;
+};
+
+}    // namespace bty
+
+#endif    // BTY_ENGINE_FRAME_STATS_HPP_
@@ -4,6 +4,7 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "engine/profiler.hpp"
 #include "game/state.hpp"
 #include "gfx/gfx.hpp"
 
@@ -17,6 +18,7 @@ GUI::GUI()
 void GUI::pushDialog(Dialog &dialog)
 {
     _dialogs.push_back(&dialog);
+    Profile::instance().mark("Dialog", fmt::format("{} open", _dialogs.size()));
 }
 
 void GUI::popDialog()
@@ -1,8 +1,11 @@
 #ifndef BTY_GUI_HPP
 #define BTY_GUI_HPP
 
+#include <memory>
+
 #include "engine/component.hpp"
 #include "engine/dialog.hpp"
+#include "engine/task.hpp"
 #include "game/hud.hpp"
 
 namespace bty {
@@ -22,6 +25,45 @@ public:
     void showMessage(int x, int y, int w, int h, const std::string &message);
     std::shared_ptr<Dialog> makeDialog(int x, int y, int w, int h, bool backspacePops = true);
 
+    /* co_await-able: shows the dialog until Enter or Backspace is pressed,
+        then pops it and resumes with the selection, or -1 for Backspace.
+        Replaces the dialog's Enter and Backspace bindings. */
+    auto confirm(Scheduler &scheduler, Dialog &dialog)
+    {
+        struct ConfirmAwaiter {
+            GUI &gui;
+            Scheduler &scheduler;
+            Dialog &dialog;
+            /* Shared with the bindings, which outlive the wait. */
+            std::shared_ptr<int> selection {std::make_shared<int>(-1)};
+
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                auto resume = scheduler.resumer(handle);
+                dialog.bind(Key::Enter, [gui = &gui, selection = selection, resume](int opt) {
+                    *selection = opt;
+                    gui->popDialog();
+                    resume();
+                });
+                dialog.bind(Key::Backspace, [gui = &gui, selection = selection, resume](int) {
+                    *selection = -1;
+                    gui->popDialog();
+                    resume();
+                });
+                gui.pushDialog(dialog);
+            }
+            int await_resume() noexcept
+            {
+                return *selection;
+            }
+        };
+        return ConfirmAwaiter {*this, scheduler, dialog};
+    }
+
 private:
     Hud _hud;
     bool _hudVisible {false};
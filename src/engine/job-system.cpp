@@ -0,0 +1,313 @@
+#include "engine/job-system.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+#include "engine/profiler.hpp"
+
+namespace bty {
+
+/* -1 on threads that aren't workers. */
+static thread_local int tWorkerIndex = -1;
+
+static uint64_t microsecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+void JobSystem::init(int numWorkers)
+{
+    BTY_PROFILE_ZONE("JobSystem::init");
+
+    if (_running) {
+        deinit();
+    }
+
+    if (numWorkers < 0) {
+        numWorkers = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    _startTime = std::chrono::steady_clock::now();
+    _running = true;
+
+    for (int i = 0; i < numWorkers; i++) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < numWorkers; i++) {
+        _workers[i]->thread = std::thread(&JobSystem::run, this, i);
+    }
+
+    spdlog::info("JobSystem: {} workers", numWorkers);
+}
+
+void JobSystem::deinit()
+{
+    {
+        std::scoped_lock lock(_sleepMutex);
+        _running = false;
+    }
+    _sleepCv.notify_all();
+
+    /* Workers drain every queue before leaving. */
+    for (auto &worker : _workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    _workers.clear();
+}
+
+int JobSystem::getNumWorkers() const
+{
+    return static_cast<int>(_workers.size());
+}
+
+void JobSystem::submit(std::function<void()> job, JobCounter *counter)
+{
+    if (counter) {
+        counter->_pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Job entry {std::move(job), counter};
+
+    if (_workers.empty()) {
+        execute(entry, -1);
+        return;
+    }
+
+    if (tWorkerIndex >= 0) {
+        auto &worker = *_workers[tWorkerIndex];
+        std::scoped_lock lock(worker.mutex);
+        worker.jobs.push_back(std::move(entry));
+    }
+    else {
+        std::scoped_lock lock(_injectMutex);
+        _inject.push_back(std::move(entry));
+    }
+
+    _queued.fetch_add(1, std::memory_order_release);
+
+    /* Taking the lock orders this against a worker that just saw nothing
+        queued and is about to sleep. */
+    {
+        std::scoped_lock lock(_sleepMutex);
+    }
+    _sleepCv.notify_one();
+}
+
+void JobSystem::wait(JobCounter &counter)
+{
+    while (!counter.done()) {
+        if (!tryRun(tWorkerIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn)
+{
+    if (count == 0) {
+        return;
+    }
+
+    grain = std::max<size_t>(grain, 1);
+
+    JobCounter counter;
+
+    /* The caller takes the first chunk itself rather than sitting idle. */
+    for (size_t begin = grain; begin < count; begin += grain) {
+        const size_t end = std::min(begin + grain, count);
+        auto chunk = [&fn, begin, end]() {
+            fn(begin, end);
+        };
+        submit(chunk, &counter);
+    }
+
+    fn(0, std::min(grain, count));
+
+    wait(counter);
+}
+
+std::vector<WorkerStats> JobSystem::getStats() const
+{
+    std::vector<WorkerStats> stats;
+
+    const auto aliveUs = microsecondsSince(_startTime);
+
+    for (const auto &worker : _workers) {
+        stats.push_back({
+            worker->numJobs.load(std::memory_order_relaxed),
+            worker->steals.load(std::memory_order_relaxed),
+            worker->busyUs.load(std::memory_order_relaxed),
+            aliveUs,
+        });
+    }
+
+    return stats;
+}
+
+void JobSystem::dump() const
+{
+    const auto stats = getStats();
+
+    for (size_t i = 0; i < stats.size(); i++) {
+        const auto &s = stats[i];
+        const double utilization = s.aliveUs ? 100.0 * s.busyUs / s.aliveUs : 0.0;
+        spdlog::info("JobSystem: worker {:>2}: {:>7} jobs {:>6} steals {:>5.1f}% busy", i, s.jobs, s.steals, utilization);
+    }
+}
+
+void JobSystem::run(int index)
+{
+    tWorkerIndex = index;
+    Profile::instance().setThreadName(fmt::format("Worker {}", index));
+
+    while (true) {
+        if (tryRun(index)) {
+            continue;
+        }
+
+        std::unique_lock lock(_sleepMutex);
+        _sleepCv.wait(lock, [this]() {
+            return !_running || _queued.load(std::memory_order_acquire) > 0;
+        });
+
+        if (!_running && _queued.load(std::memory_order_acquire) == 0) {
+            break;
+        }
+    }
+
+    tWorkerIndex = -1;
+}
+
+bool JobSystem::tryRun(int index)
+{
+    Job job;
+    if (!pop(index, job)) {
+        return false;
+    }
+    execute(job, index);
+    return true;
+}
+
+bool JobSystem::pop(int index, Job &job)
+{
+    if (_queued.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    /* Own queue newest-first, since its data is most likely still cached. */
+    if (index >= 0) {
+        auto &worker = *_workers[index];
+        std::scoped_lock lock(worker.mutex);
+        if (!worker.jobs.empty()) {
+            job = std::move(worker.jobs.back());
+            worker.jobs.pop_back();
+            _queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    {
+        std::scoped_lock lock(_injectMutex);
+        if (!_inject.empty()) {
+            job = std::move(_inject.front());
+            _inject.pop_front();
+            _queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    const int numWorkers = static_cast<int>(_workers.size());
+
+    for (int i = 1; i <= numWorkers; i++) {
+        const int victim = (std::max(index, 0) + i) % numWorkers;
+        if (victim == index) {
+            continue;
+        }
+
+        auto &worker = *_workers[victim];
+        std::scoped_lock lock(worker.mutex);
+        if (!worker.jobs.empty()) {
+            job = std::move(worker.jobs.front());
+            worker.jobs.pop_front();
+            _queued.fetch_sub(1, std::memory_order_relaxed);
+            if (index >= 0) {
+                _workers[index]->steals.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::execute(Job &job, int index)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    {
+        BTY_PROFILE_ZONE("Job");
+        job.fn();
+    }
+
+    if (index >= 0) {
+        auto &worker = *_workers[index];
+        worker.numJobs.fetch_add(1, std::memory_order_relaxed);
+        worker.busyUs.fetch_add(microsecondsSince(start), std::memory_order_relaxed);
+    }
+
+    if (job.counter) {
+        job.counter->_pending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+int JobGraph::add(std::function<void()> job)
+{
+    auto node = std::make_unique<Node>();
+    node->fn = std::move(job);
+    _nodes.push_back(std::move(node));
+    return static_cast<int>(_nodes.size()) - 1;
+}
+
+void JobGraph::precede(int before, int after)
+{
+    _nodes[before]->successors.push_back(after);
+    _nodes[after]->numPredecessors++;
+}
+
+void JobGraph::run()
+{
+    JobCounter counter;
+
+    for (auto &node : _nodes) {
+        node->remaining.store(node->numPredecessors, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < static_cast<int>(_nodes.size()); i++) {
+        if (_nodes[i]->numPredecessors == 0) {
+            schedule(i, counter);
+        }
+    }
+
+    Jobs::instance().wait(counter);
+}
+
+void JobGraph::schedule(int node, JobCounter &counter)
+{
+    /* Successors are submitted before this job counts as finished, so the
+        counter can't reach zero while any of the graph is left. */
+    auto job = [this, node, &counter]() {
+        _nodes[node]->fn();
+        for (int successor : _nodes[node]->successors) {
+            if (_nodes[successor]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                schedule(successor, counter);
+            }
+        }
+    };
+    Jobs::instance().submit(job, &counter);
+}
+
+}    // namespace bty
@@ -0,0 +1,119 @@
+#ifndef BTY_ENGINE_JOB_SYSTEM_HPP_
+#define BTY_ENGINE_JOB_SYSTEM_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "engine/singleton.hpp"
+
+namespace bty {
+
+/* Number of jobs submitted against it that haven't finished yet. */
+class JobCounter {
+public:
+    bool done() const
+    {
+        return _pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> _pending {0};
+};
+
+struct WorkerStats {
+    uint64_t jobs {0};
+    uint64_t steals {0};
+    uint64_t busyUs {0};
+    uint64_t aliveUs {0};
+};
+
+/* Work-stealing thread pool. Each worker runs its own newest job first and
+    steals the oldest from the others when it runs dry; jobs submitted from
+    outside the pool go through a shared queue. With no workers, submit()
+    runs jobs inline. Jobs must not touch GL, which is bound to the update
+    and render threads. */
+class JobSystem {
+public:
+    /* A negative count uses one worker per core, minus the main thread.
+        Zero runs every job on the thread that submits it. */
+    void init(int numWorkers = -1);
+    void deinit();
+    int getNumWorkers() const;
+
+    void submit(std::function<void()> job, JobCounter *counter = nullptr);
+    /* Runs other jobs until the counter drops to zero. */
+    void wait(JobCounter &counter);
+    /* Calls fn(begin, end) over [0, count) in chunks of grain and waits. */
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+    std::vector<WorkerStats> getStats() const;
+    void dump() const;
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        JobCounter *counter {nullptr};
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::atomic<uint64_t> numJobs {0};
+        std::atomic<uint64_t> steals {0};
+        std::atomic<uint64_t> busyUs {0};
+    };
+
+    void run(int index);
+    bool tryRun(int index);
+    bool pop(int index, Job &job);
+    void execute(Job &job, int index);
+
+private:
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::mutex _injectMutex;
+    std::deque<Job> _inject;
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCv;
+    std::atomic<int> _queued {0};
+    std::atomic<bool> _running {false};
+    std::chrono::steady_clock::time_point _startTime;
+};
+
+/* A set of jobs with ordering constraints between them. run() starts every
+    job without predecessors and each job starts its successors once they
+    have nothing left to wait on. */
+class JobGraph {
+public:
+    int add(std::function<void()> job);
+    void precede(int before, int after);
+    void run();
+
+private:
+    struct Node {
+        std::function<void()> fn;
+        std::vector<int> successors;
+        int numPredecessors {0};
+        std::atomic<int> remaining {0};
+    };
+
+    void schedule(int node, JobCounter &counter);
+
+private:
+    std::vector<std::unique_ptr<Node>> _nodes;
+};
+
+}    // namespace bty
+
+using Jobs = bty::SingletonProvider<bty::JobSystem>;
+
+#endif    // BTY_ENGINE_JOB_SYSTEM_HPP_
@@ -0,0 +1,270 @@
+#include "engine/metrics-server.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "engine/alloc-tracker.hpp"
+#include "engine/profiler.hpp"
+
+namespace bty {
+
+static constexpr int kPollMs = 250;
+static constexpr uint64_t kSampleMs = 1000;
+static constexpr int kMaxRequestBytes = 4096;
+
+static uint64_t nowMs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+MetricValues &MetricsServer::getValues()
+{
+    return _values;
+}
+
+#ifdef _WIN32
+
+bool MetricsServer::init(const std::string &address)
+{
+    spdlog::warn("MetricsServer: not supported on this platform, ignoring '{}'", address);
+    return false;
+}
+
+void MetricsServer::deinit()
+{
+}
+
+void MetricsServer::run()
+{
+}
+
+void MetricsServer::respond(int)
+{
+}
+
+#else
+
+bool MetricsServer::init(const std::string &address)
+{
+    if (_running) {
+        deinit();
+    }
+
+    if (address.find('/') != std::string::npos) {
+        sockaddr_un addr {};
+        if (address.size() >= sizeof(addr.sun_path)) {
+            spdlog::warn("MetricsServer: socket path '{}' is too long", address);
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, address.c_str());
+
+        /* Left behind by an instance that didn't shut down. */
+        unlink(address.c_str());
+
+        _listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (_listenFd == -1 || bind(_listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
+            spdlog::warn("MetricsServer: failed to bind '{}': {}", address, std::strerror(errno));
+            deinit();
+            return false;
+        }
+        _socketPath = address;
+    }
+    else {
+        const int port = std::atoi(address.c_str());
+        if (port <= 0 || port > 65535) {
+            spdlog::warn("MetricsServer: '{}' is neither a port nor a socket path", address);
+            return false;
+        }
+
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse = 1;
+        if (_listenFd == -1 || setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == -1 || bind(_listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
+            spdlog::warn("MetricsServer: failed to bind port {}: {}", port, std::strerror(errno));
+            deinit();
+            return false;
+        }
+    }
+
+    if (listen(_listenFd, 8) == -1) {
+        spdlog::warn("MetricsServer: failed to listen on '{}': {}", address, std::strerror(errno));
+        deinit();
+        return false;
+    }
+
+    _numSamples = 0;
+    _sampleHead = 0;
+    _running = true;
+    _thread = std::thread(&MetricsServer::run, this);
+
+    spdlog::info("MetricsServer: serving on '{}'", address);
+    return true;
+}
+
+void MetricsServer::deinit()
+{
+    _running = false;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+
+    if (_listenFd != -1) {
+        close(_listenFd);
+        _listenFd = -1;
+    }
+    if (!_socketPath.empty()) {
+        unlink(_socketPath.c_str());
+        _socketPath.clear();
+    }
+}
+
+void MetricsServer::run()
+{
+    Profile::instance().setThreadName("Metrics");
+
+    while (_running) {
+        if (_numSamples == 0 || nowMs() - _samples[(_sampleHead + kNumSamples - 1) % kNumSamples].ms >= kSampleMs) {
+            sample();
+        }
+
+        pollfd pfd {_listenFd, POLLIN, 0};
+        if (poll(&pfd, 1, kPollMs) <= 0 || !(pfd.revents & POLLIN)) {
+            continue;
+        }
+
+        const int fd = accept(_listenFd, nullptr, nullptr);
+        if (fd == -1) {
+            continue;
+        }
+        respond(fd);
+        close(fd);
+    }
+}
+
+void MetricsServer::respond(int fd)
+{
+    /* Whatever was asked for gets the metrics, but the request has to be
+        read first or some clients see the connection reset. */
+    timeval timeout {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    char request[kMaxRequestBytes];
+    int received = 0;
+    while (received < kMaxRequestBytes - 1) {
+        const auto n = recv(fd, request + received, kMaxRequestBytes - 1 - received, 0);
+        if (n <= 0) {
+            break;
+        }
+        received += static_cast<int>(n);
+        request[received] = '\0';
+        if (std::strstr(request, "\r\n\r\n") || std::strstr(request, "\n\n")) {
+            break;
+        }
+    }
+
+    const auto body = format();
+    const auto response = fmt::format("HTTP/1.0 200 OK\r\n"
+                                      "Content-Type: text/plain; version=0.0.4\r\n"
+                                      "Content-Length: {}\r\n"
+                                      "Connection: close\r\n"
+                                      "\r\n"
+                                      "{}",
+                                      body.size(),
+                                      body);
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        const auto n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+#endif
+
+void MetricsServer::sample()
+{
+    _samples[_sampleHead] = {
+        nowMs(),
+        _values.steps.load(std::memory_order_relaxed),
+        _values.frames.load(std::memory_order_relaxed),
+        _values.battles.load(std::memory_order_relaxed),
+    };
+    _sampleHead = (_sampleHead + 1) % kNumSamples;
+    _numSamples = std::min(_numSamples + 1, kNumSamples);
+}
+
+std::string MetricsServer::format() const
+{
+    const auto &newest = _samples[(_sampleHead + kNumSamples - 1) % kNumSamples];
+    const auto &previous = _samples[(_sampleHead + kNumSamples - 2) % kNumSamples];
+    const auto &oldest = _samples[(_sampleHead + kNumSamples - _numSamples) % kNumSamples];
+
+    double stepsPerSecond = 0;
+    double framesPerSecond = 0;
+    if (_numSamples > 1) {
+        const double seconds = (newest.ms - previous.ms) / 1000.0;
+        stepsPerSecond = (newest.steps - previous.steps) / seconds;
+        framesPerSecond = (newest.frames - previous.frames) / seconds;
+    }
+
+    double battlesPerMinute = 0;
+    if (_numSamples > 1) {
+        const double minutes = (newest.ms - oldest.ms) / 60000.0;
+        battlesPerMinute = (newest.battles - oldest.battles) / minutes;
+    }
+
+    std::string text;
+    auto out = std::back_inserter(text);
+
+    fmt::format_to(out, "# TYPE bty_steps_total counter\nbty_steps_total {}\n", _values.steps.load(std::memory_order_relaxed));
+    fmt::format_to(out, "# TYPE bty_steps_per_second gauge\nbty_steps_per_second {:.2f}\n", stepsPerSecond);
+    fmt::format_to(out, "# TYPE bty_frames_total counter\nbty_frames_total {}\n", _values.frames.load(std::memory_order_relaxed));
+    fmt::format_to(out, "# TYPE bty_frames_per_second gauge\nbty_frames_per_second {:.2f}\n", framesPerSecond);
+
+    fmt::format_to(out, "# TYPE bty_frame_time_seconds gauge\n");
+    fmt::format_to(out, "bty_frame_time_seconds{{quantile=\"0.5\"}} {:.6f}\n", _values.frameUsP50.load(std::memory_order_relaxed) / 1e6);
+    fmt::format_to(out, "bty_frame_time_seconds{{quantile=\"0.9\"}} {:.6f}\n", _values.frameUsP90.load(std::memory_order_relaxed) / 1e6);
+    fmt::format_to(out, "bty_frame_time_seconds{{quantile=\"0.99\"}} {:.6f}\n", _values.frameUsP99.load(std::memory_order_relaxed) / 1e6);
+    fmt::format_to(out, "bty_frame_time_seconds{{quantile=\"1\"}} {:.6f}\n", _values.frameUsMax.load(std::memory_order_relaxed) / 1e6);
+
+    fmt::format_to(out, "# TYPE bty_battles_total counter\nbty_battles_total {}\n", _values.battles.load(std::memory_order_relaxed));
+    fmt::format_to(out, "# TYPE bty_battles_per_minute gauge\nbty_battles_per_minute {:.2f}\n", battlesPerMinute);
+
+    if (AllocTracker::kCompiledIn) {
+        fmt::format_to(out, "# TYPE bty_allocations_total counter\nbty_allocations_total {}\n", _values.allocations.load(std::memory_order_relaxed));
+        fmt::format_to(out, "# TYPE bty_allocated_bytes_total counter\nbty_allocated_bytes_total {}\n", _values.allocatedBytes.load(std::memory_order_relaxed));
+    }
+
+    fmt::format_to(out, "# TYPE bty_gpu_bytes gauge\n");
+    for (int i = 0; i < static_cast<int>(GpuCategory::Count); i++) {
+        fmt::format_to(out, "bty_gpu_bytes{{category=\"{}\"}} {}\n", gpuCategoryName(static_cast<GpuCategory>(i)), _values.gpuBytes[i].load(std::memory_order_relaxed));
+    }
+
+    fmt::format_to(out, "# TYPE bty_scene gauge\nbty_scene{{name=\"{}\"}} 1\n", _values.scene.load(std::memory_order_relaxed));
+
+    return text;
+}
+
+}    // namespace bty
@@ -0,0 +1,83 @@
+#ifndef BTY_ENGINE_METRICS_SERVER_HPP_
+#define BTY_ENGINE_METRICS_SERVER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "engine/singleton.hpp"
+#include "gfx/gpu-registry.hpp"
+
+namespace bty {
+
+/* What the server reports. The game thread only stores to these, relaxed;
+    the server works out rates from the counters itself. */
+struct MetricValues {
+    /* Counters. */
+    std::atomic<uint64_t> steps {0};
+    std::atomic<uint64_t> frames {0};
+    std::atomic<uint64_t> battles {0};
+    std::atomic<uint64_t> allocations {0};
+    std::atomic<uint64_t> allocatedBytes {0};
+
+    /* Gauges, published about once a second. */
+    std::atomic<uint32_t> frameUsP50 {0};
+    std::atomic<uint32_t> frameUsP90 {0};
+    std::atomic<uint32_t> frameUsP99 {0};
+    std::atomic<uint32_t> frameUsMax {0};
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(GpuCategory::Count)> gpuBytes {};
+    /* Must stay valid for the lifetime of the server, like profiler zone
+        names. */
+    std::atomic<const char *> scene {"none"};
+};
+
+/* Serves MetricValues in the Prometheus text format to anyone connecting to
+    a localhost TCP port or a Unix domain socket, e.g.
+        curl localhost:9400/metrics
+        curl --unix-socket /tmp/bty.sock http://localhost/metrics
+    Requests are answered on the server's own thread, which never touches
+    anything but the atomics above. */
+class MetricsServer {
+public:
+    /* A port number, or a socket path (anything containing a '/'). */
+    bool init(const std::string &address);
+    void deinit();
+
+    MetricValues &getValues();
+
+private:
+    /* Rates are worked out over the last minute of these. */
+    struct Sample {
+        uint64_t ms;
+        uint64_t steps;
+        uint64_t frames;
+        uint64_t battles;
+    };
+
+    static constexpr int kNumSamples = 61;
+
+    void run();
+    void sample();
+    std::string format() const;
+    void respond(int fd);
+
+private:
+    MetricValues _values;
+    std::thread _thread;
+    std::atomic<bool> _running {false};
+    int _listenFd {-1};
+    std::string _socketPath;
+
+    /* Server thread only. */
+    std::array<Sample, kNumSamples> _samples {};
+    int _numSamples {0};
+    int _sampleHead {0};
+};
+
+}    // namespace bty
+
+using Metrics = bty::SingletonProvider<bty::MetricsServer>;
+
+#endif    // BTY_ENGINE_METRICS_SERVER_HPP_
@@ -0,0 +1,287 @@
+#include "engine/profiler.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "engine/job-system.hpp"
+
+namespace bty {
+
+/* Per thread; 64K zones is a few seconds of a busy frame loop. */
+static constexpr size_t kZonesPerThread = 1 << 16;
+static constexpr size_t kMaxMarkers = 4096;
+
+static thread_local void *tThreadBuffer = nullptr;
+
+std::atomic<bool> Profiler::sEnabled {false};
+
+static std::string escapeJson(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+int64_t Profiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::capture(const std::string &path, int frames)
+{
+    if (_capturing) {
+        spdlog::warn("Profiler: already capturing to {}", _capturePath);
+        return;
+    }
+
+    _capturePath = path;
+    _framesLeft = frames;
+    _captureStartNs = now();
+    _capturing = true;
+
+    spdlog::info("Profiler: capturing {} frames to {}", frames, path);
+
+    sEnabled.store(true, std::memory_order_seq_cst);
+}
+
+void Profiler::endFrame()
+{
+    if (_capturing && --_framesLeft <= 0) {
+        endCapture();
+    }
+}
+
+void Profiler::finish()
+{
+    if (_capturing) {
+        endCapture();
+    }
+}
+
+void Profiler::setRetained(bool retained)
+{
+    _retained = retained;
+    sEnabled.store(_retained || _capturing, std::memory_order_seq_cst);
+}
+
+void Profiler::endCapture()
+{
+    _capturing = false;
+
+    const auto endNs = now();
+
+    if (!_retained) {
+        sEnabled.store(false, std::memory_order_seq_cst);
+    }
+
+    writeTrace(_capturePath, _captureStartNs, endNs);
+}
+
+void Profiler::setThreadName(const std::string &name)
+{
+    auto &buffer = getThreadBuffer();
+    std::scoped_lock lock(_threadsMutex);
+    buffer.name = name;
+}
+
+void Profiler::record(const char *name, int64_t startNs, int64_t endNs)
+{
+    auto &buffer = getThreadBuffer();
+
+    /* Pairs with writeTrace(): either it sees this flag and waits, or this
+        sees recording has stopped and leaves the ring alone. That only
+        holds if neither side's load can move ahead of its store, so both
+        are seq_cst rather than the relaxed enabled(). */
+    buffer.writing.store(true, std::memory_order_seq_cst);
+    if (sEnabled.load(std::memory_order_seq_cst)) {
+        const auto index = buffer.numWritten.load(std::memory_order_relaxed);
+        auto &slot = buffer.slots[index % kZonesPerThread];
+        slot.stamp.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.startNs.store(startNs, std::memory_order_relaxed);
+        slot.endNs.store(endNs, std::memory_order_relaxed);
+        slot.stamp.store(index + 1, std::memory_order_release);
+        buffer.numWritten.store(index + 1, std::memory_order_release);
+    }
+    buffer.writing.store(false, std::memory_order_release);
+}
+
+void Profiler::mark(const char *name, std::string detail)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    std::scoped_lock lock(_markersMutex);
+    _markers.push_back({now(), name, std::move(detail), 0, false});
+    if (_markers.size() > kMaxMarkers) {
+        _markers.pop_front();
+    }
+}
+
+void Profiler::counter(const char *name, int64_t value)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    std::scoped_lock lock(_markersMutex);
+    _markers.push_back({now(), name, {}, value, true});
+    if (_markers.size() > kMaxMarkers) {
+        _markers.pop_front();
+    }
+}
+
+Profiler::ThreadBuffer &Profiler::getThreadBuffer()
+{
+    if (!tThreadBuffer) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->slots = std::make_unique<Slot[]>(kZonesPerThread);
+
+        std::scoped_lock lock(_threadsMutex);
+        buffer->tid = static_cast<int>(_threads.size()) + 1;
+        buffer->name = fmt::format("Thread {}", buffer->tid);
+        tThreadBuffer = buffer.get();
+        _threads.push_back(std::move(buffer));
+    }
+    return *static_cast<ThreadBuffer *>(tThreadBuffer);
+}
+
+void Profiler::writeTrace(const std::string &path, int64_t fromNs, int64_t toNs)
+{
+    struct ThreadZones {
+        int tid;
+        std::string name;
+        std::vector<Zone> zones;
+    };
+
+    std::vector<ThreadZones> threads;
+    std::vector<Marker> markers;
+
+    {
+        std::scoped_lock lock(_threadsMutex);
+
+        for (auto &thread : _threads) {
+            if (!sEnabled.load(std::memory_order_seq_cst)) {
+                while (thread->writing.load(std::memory_order_seq_cst)) {
+                }
+            }
+
+            auto &copy = threads.emplace_back();
+            copy.tid = thread->tid;
+            copy.name = thread->name;
+
+            const auto numWritten = thread->numWritten.load(std::memory_order_acquire);
+            const auto begin = numWritten > kZonesPerThread ? numWritten - kZonesPerThread : 0;
+
+            /* While retained the owner keeps writing, so a slot it has
+                lapped, or is halfway through, fails the stamp check on one
+                side of the copy and is dropped. */
+            for (auto i = begin; i < numWritten; i++) {
+                const auto &slot = thread->slots[i % kZonesPerThread];
+                if (slot.stamp.load(std::memory_order_acquire) != i + 1) {
+                    continue;
+                }
+                Zone zone {
+                    slot.name.load(std::memory_order_relaxed),
+                    slot.startNs.load(std::memory_order_relaxed),
+                    slot.endNs.load(std::memory_order_relaxed),
+                };
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.stamp.load(std::memory_order_relaxed) != i + 1) {
+                    continue;
+                }
+                copy.zones.push_back(zone);
+            }
+        }
+    }
+
+    {
+        std::scoped_lock lock(_markersMutex);
+        for (const auto &marker : _markers) {
+            if (marker.ns >= fromNs && marker.ns <= toNs) {
+                markers.push_back(marker);
+            }
+        }
+    }
+
+    /* Formatting a few seconds of zones takes long enough to show up as a
+        stutter of its own, so it happens off the frame loop. */
+    auto job = [path, fromNs, toNs, threads = std::move(threads), markers = std::move(markers)]() {
+        const auto parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty() && !std::filesystem::exists(parent)) {
+            std::filesystem::create_directories(parent);
+        }
+
+        std::ofstream f(path, std::ios::out | std::ios::trunc);
+        if (!f.good()) {
+            spdlog::warn("Profiler: failed to open '{}'", path);
+            return;
+        }
+
+        auto ts = [fromNs](int64_t ns) {
+            return (ns - fromNs) / 1000.0;
+        };
+
+        f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        f << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"mbounty\"}}";
+
+        size_t numZones = 0;
+
+        for (const auto &thread : threads) {
+            f << fmt::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", thread.tid, escapeJson(thread.name));
+
+            for (const auto &zone : thread.zones) {
+                if (zone.startNs < fromNs || zone.endNs > toNs) {
+                    continue;
+                }
+                f << fmt::format(",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                                 escapeJson(zone.name),
+                                 thread.tid,
+                                 ts(zone.startNs),
+                                 (zone.endNs - zone.startNs) / 1000.0);
+                numZones++;
+            }
+        }
+
+        for (const auto &marker : markers) {
+            if (marker.isCounter) {
+                f << fmt::format(",\n{{\"name\":\"{}\",\"ph\":\"C\",\"pid\":1,\"ts\":{:.3f},\"args\":{{\"value\":{}}}}}", escapeJson(marker.name), ts(marker.ns), marker.value);
+            }
+            else {
+                f << fmt::format(",\n{{\"name\":\"{}\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":{:.3f},\"args\":{{\"detail\":\"{}\"}}}}", escapeJson(marker.name), ts(marker.ns), escapeJson(marker.detail));
+            }
+        }
+
+        f << "\n]}\n";
+
+        spdlog::info("Profiler: wrote {} zones and {} markers to {}", numZones, markers.size(), path);
+    };
+    Jobs::instance().submit(job);
+}
+
+ProfileScope::ProfileScope(const char *name)
+{
+    if (Profiler::enabled()) {
+        _name = name;
+        _startNs = Profiler::now();
+    }
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (_name) {
+        Profile::instance().record(_name, _startNs, Profiler::now());
+    }
+}
+
+}    // namespace bty
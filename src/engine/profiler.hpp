@@ -0,0 +1,124 @@
+#ifndef BTY_ENGINE_PROFILER_HPP_
+#define BTY_ENGINE_PROFILER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "engine/singleton.hpp"
+
+namespace bty {
+
+/* Records timed zones into a ring per thread while a capture is running, or
+    all the time while retained, and writes them out as Chrome trace JSON,
+    which Perfetto and chrome://tracing both open. With nothing recording a
+    zone costs one relaxed load. */
+class Profiler {
+public:
+    static bool enabled()
+    {
+        return sEnabled.load(std::memory_order_relaxed);
+    }
+    static int64_t now();
+
+    /* Records until endFrame() has been called frames times, then writes the
+        trace to path. */
+    void capture(const std::string &path, int frames);
+    void endFrame();
+    /* Writes out a capture that is still running, e.g. on quit. */
+    void finish();
+    /* Keeps recording outside of captures, for the flight recorder. */
+    void setRetained(bool retained);
+    /* Writes whatever the rings still hold between the two times. The file
+        itself is written on the job system. */
+    void writeTrace(const std::string &path, int64_t fromNs, int64_t toNs);
+
+    void setThreadName(const std::string &name);
+    void record(const char *name, int64_t startNs, int64_t endNs);
+    /* Game events (scene changes, saves, ...) shown as instant markers. */
+    void mark(const char *name, std::string detail = {});
+    void counter(const char *name, int64_t value);
+
+private:
+    struct Zone {
+        const char *name;
+        int64_t startNs;
+        int64_t endNs;
+    };
+
+    /* A ring entry. The owner rewrites it while writeTrace() may be
+        copying it, so every field is atomic and stamp says which zone the
+        slot holds: index + 1 once written, 0 while being rewritten. */
+    struct Slot {
+        std::atomic<uint64_t> stamp {0};
+        std::atomic<const char *> name {nullptr};
+        std::atomic<int64_t> startNs {0};
+        std::atomic<int64_t> endNs {0};
+    };
+
+    struct ThreadBuffer {
+        int tid {0};
+        std::string name;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<uint64_t> numWritten {0};
+        std::atomic<bool> writing {false};
+    };
+
+    struct Marker {
+        int64_t ns;
+        const char *name;
+        std::string detail;
+        int64_t value;
+        bool isCounter;
+    };
+
+    ThreadBuffer &getThreadBuffer();
+    void endCapture();
+
+private:
+    static std::atomic<bool> sEnabled;
+
+    std::mutex _threadsMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> _threads;
+    std::mutex _markersMutex;
+    std::deque<Marker> _markers;
+    bool _retained {false};
+    bool _capturing {false};
+    std::string _capturePath;
+    int _framesLeft {0};
+    int64_t _captureStartNs {0};
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char *name);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *_name {nullptr};
+    int64_t _startNs {0};
+};
+
+}    // namespace bty
+
+using Profile = bty::SingletonProvider<bty::Profiler>;
+
+#define BTY_PROFILE_CONCAT_(a, b) a##b
+#define BTY_PROFILE_CONCAT(a, b) BTY_PROFILE_CONCAT_(a, b)
+
+/* Times the rest of the enclosing scope. The name must outlive the capture,
+    so it is normally a string literal. Compiled out without BTY_PROFILE. */
+#ifdef BTY_PROFILE
+#define BTY_PROFILE_ZONE(name) bty::ProfileScope BTY_PROFILE_CONCAT(btyProfileZone, __LINE__)(name)
+#else
+#define BTY_PROFILE_ZONE(name) (void)0
+#endif
+
+#endif    // BTY_ENGINE_PROFILER_HPP_
@@ -2,26 +2,37 @@
 
 #include <spdlog/spdlog.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <unordered_set>
 #include "gfx/gfx.hpp"
+#include "engine/alloc-tracker.hpp"
 #include "engine/component.hpp"
+#include "engine/profiler.hpp"
+#include "engine/texture-cache.hpp"
 #include "window/window.hpp"
 
 namespace bty {
 
-void SceneManager::init(bty::Window *window, const std::vector<std::pair<std::string, Component *>> &sceneList)
+/* Scenes kept constructed once visited, not counting persistent ones and
+    the current and previous scene. */
+static constexpr size_t kMaxResidentScenes = 6;
+
+void SceneManager::init(bty::Window *window, const std::vector<std::pair<std::string, SceneFactory>> &sceneList)
 {
-    for (auto &[name, component] : sceneList) {
+    for (auto &[name, factory] : sceneList) {
         assert(name != "none");
-        _sceneMap[name] = component;
+        _scenes[name].create = factory;
     }
 	_transition.fadeRect.setSize(static_cast<float>(window_width(window)), static_cast<float>(window_height(window)));
 }
 
 void SceneManager::deinit()
 {
-    for (auto &[_, component] : _sceneMap) {
-        component->unload();
-        delete component;
+    for (auto &[_, scene] : _scenes) {
+        if (scene.component) {
+            scene.component->unload();
+            delete scene.component;
+            scene.component = nullptr;
+        }
     }
     _curScene = nullptr;
 }
@@ -53,21 +64,27 @@ void SceneManager::renderLate()
 
 void SceneManager::render()
 {
+    BTY_PROFILE_ZONE("SceneManager::render");
+
 	if (_curScene) {
 		if (_curScene->isOverlay()) {
 			if (_lastSceneName != "none") {
-				_sceneMap[_lastSceneName]->render();
+				_scenes[_lastSceneName].component->render();
 			}
 		}
+		BTY_PROFILE_ZONE(_curSceneZone);
 		_curScene->render();
 	} 
 }
 
 void SceneManager::update(float dt)
 {
+    BTY_PROFILE_ZONE("SceneManager::update");
+
 	switch (_transition.state) {
 		case TransitionState::None:
 			if (_curScene) {
+				BTY_PROFILE_ZONE(_curSceneZone);
 	        	_curScene->update(dt);
     		}
 			break;
@@ -75,14 +92,7 @@ void SceneManager::update(float dt)
 			updateTransitionOut(dt);
 			break;
 		case TransitionState::Pause:
-			if (_curScene) {
-				_curScene->unload();
-			}
-			_lastSceneName = _curSceneName;
-			_curSceneName = _transition.next;
-			_curScene = _sceneMap[_transition.next];
-			_curScene->load();
-			_curScene->enter();
+			switchScene(_transition.next);
 			_transition.state = TransitionState::TransitionIn;
 			if (_transition.onTransitionIn) {
 				_transition.onTransitionIn();
@@ -97,9 +107,15 @@ void SceneManager::update(float dt)
 	}
 }
 
+/* Fades take one update each when the Scheduler is skipping waits. */
+static float transitionStep(float dt)
+{
+	return Scheduler::instant() ? 1.0f : dt * 2;
+}
+
 void SceneManager::updateTransitionOut(float dt)
 {
-	_transition.progress += dt * 2;
+	_transition.progress += transitionStep(dt);
 	if (_transition.progress >= 1.0f) {
 		_transition.fadeRect.setColor({0.0f, 0.0f, 0.0f, 1.0f});
 		_transition.progress = 0.0f;
@@ -113,7 +129,7 @@ void SceneManager::updateTransitionOut(float dt)
 
 void SceneManager::updateTransitionIn(float dt)
 {
-	_transition.progress += dt * 2;
+	_transition.progress += transitionStep(dt);
 	if (_transition.progress >= 1.0f) {
 		_transition.state = TransitionState::None;
 	}
@@ -125,11 +141,11 @@ void SceneManager::updateTransitionIn(float dt)
 
 void SceneManager::setScene(std::string name, bool transition, std::function<void()> onTransitionIn)
 {
-    if (!_sceneMap.contains(name)) {
+    if (!_scenes.contains(name)) {
         spdlog::warn("SceneManager: no component by name '{}'", name);
     }
     else {
-        if (_curScene == _sceneMap[name]) {
+        if (_curSceneName == name) {
             spdlog::warn("SceneManager: component is already '{}'", name);
         }
         else {
@@ -139,16 +155,11 @@ void SceneManager::setScene(std::string name, bool transition, std::function<voi
 				_transition.progress = 0.0f;
 				_transition.next = name;
 				_transition.onTransitionIn = onTransitionIn;
+				/* Decode the next scene's textures while the fade runs. */
+				Textures::instance().prefetch(construct(_scenes[name])->getAssets());
 			}
 			else {
-				if (_curScene) {
-					_curScene->unload();
-				}
-				_lastSceneName = _curSceneName;
-				_curSceneName = name;
-				_curScene = _sceneMap[name];
-				_curScene->load();
-				_curScene->enter();
+				switchScene(name);
 			}
         }
     }
@@ -156,8 +167,8 @@ void SceneManager::setScene(std::string name, bool transition, std::function<voi
 
 Component *SceneManager::getLastScene()
 {
-    if (_lastSceneName != "none" && _sceneMap[_lastSceneName] != _curScene) {
-        return _sceneMap[_lastSceneName];
+    if (_lastSceneName != "none" && _lastSceneName != _curSceneName) {
+        return _scenes[_lastSceneName].component;
     }
     return nullptr;
 }
@@ -167,12 +178,108 @@ std::string SceneManager::getLastSceneName() const
     return _lastSceneName;
 }
 
+const char *SceneManager::getCurrentSceneName() const
+{
+    return _curSceneZone;
+}
+
+bool SceneManager::transitioning() const
+{
+    return _transition.state != TransitionState::None;
+}
+
 Component *SceneManager::getScene(std::string name)
 {
-    if (_sceneMap.contains(name)) {
-        return _sceneMap[name];
+    if (_scenes.contains(name)) {
+        return construct(_scenes[name]);
     }
     return nullptr;
 }
 
+void SceneManager::switchScene(const std::string &name)
+{
+    BTY_PROFILE_ZONE("SceneManager::switchScene");
+
+    if (_curScene) {
+        _curScene->unload();
+    }
+
+    auto &scene = _scenes[name];
+
+    Profile::instance().mark("Scene", name);
+
+    _lastSceneName = _curSceneName;
+    _curSceneName = name;
+    _curSceneZone = _scenes.find(name)->first.c_str();
+    AllocTracker::setScene(_curSceneZone);
+    _curScene = construct(scene);
+    scene.lastVisit = ++_numVisits;
+
+    /* Picks up anything a fade-out prefetch didn't cover and decodes it on
+        the workers rather than one by one inside load(). */
+    Textures::instance().preload(_curScene->getAssets());
+
+    {
+        BTY_PROFILE_ZONE(_curSceneZone);
+        _curScene->load();
+        _curScene->enter();
+    }
+
+    evict();
+}
+
+Component *SceneManager::construct(Scene &scene)
+{
+    if (!scene.component) {
+        scene.component = scene.create();
+    }
+    return scene.component;
+}
+
+void SceneManager::evict()
+{
+    while (true) {
+        std::string oldestName;
+        uint64_t oldestVisit = UINT64_MAX;
+        size_t numResident = 0;
+
+        for (auto &[name, scene] : _scenes) {
+            if (!scene.component || scene.component->isPersistent() || name == _curSceneName || name == _lastSceneName) {
+                continue;
+            }
+            numResident++;
+            if (scene.lastVisit < oldestVisit) {
+                oldestVisit = scene.lastVisit;
+                oldestName = name;
+            }
+        }
+
+        if (numResident <= kMaxResidentScenes) {
+            break;
+        }
+
+        auto &evicted = _scenes[oldestName];
+
+        /* Textures another constructed scene also uses stay cached. */
+        std::unordered_set<std::string> shared;
+        for (auto &[name, scene] : _scenes) {
+            if (scene.component && name != oldestName) {
+                for (auto &asset : scene.component->getAssets()) {
+                    shared.insert(std::move(asset));
+                }
+            }
+        }
+
+        for (const auto &asset : evicted.component->getAssets()) {
+            if (!shared.contains(asset)) {
+                Textures::instance().free(asset);
+            }
+        }
+
+        spdlog::debug("SceneManager: evicting '{}'", oldestName);
+        delete evicted.component;
+        evicted.component = nullptr;
+    }
+}
+
 }    // namespace bty
@@ -1,6 +1,7 @@
 #ifndef BTY_ENGINE_SCENE_MANAGER_HPP_
 #define BTY_ENGINE_SCENE_MANAGER_HPP_
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <unordered_map>
@@ -9,6 +10,7 @@
 #include "gfx/rect.hpp"
 #include "engine/events.hpp"
 #include "engine/singleton.hpp"
+#include "engine/task.hpp"
 
 class Component;
 
@@ -17,6 +19,9 @@ namespace bty {
 class Gfx;
 struct Window;
 
+/* Constructs a scene the first time it is used. */
+using SceneFactory = std::function<Component *()>;
+
 class SceneManager {
 private:
 	enum class TransitionState
@@ -36,8 +41,14 @@ private:
 		std::function<void()> onTransitionIn{nullptr};
     };
 
+    struct Scene {
+        SceneFactory create;
+        Component *component {nullptr};
+        uint64_t lastVisit {0};
+    };
+
 public:
-    void init(bty::Window *window, const std::vector<std::pair<std::string, Component *>> &sceneList);
+    void init(bty::Window *window, const std::vector<std::pair<std::string, SceneFactory>> &sceneList);
     void deinit();
 
     bool handleEvent(Event event);
@@ -48,17 +59,57 @@ public:
     void setScene(std::string name, bool transition = false, std::function<void()> onTransitionIn = nullptr);
     Component *getLastScene();
     std::string getLastSceneName() const;
+    /* Valid for as long as the manager is. */
+    const char *getCurrentSceneName() const;
+    bool transitioning() const;
     Component *getScene(std::string name);
 
+    template <typename T>
+    T *getScene(std::string name)
+    {
+        return static_cast<T *>(getScene(std::move(name)));
+    }
+
+    /* co_await-able fade to another scene. Resumes once the new scene has
+        entered, like onTransitionIn. */
+    auto fadeTo(Scheduler &scheduler, std::string name)
+    {
+        struct FadeAwaiter {
+            SceneManager &sceneManager;
+            Scheduler &scheduler;
+            std::string name;
+
+            bool await_ready()
+            {
+                return !sceneManager._scenes.contains(name) || sceneManager._curSceneName == name;
+            }
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                sceneManager.setScene(name, true, scheduler.resumer(handle));
+            }
+            void await_resume() noexcept
+            {
+            }
+        };
+        return FadeAwaiter {*this, scheduler, std::move(name)};
+    }
+
 private:
     void startTransitionOut();
     void startTransitionIn();
     void updateTransitionOut(float dt);
 	void updateTransitionIn(float dt);
+    void switchScene(const std::string &name);
+    Component *construct(Scene &scene);
+    void evict();
 
-    std::unordered_map<std::string, Component *> _sceneMap;
+    std::unordered_map<std::string, Scene> _scenes;
+    uint64_t _numVisits {0};
     Component *_curScene {nullptr};
     std::string _curSceneName {"none"};
+    /* Zone name for the current scene; points into _scenes, so it stays
+        valid for as long as the profiler may hold it. */
+    const char *_curSceneZone {"none"};
     std::string _lastSceneName {"none"};
     Transition _transition;
 };
@@ -0,0 +1,123 @@
+#include "engine/shared-memory.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace bty {
+
+SharedMemory::~SharedMemory()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool SharedMemory::create(const std::string &name, size_t size)
+{
+    close();
+
+    const auto path = "Local\\" + name;
+    const auto high = static_cast<DWORD>(static_cast<uint64_t>(size) >> 32);
+    const auto low = static_cast<DWORD>(size & 0xFFFFFFFF);
+
+    _handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, high, low, path.c_str());
+    if (!_handle) {
+        spdlog::warn("SharedMemory: failed to create '{}': error {}", path, GetLastError());
+        return false;
+    }
+
+    _data = MapViewOfFile(_handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!_data) {
+        spdlog::warn("SharedMemory: failed to map '{}': error {}", path, GetLastError());
+        close();
+        return false;
+    }
+
+    /* A mapping that already existed keeps its old contents. */
+    std::memset(_data, 0, size);
+    _name = name;
+    _size = size;
+
+    return true;
+}
+
+void SharedMemory::close()
+{
+    if (_data) {
+        UnmapViewOfFile(_data);
+        _data = nullptr;
+    }
+    if (_handle) {
+        CloseHandle(_handle);
+        _handle = nullptr;
+    }
+    _name.clear();
+    _size = 0;
+}
+
+#else
+
+bool SharedMemory::create(const std::string &name, size_t size)
+{
+    close();
+
+    const auto path = "/" + name;
+
+    /* Left behind by an instance that didn't shut down. */
+    shm_unlink(path.c_str());
+
+    const int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1) {
+        spdlog::warn("SharedMemory: failed to create '{}': {}", path, std::strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+        spdlog::warn("SharedMemory: failed to size '{}': {}", path, std::strerror(errno));
+        ::close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        spdlog::warn("SharedMemory: failed to map '{}': {}", path, std::strerror(errno));
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    _name = name;
+    _data = data;
+    _size = size;
+
+    return true;
+}
+
+void SharedMemory::close()
+{
+    if (_data) {
+        munmap(_data, _size);
+        shm_unlink(("/" + _name).c_str());
+        _data = nullptr;
+    }
+    _name.clear();
+    _size = 0;
+}
+
+#endif
+
+}    // namespace bty
@@ -0,0 +1,42 @@
+#ifndef BTY_ENGINE_SHARED_MEMORY_HPP_
+#define BTY_ENGINE_SHARED_MEMORY_HPP_
+
+#include <cstddef>
+#include <string>
+
+namespace bty {
+
+/* A named block of memory other local processes can map: /dev/shm/<name>
+    on Linux, Local\<name> on Windows. Created zeroed, removed on close. */
+class SharedMemory {
+public:
+    SharedMemory() = default;
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+
+    bool create(const std::string &name, size_t size);
+    void close();
+
+    void *data() const
+    {
+        return _data;
+    }
+    size_t size() const
+    {
+        return _size;
+    }
+
+private:
+    std::string _name;
+    void *_data {nullptr};
+    size_t _size {0};
+#ifdef _WIN32
+    void *_handle {nullptr};
+#endif
+};
+
+}    // namespace bty
+
+#endif    // BTY_ENGINE_SHARED_MEMORY_HPP_
@@ -0,0 +1,52 @@
+#ifndef BTY_ENGINE_SPSC_RING_HPP_
+#define BTY_ENGINE_SPSC_RING_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace bty {
+
+/* Fixed-size single-producer single-consumer queue. push() and pop() never
+    block or allocate; push() fails when the consumer has fallen behind. */
+template <typename T, size_t N>
+class SpscRing {
+    static_assert((N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    bool push(const T &value)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        _items[head & (N - 1)] = value;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &value)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = _items[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, N> _items {};
+    alignas(64) std::atomic<size_t> _head {0};
+    alignas(64) std::atomic<size_t> _tail {0};
+};
+
+}    // namespace bty
+
+#endif    // BTY_ENGINE_SPSC_RING_HPP_
@@ -0,0 +1,129 @@
+#include "engine/task.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+namespace bty {
+
+static bool sInstant {false};
+
+/* Guards instant mode against a sequence that never stops waiting. */
+static constexpr int kMaxInstantPasses = 10000;
+
+Scheduler::~Scheduler()
+{
+    clear();
+}
+
+void Scheduler::setInstant(bool instant)
+{
+    sInstant = instant;
+}
+
+bool Scheduler::instant()
+{
+    return sInstant;
+}
+
+void Scheduler::spawn(Task task)
+{
+    auto handle = task.release();
+    if (!handle) {
+        return;
+    }
+
+    _tasks.push_back(handle);
+    handle.resume();
+    reap();
+}
+
+void Scheduler::update(float dt)
+{
+    if (!sInstant) {
+        resumeReady(dt);
+        return;
+    }
+
+    int passes = 0;
+    while (resumeReady(std::numeric_limits<float>::infinity())) {
+        if (++passes == kMaxInstantPasses) {
+            spdlog::warn("Scheduler: still busy after {} instant passes", passes);
+            break;
+        }
+    }
+}
+
+void Scheduler::clear()
+{
+    _waiters.clear();
+    for (auto handle : _tasks) {
+        handle.destroy();
+    }
+    _tasks.clear();
+}
+
+bool Scheduler::idle() const
+{
+    return _tasks.empty();
+}
+
+std::function<void()> Scheduler::resumer(std::coroutine_handle<> handle)
+{
+    /* Parked with a condition that never holds, so only the callback
+        releases it. */
+    auto ready = std::make_shared<bool>(false);
+    _waiters.push_back({handle, 0.0f, [ready]() {
+                            return *ready;
+                        }});
+    return [ready]() {
+        *ready = true;
+    };
+}
+
+bool Scheduler::resumeReady(float dt)
+{
+    /* Resuming can add waiters, so work off a copy. */
+    auto waiters = std::move(_waiters);
+    _waiters.clear();
+
+    bool resumed = false;
+
+    for (auto &waiter : waiters) {
+        bool ready;
+        if (waiter.condition) {
+            ready = waiter.condition();
+        }
+        else {
+            waiter.remaining -= dt;
+            ready = waiter.remaining <= 0.0f;
+        }
+
+        if (ready) {
+            waiter.handle.resume();
+            resumed = true;
+        }
+        else {
+            _waiters.push_back(std::move(waiter));
+        }
+    }
+
+    reap();
+
+    return resumed;
+}
+
+void Scheduler::reap()
+{
+    std::erase_if(_tasks, [](std::coroutine_handle<Task::promise_type> handle) {
+        if (!handle.done()) {
+            return false;
+        }
+        handle.destroy();
+        return true;
+    });
+}
+
+}    // namespace bty
@@ -0,0 +1,207 @@
+#ifndef BTY_ENGINE_TASK_HPP_
+#define BTY_ENGINE_TASK_HPP_
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace bty {
+
+/* A scripted sequence. Starts suspended; hand it to a Scheduler to run it,
+    or co_await it from another Task to run it inline. */
+class Task {
+public:
+    struct promise_type {
+        std::coroutine_handle<> continuation {nullptr};
+
+        Task get_return_object()
+        {
+            return Task {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        auto final_suspend() noexcept
+        {
+            struct FinalAwaiter {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+                {
+                    auto continuation = h.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+                void await_resume() noexcept
+                {
+                }
+            };
+            return FinalAwaiter {};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : _handle(handle)
+    {
+    }
+    Task(Task &&other) noexcept
+        : _handle(std::exchange(other._handle, nullptr))
+    {
+    }
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other) {
+            if (_handle) {
+                _handle.destroy();
+            }
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task()
+    {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    bool done() const
+    {
+        return !_handle || _handle.done();
+    }
+
+    std::coroutine_handle<promise_type> release()
+    {
+        return std::exchange(_handle, nullptr);
+    }
+
+    auto operator co_await() noexcept
+    {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() noexcept
+            {
+                return !handle || handle.done();
+            }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            void await_resume() noexcept
+            {
+            }
+        };
+        return Awaiter {_handle};
+    }
+
+private:
+    std::coroutine_handle<promise_type> _handle {nullptr};
+};
+
+/* Runs Tasks and resumes them when what they wait on is over. spawn()
+    runs a Task inline up to its first wait, inside whatever started it;
+    every resume after that goes through update(). In instant mode
+    (headless runs, fast-forward) update() treats all timed waits as
+    elapsed and keeps resuming until nothing is ready, so a whole sequence
+    completes in one call. */
+class Scheduler {
+public:
+    Scheduler() = default;
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+    ~Scheduler();
+
+    static void setInstant(bool instant);
+    static bool instant();
+
+    void spawn(Task task);
+    void update(float dt);
+    /* Destroys every running Task. Must not be called from inside one. */
+    void clear();
+    bool idle() const;
+
+    auto delay(float seconds)
+    {
+        struct DelayAwaiter {
+            Scheduler &scheduler;
+            float seconds;
+
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                scheduler._waiters.push_back({handle, seconds, nullptr});
+            }
+            void await_resume() noexcept
+            {
+            }
+        };
+        return DelayAwaiter {*this, seconds};
+    }
+
+    /* Polled every update; for things like a dialog being dismissed. */
+    auto until(std::function<bool()> condition)
+    {
+        struct UntilAwaiter {
+            Scheduler &scheduler;
+            std::function<bool()> condition;
+
+            bool await_ready()
+            {
+                return condition();
+            }
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                scheduler._waiters.push_back({handle, 0.0f, std::move(condition)});
+            }
+            void await_resume() noexcept
+            {
+            }
+        };
+        return UntilAwaiter {*this, std::move(condition)};
+    }
+
+    /* Resumes the waiting Task on the next update. Pass the result to APIs
+        that take a completion callback, e.g. scene transitions. */
+    std::function<void()> resumer(std::coroutine_handle<> handle);
+
+private:
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        float remaining;
+        std::function<bool()> condition;
+    };
+
+    bool resumeReady(float dt);
+    void reap();
+
+private:
+    std::vector<Waiter> _waiters;
+    std::vector<std::coroutine_handle<Task::promise_type>> _tasks;
+};
+
+}    // namespace bty
+
+#endif    // BTY_ENGINE_TASK_HPP_
@@ -0,0 +1,161 @@
+#include "engine/telemetry.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <random>
+
+#include "engine/profiler.hpp"
+
+namespace bty {
+
+/* The writer wakes at least this often, or as soon as the ring is half full. */
+static constexpr auto kFlushInterval = std::chrono::milliseconds(250);
+static constexpr uint64_t kMaxFileBytes = 16 * 1024 * 1024;
+
+void TelemetryStream::init(const std::filesystem::path &dir)
+{
+    if (_active) {
+        deinit();
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        spdlog::warn("Telemetry: failed to create '{}': {}", dir.generic_string(), ec.message());
+        return;
+    }
+
+    std::random_device rd;
+    _sessionId = (static_cast<uint64_t>(rd()) << 32) | rd();
+    _startTime = std::chrono::steady_clock::now();
+    _startUnixUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    _dir = dir;
+    _fileIndex = 0;
+    _fileBytes = 0;
+    _numWritten = 0;
+    _numDropped = 0;
+    _nextSeq = 0;
+    _batch.reserve(kRingSize);
+
+    _running = true;
+    _active = true;
+    _writer = std::thread(&TelemetryStream::run, this);
+
+    spdlog::info("Telemetry: session {:016x} writing to '{}'", _sessionId, dir.generic_string());
+}
+
+void TelemetryStream::deinit()
+{
+    if (!_active) {
+        return;
+    }
+
+    _active = false;
+    {
+        std::scoped_lock lock(_wakeMutex);
+        _running = false;
+    }
+    _wakeCv.notify_one();
+
+    /* The writer drains the ring before leaving. */
+    _writer.join();
+    _file.close();
+
+    spdlog::info("Telemetry: {} events in {} files, {} dropped", _numWritten, _fileIndex, _numDropped);
+}
+
+void TelemetryStream::push(TelemetryRecord &record)
+{
+    record.timeUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _startTime).count());
+    record.seq = _nextSeq++;
+
+    if (!_ring.push(record)) {
+        _numDropped++;
+        return;
+    }
+
+    /* Only the first push past half wakes the writer, so the rest stay a
+        copy and a store. */
+    if (_ring.size() >= kRingSize / 2 && !_wakePending.exchange(true, std::memory_order_relaxed)) {
+        _wakeCv.notify_one();
+    }
+}
+
+void TelemetryStream::run()
+{
+    Profile::instance().setThreadName("Telemetry");
+
+    for (;;) {
+        bool running;
+        {
+            std::unique_lock lock(_wakeMutex);
+            _wakeCv.wait_for(lock, kFlushInterval, [this]() {
+                return !_running || _wakePending.load(std::memory_order_relaxed);
+            });
+            running = _running;
+        }
+
+        _wakePending.store(false, std::memory_order_relaxed);
+        drain();
+
+        if (!running) {
+            break;
+        }
+    }
+}
+
+void TelemetryStream::drain()
+{
+    BTY_PROFILE_ZONE("Telemetry::drain");
+
+    TelemetryRecord record;
+    while (_ring.pop(record)) {
+        _batch.push_back(record);
+    }
+
+    if (_batch.empty()) {
+        return;
+    }
+
+    if (!_file.is_open() || _fileBytes >= kMaxFileBytes) {
+        openFile();
+    }
+
+    if (_file.is_open()) {
+        const auto bytes = sizeof(TelemetryRecord) * _batch.size();
+        _file.write(reinterpret_cast<const char *>(_batch.data()), static_cast<std::streamsize>(bytes));
+        _file.flush();
+        _fileBytes += bytes;
+        _numWritten += _batch.size();
+    }
+
+    _batch.clear();
+}
+
+void TelemetryStream::openFile()
+{
+    _file.close();
+
+    const auto path = _dir / fmt::format("{:016x}-{:03}.bin", _sessionId, _fileIndex);
+
+    _file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!_file.good()) {
+        spdlog::warn("Telemetry: failed to open '{}'", path.generic_string());
+        _file.close();
+        return;
+    }
+
+    TelemetryFileHeader header {};
+    std::memcpy(header.magic, "BTYT", 4);
+    header.version = kVersion;
+    header.recordSize = sizeof(TelemetryRecord);
+    header.sessionId = _sessionId;
+    header.startUnixUs = _startUnixUs;
+    header.fileIndex = _fileIndex;
+
+    _file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    _fileBytes = sizeof(header);
+    _fileIndex++;
+}
+
+}    // namespace bty
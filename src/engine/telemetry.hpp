@@ -0,0 +1,120 @@
+#ifndef BTY_ENGINE_TELEMETRY_HPP_
+#define BTY_ENGINE_TELEMETRY_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "engine/singleton.hpp"
+#include "engine/spsc-ring.hpp"
+
+namespace bty {
+
+/* Fixed-size binary record, as written to disk. The payload is one of the
+    event structs in game/telemetry-events.hpp, picked by type. */
+struct TelemetryRecord {
+    /* Since the stream was started. */
+    uint64_t timeUs;
+    uint32_t seq;
+    uint16_t type;
+    uint16_t size;
+    uint8_t payload[24];
+};
+
+static_assert(sizeof(TelemetryRecord) == 40);
+static_assert(std::is_trivially_copyable_v<TelemetryRecord>);
+
+/* Starts every file, followed by nothing but records. */
+struct TelemetryFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;
+    uint64_t sessionId;
+    /* Unix time in microseconds that timeUs counts from. */
+    uint64_t startUnixUs;
+    uint32_t fileIndex;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TelemetryFileHeader) == 32);
+
+/* Gameplay events as binary records for offline analysis. emit() copies the
+    event into a ring and returns; a writer thread drains the ring in batches
+    into telemetry/, starting a new file every few megabytes. If the writer
+    falls behind, events are dropped and counted rather than waiting.
+
+    emit() is for the main thread only, and costs nothing until init(). */
+class TelemetryStream {
+public:
+    static constexpr uint16_t kVersion = 1;
+
+    void init(const std::filesystem::path &dir);
+    void deinit();
+
+    bool active() const
+    {
+        return _active;
+    }
+
+    template <typename Event>
+    void emit(const Event &event)
+    {
+        static_assert(std::is_trivially_copyable_v<Event>);
+        static_assert(std::has_unique_object_representations_v<Event>, "Telemetry event has padding; add reserved bytes");
+        static_assert(sizeof(Event) <= sizeof(TelemetryRecord::payload), "Telemetry event too large for a record");
+
+        if (!_active) {
+            return;
+        }
+
+        TelemetryRecord record {};
+        record.type = Event::kType;
+        record.size = sizeof(Event);
+        std::memcpy(record.payload, &event, sizeof(Event));
+        push(record);
+    }
+
+private:
+    static constexpr size_t kRingSize = 16384;
+
+    void push(TelemetryRecord &record);
+    void run();
+    void drain();
+    void openFile();
+
+private:
+    SpscRing<TelemetryRecord, kRingSize> _ring;
+    bool _active {false};
+    uint32_t _nextSeq {0};
+    uint64_t _numDropped {0};
+    std::chrono::steady_clock::time_point _startTime;
+
+    /* Writer thread only, besides init and deinit. */
+    std::thread _writer;
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCv;
+    std::atomic<bool> _running {false};
+    std::atomic<bool> _wakePending {false};
+    std::vector<TelemetryRecord> _batch;
+    std::filesystem::path _dir;
+    std::ofstream _file;
+    uint64_t _sessionId {0};
+    uint64_t _startUnixUs {0};
+    uint64_t _fileBytes {0};
+    uint32_t _fileIndex {0};
+    uint64_t _numWritten {0};
+};
+
+}    // namespace bty
+
+using Telemetry = bty::SingletonProvider<bty::TelemetryStream>;
+
+#endif    // BTY_ENGINE_TELEMETRY_HPP_
@@ -3,14 +3,32 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <spdlog/spdlog.h>
 
+#include "engine/job-system.hpp"
+#include "engine/profiler.hpp"
+#include "gfx/gfx.hpp"
+#include "gfx/gpu-registry.hpp"
 #include "gfx/stb_image.hpp"
 
 namespace bty {
 
 void TextureCache::init(const std::string &basePath)
 {
+    BTY_PROFILE_ZONE("TextureCache::init");
+
     _basePath = basePath;
     _border.resize(8);
+
+    /* stb_image keeps this in a global, so it is set once here rather than
+        around each load, which may be running on a worker. */
+    stbi_set_flip_vertically_on_load(false);
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < 8; i++) {
+        paths.push_back(fmt::format("border-normal/box{}.png", i));
+    }
+    paths.push_back("fonts/genesis_custom.png");
+    preload(paths);
+
     for (int i = 0; i < 8; i++) {
         _border[i] = get(fmt::format("border-normal/box{}.png", i));
     }
@@ -20,11 +38,18 @@ void TextureCache::init(const std::string &basePath)
 
 void TextureCache::deinit()
 {
+    finishPrefetch();
+
     int memBefore = 0;
     glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &memBefore);
     for (auto &[path, texture] : _cache) {
-        glDeleteTextures(1, &texture.handle);
+        GpuResources::instance().remove(GpuResourceType::Texture, texture.handle);
+        GFX::instance().releaseTexture(texture.handle);
+    }
+    for (auto &[path, image] : _decoded) {
+        stbi_image_free(image.data);
     }
+    _decoded.clear();
     int memAfter = 0;
     glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &memAfter);
     spdlog::debug("TextureCache :: freed {} bytes", memAfter - memBefore);
@@ -40,37 +65,57 @@ const Font &TextureCache::getFont() const
     return _font;
 }
 
-Texture *TextureCache::get(const std::string &path, glm::ivec2 numFrames)
+Texture *TextureCache::get(const std::string &path, glm::ivec2 numFrames, std::source_location site)
 {
-    const auto texturePath = fmt::format("{}/textures/{}", _basePath, path);
+    /* Hits are common enough at runtime that building the key shouldn't
+        allocate; the buffer keeps its capacity between calls. */
+    _lookupPath.assign(_basePath).append("/textures/").append(path);
 
-    if (_cache.contains(texturePath)) {
-        return &_cache[texturePath];
+    if (auto it = _cache.find(_lookupPath); it != _cache.end()) {
+        return &it->second;
     }
 
+    BTY_PROFILE_ZONE("TextureCache::get");
+
+    const auto texturePath = _lookupPath;
+
+    Texture *texture {nullptr};
+    size_t bytes {0};
+
+    /* Sized as RGBA8 regardless of the source, since that is what drivers
+        tend to store RGB8 as. Array textures carry a full mip chain. */
     if (numFrames.x > 1 || numFrames.y > 1) {
-        return getArrayTexture(texturePath, numFrames);
+        texture = getArrayTexture(texturePath, numFrames);
+        if (texture) {
+            bytes = static_cast<size_t>(texture->frameW) * texture->frameH * texture->framesX * texture->framesY * 4 * 4 / 3;
+        }
+    }
+    else {
+        texture = getSingleTexture(texturePath);
+        if (texture) {
+            bytes = static_cast<size_t>(texture->width) * texture->height * 4;
+        }
+    }
+
+    if (texture) {
+        GpuResources::instance().add(GpuResourceType::Texture, texture->handle, gpuCategoryForTexture(path), bytes, site);
     }
 
-    return getSingleTexture(texturePath);
+    return texture;
 }
 
 Texture *TextureCache::getArrayTexture(const std::string &path, glm::ivec2 numFrames)
 {
-    int c;
-    int w;
-    int h;
-
-    stbi_set_flip_vertically_on_load(false);
-    stbi_uc *data = stbi_load(path.c_str(), &w, &h, &c, 0);
+    const auto image = decode(path);
 
-    if (!data) {
-        spdlog::error("stbi error: {}: {}", path, stbi_failure_reason());
+    if (!image.data) {
         return nullptr;
     }
-    else {
-        // spdlog::debug("Texture {} dimensions {}x{} components {}. Frames: {}x{}", path, w, h, c, numFrames.x, numFrames.y);
-    }
+
+    const int w = image.width;
+    const int h = image.height;
+    const int c = image.components;
+    stbi_uc *data = image.data;
 
     GLenum internalFormat = c == 3 ? GL_RGB8 : GL_RGBA8;
     GLenum format = c == 3 ? GL_RGB : GL_RGBA;
@@ -103,6 +148,7 @@ Texture *TextureCache::getArrayTexture(const std::string &path, glm::ivec2 numFr
     }
 
     glGenerateTextureMipmap(tex);
+    GpuResources::instance().addUpload(static_cast<size_t>(w) * h * c);
 
     glTextureParameterf(tex, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
     glTextureParameterf(tex, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -119,20 +165,16 @@ Texture *TextureCache::getArrayTexture(const std::string &path, glm::ivec2 numFr
 
 Texture *TextureCache::getSingleTexture(const std::string &path)
 {
-    int c;
-    int w;
-    int h;
-
-    stbi_set_flip_vertically_on_load(false);
-    stbi_uc *data = stbi_load(path.c_str(), &w, &h, &c, 0);
+    const auto image = decode(path);
 
-    if (!data) {
-        spdlog::error("stbi error: {}: {}", path, stbi_failure_reason());
+    if (!image.data) {
         return nullptr;
     }
-    else {
-        // spdlog::debug("Texture {} dimensions {}x{} components {}", path, w, h, c);
-    }
+
+    const int w = image.width;
+    const int h = image.height;
+    const int c = image.components;
+    stbi_uc *data = image.data;
 
     GLenum internalFormat = c == 3 ? GL_RGB8 : GL_RGBA8;
     GLenum format = c == 3 ? GL_RGB : GL_RGBA;
@@ -149,6 +191,7 @@ Texture *TextureCache::getSingleTexture(const std::string &path)
 
     glTextureStorage2D(tex, 1, internalFormat, w, h);
     glTextureSubImage2D(tex, 0, 0, 0, w, h, format, GL_UNSIGNED_BYTE, data);
+    GpuResources::instance().addUpload(static_cast<size_t>(w) * h * c);
 
     stbi_image_free(data);
 
@@ -157,6 +200,121 @@ Texture *TextureCache::getSingleTexture(const std::string &path)
     return &_cache[path];
 }
 
+TextureCache::Image TextureCache::decode(const std::string &path)
+{
+    BTY_PROFILE_ZONE("TextureCache::decode");
+
+    if (_prefetching.contains(path)) {
+        finishPrefetch();
+    }
+
+    {
+        std::scoped_lock lock(_decodedMutex);
+        auto it = _decoded.find(path);
+        if (it != _decoded.end()) {
+            const auto image = it->second;
+            _decoded.erase(it);
+            return image;
+        }
+    }
+
+    /* Prefetch jobs may still be decoding other paths on the workers; the
+        flip flag is only ever set in init() and the failure reason is per
+        thread, so this load doesn't need to wait for them. */
+    Image image;
+    image.data = stbi_load(path.c_str(), &image.width, &image.height, &image.components, 0);
+
+    if (!image.data) {
+        spdlog::error("stbi error: {}: {}", path, stbi_failure_reason());
+    }
+
+    return image;
+}
+
+std::vector<std::string> TextureCache::filterUncached(const std::vector<std::string> &paths) const
+{
+    std::vector<std::string> fullPaths;
+    for (const auto &path : paths) {
+        auto texturePath = fmt::format("{}/textures/{}", _basePath, path);
+        if (!_cache.contains(texturePath) && !_decoded.contains(texturePath) && !_prefetching.contains(texturePath)) {
+            fullPaths.push_back(std::move(texturePath));
+        }
+    }
+    return fullPaths;
+}
+
+void TextureCache::preload(const std::vector<std::string> &paths)
+{
+    BTY_PROFILE_ZONE("TextureCache::preload");
+
+    std::vector<std::string> fullPaths;
+    {
+        std::scoped_lock lock(_decodedMutex);
+        fullPaths = filterUncached(paths);
+    }
+
+    std::vector<Image> images(fullPaths.size());
+
+    /* Decoding is most of the cost of a texture and needs no GL, so it can be
+        spread over the workers. Uploads still happen in get(). The failure
+        reason is per thread, so it is read on the worker that failed. */
+    Jobs::instance().parallelFor(fullPaths.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            auto &image = images[i];
+            image.data = stbi_load(fullPaths[i].c_str(), &image.width, &image.height, &image.components, 0);
+            if (!image.data) {
+                spdlog::error("stbi error: {}: {}", fullPaths[i], stbi_failure_reason());
+            }
+        }
+    });
+
+    std::scoped_lock lock(_decodedMutex);
+
+    for (size_t i = 0; i < fullPaths.size(); i++) {
+        if (images[i].data) {
+            _decoded[fullPaths[i]] = images[i];
+        }
+    }
+}
+
+void TextureCache::prefetch(const std::vector<std::string> &paths)
+{
+    BTY_PROFILE_ZONE("TextureCache::prefetch");
+
+    std::vector<std::string> fullPaths;
+    {
+        std::scoped_lock lock(_decodedMutex);
+        fullPaths = filterUncached(paths);
+    }
+
+    for (auto &path : fullPaths) {
+        _prefetching.insert(path);
+
+        auto job = [this, path]() {
+            BTY_PROFILE_ZONE("TextureCache::prefetch decode");
+
+            Image image;
+            image.data = stbi_load(path.c_str(), &image.width, &image.height, &image.components, 0);
+            if (!image.data) {
+                spdlog::error("stbi error: {}: {}", path, stbi_failure_reason());
+                return;
+            }
+            std::scoped_lock lock(_decodedMutex);
+            _decoded[path] = image;
+        };
+        Jobs::instance().submit(job, &_prefetchJobs);
+    }
+}
+
+void TextureCache::finishPrefetch()
+{
+    if (_prefetching.empty()) {
+        return;
+    }
+    Jobs::instance().wait(_prefetchJobs);
+    _prefetching.clear();
+}
+
 const std::string &TextureCache::getBasePath() const
 {
     return _basePath;
@@ -174,9 +332,33 @@ void TextureCache::free(const Texture *texture)
         spdlog::warn("Attempted to free texture not contained in cache");
     }
     else {
-        glDeleteTextures(1, &const_cast<Texture *>(texture)->handle);
+        GpuResources::instance().remove(GpuResourceType::Texture, texture->handle);
+        GFX::instance().releaseTexture(texture->handle);
         _cache.erase(it->first);
     }
 }
 
+void TextureCache::free(const std::string &path)
+{
+    const auto texturePath = fmt::format("{}/textures/{}", _basePath, path);
+
+    if (_prefetching.contains(texturePath)) {
+        finishPrefetch();
+    }
+
+    {
+        std::scoped_lock lock(_decodedMutex);
+        auto it = _decoded.find(texturePath);
+        if (it != _decoded.end()) {
+            stbi_image_free(it->second.data);
+            _decoded.erase(it);
+        }
+    }
+
+    auto it = _cache.find(texturePath);
+    if (it != _cache.end()) {
+        free(&it->second);
+    }
+}
+
 }    // namespace bty
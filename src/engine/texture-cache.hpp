@@ -2,9 +2,14 @@
 #define BTY_ENGINE_TEXTURE_CACHE_HPP
 
 #include <glm/vec2.hpp>
+#include <mutex>
+#include <source_location>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "engine/job-system.hpp"
 #include "engine/singleton.hpp"
 #include "gfx/font.hpp"
 #include "gfx/gl.hpp"
@@ -19,17 +24,39 @@ public:
 
     const std::vector<const Texture *> &getBorder() const;
     const Font &getFont() const;
-    Texture *get(const std::string &path, glm::ivec2 numFrames = {1, 1});
+    Texture *get(const std::string &path, glm::ivec2 numFrames = {1, 1}, std::source_location site = std::source_location::current());
     const std::string &getBasePath() const;
     void free(const Texture *texture);
+    void free(const std::string &path);
+    void preload(const std::vector<std::string> &paths);
+    /* Like preload() but returns straight away; get() waits for the decode
+        if it gets there first. */
+    void prefetch(const std::vector<std::string> &paths);
 
 private:
+    struct Image {
+        int width {0};
+        int height {0};
+        int components {0};
+        unsigned char *data {nullptr};
+    };
+
+    Image decode(const std::string &path);
+    std::vector<std::string> filterUncached(const std::vector<std::string> &paths) const;
+    void finishPrefetch();
     Texture *getSingleTexture(const std::string &path);
     Texture *getArrayTexture(const std::string &path, glm::ivec2 numFrames);
 
 private:
     std::string _basePath;
     std::unordered_map<std::string, Texture> _cache;
+    std::string _lookupPath;
+    /* Decoded by preload() and waiting for get() to upload them. */
+    std::unordered_map<std::string, Image> _decoded;
+    std::mutex _decodedMutex;
+    /* Paths handed to prefetch jobs that may not have finished yet. */
+    std::unordered_set<std::string> _prefetching;
+    JobCounter _prefetchJobs;
     std::vector<const Texture *> _border;
     Font _font;
 };
@@ -0,0 +1,281 @@
+#include "engine/timer-wheel.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace bty {
+
+uint32_t TimerWheel::toTicks(float seconds)
+{
+    return std::max(1u, static_cast<uint32_t>(std::lround(seconds / kTickSeconds)));
+}
+
+TimerWheel::Id TimerWheel::add(float periodSeconds, std::function<void()> callback, uint32_t groups)
+{
+    Id id;
+    if (!_free.empty()) {
+        id = _free.back();
+        _free.pop_back();
+    }
+    else {
+        id = static_cast<Id>(_entries.size());
+        _entries.emplace_back();
+    }
+
+    auto &entry = _entries[id];
+    entry.callback = std::move(callback);
+    entry.period = toTicks(periodSeconds);
+    entry.remaining = entry.period;
+    entry.groups = groups;
+    entry.paused = false;
+    entry.scheduled = false;
+    entry.live = true;
+
+    update(id);
+
+    return id;
+}
+
+void TimerWheel::remove(Id id)
+{
+    unschedule(id);
+    _entries[id].live = false;
+
+    /* Its callback is what's running, so it can only go afterwards. */
+    if (id == _running) {
+        _removeRunning = true;
+        return;
+    }
+
+    release(id);
+}
+
+void TimerWheel::setPeriod(Id id, float periodSeconds)
+{
+    auto &entry = _entries[id];
+
+    const auto period = toTicks(periodSeconds);
+    if (period == entry.period) {
+        return;
+    }
+
+    const uint64_t left = entry.scheduled ? entry.due - _now : entry.remaining;
+    const uint64_t elapsed = entry.period > left ? entry.period - left : 0;
+
+    entry.period = period;
+    entry.remaining = period > elapsed ? period - elapsed : 1;
+
+    if (entry.scheduled) {
+        entry.generation++;
+        schedule(id, _now + entry.remaining);
+    }
+}
+
+void TimerWheel::restart(Id id)
+{
+    auto &entry = _entries[id];
+    entry.remaining = entry.period;
+
+    if (entry.scheduled) {
+        entry.generation++;
+        schedule(id, _now + entry.period);
+    }
+}
+
+void TimerWheel::setPaused(Id id, bool paused)
+{
+    auto &entry = _entries[id];
+    if (entry.paused == paused) {
+        return;
+    }
+
+    entry.paused = paused;
+    update(id);
+}
+
+void TimerWheel::setGroupPaused(uint32_t groups, bool paused)
+{
+    const auto pausedGroups = paused ? (_pausedGroups | groups) : (_pausedGroups & ~groups);
+    if (pausedGroups == _pausedGroups) {
+        return;
+    }
+
+    _pausedGroups = pausedGroups;
+
+    for (Id id = 0; id < _entries.size(); id++) {
+        if (_entries[id].live && (_entries[id].groups & groups)) {
+            update(id);
+        }
+    }
+}
+
+void TimerWheel::trigger(Id id)
+{
+    if (_entries[id].callback) {
+        _entries[id].callback();
+    }
+    else {
+        spdlog::warn("Timer without a callback");
+    }
+}
+
+void TimerWheel::advance()
+{
+    _now++;
+
+    /* Each time a level's lower bits wrap, its current slot is spread over
+        the levels below. */
+    for (int level = 1; level < kLevels; level++) {
+        const int shift = kSlotBits * level;
+        if ((_now & ((uint64_t {1} << shift) - 1)) != 0) {
+            break;
+        }
+
+        _cascading.swap(_slots[level][(_now >> shift) & kSlotMask]);
+        for (const auto &slotEntry : _cascading) {
+            if (!isStale(slotEntry)) {
+                place(slotEntry, _entries[slotEntry.id].due);
+            }
+        }
+        _cascading.clear();
+    }
+
+    auto &slot = _slots[0][_now & kSlotMask];
+    for (const auto &slotEntry : slot) {
+        if (!isStale(slotEntry)) {
+            _firing.push_back(slotEntry);
+        }
+    }
+    slot.clear();
+
+    if (_firing.empty()) {
+        return;
+    }
+
+    std::sort(_firing.begin(), _firing.end(), [this](const SlotEntry &a, const SlotEntry &b) {
+        return _entries[a.id].seq < _entries[b.id].seq;
+    });
+
+    for (const auto slotEntry : _firing) {
+        /* An earlier callback may have paused or restarted this one. */
+        if (isStale(slotEntry)) {
+            continue;
+        }
+
+        auto &entry = _entries[slotEntry.id];
+        schedule(slotEntry.id, _now + entry.period);
+
+        _running = slotEntry.id;
+        entry.callback();
+        _running = UINT32_MAX;
+
+        if (_removeRunning) {
+            _removeRunning = false;
+            release(slotEntry.id);
+        }
+    }
+    _firing.clear();
+}
+
+float TimerWheel::nextDue() const
+{
+    uint64_t next = UINT64_MAX;
+
+    for (const auto &level : _slots) {
+        for (const auto &slot : level) {
+            for (const auto &slotEntry : slot) {
+                if (!isStale(slotEntry)) {
+                    next = std::min(next, _entries[slotEntry.id].due);
+                }
+            }
+        }
+    }
+
+    if (next == UINT64_MAX) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    return (next - _now) * kTickSeconds;
+}
+
+bool TimerWheel::isStale(const SlotEntry &slotEntry) const
+{
+    const auto &entry = _entries[slotEntry.id];
+    return !entry.scheduled || entry.generation != slotEntry.generation;
+}
+
+bool TimerWheel::shouldRun(const Entry &entry) const
+{
+    return entry.live && !entry.paused && !(entry.groups & _pausedGroups);
+}
+
+void TimerWheel::schedule(Id id, uint64_t due)
+{
+    auto &entry = _entries[id];
+    entry.due = due;
+    entry.seq = _nextSeq++;
+    entry.scheduled = true;
+    place({id, entry.generation}, due);
+}
+
+void TimerWheel::unschedule(Id id)
+{
+    auto &entry = _entries[id];
+    if (!entry.scheduled) {
+        return;
+    }
+
+    entry.remaining = entry.due > _now ? entry.due - _now : 1;
+    entry.scheduled = false;
+    entry.generation++;
+}
+
+void TimerWheel::place(const SlotEntry &slotEntry, uint64_t due)
+{
+    /* Only while cascading, for timers due on the tick being processed. */
+    if (due <= _now) {
+        _firing.push_back(slotEntry);
+        return;
+    }
+
+    const auto delta = due - _now;
+    for (int level = 0; level < kLevels; level++) {
+        const int shift = kSlotBits * level;
+        if (delta < (uint64_t {1} << (shift + kSlotBits))) {
+            _slots[level][(due >> shift) & kSlotMask].push_back(slotEntry);
+            return;
+        }
+    }
+
+    /* Further out than the wheel reaches (days of play): park it in the
+        furthest slot and let it cascade back up from there. */
+    const int shift = kSlotBits * (kLevels - 1);
+    const auto parked = _now + (uint64_t {1} << (kSlotBits * kLevels)) - 1;
+    _slots[kLevels - 1][(parked >> shift) & kSlotMask].push_back(slotEntry);
+}
+
+void TimerWheel::update(Id id)
+{
+    const auto &entry = _entries[id];
+    const bool run = shouldRun(entry);
+
+    if (run && !entry.scheduled) {
+        schedule(id, _now + entry.remaining);
+    }
+    else if (!run && entry.scheduled) {
+        unschedule(id);
+    }
+}
+
+void TimerWheel::release(Id id)
+{
+    auto &entry = _entries[id];
+    entry.callback = nullptr;
+    entry.generation++;
+    _free.push_back(id);
+}
+
+}    // namespace bty
@@ -0,0 +1,98 @@
+#ifndef BTY_ENGINE_TIMER_WHEEL_HPP_
+#define BTY_ENGINE_TIMER_WHEEL_HPP_
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "engine/singleton.hpp"
+
+namespace bty {
+
+/* Repeating timers on a hierarchical timing wheel, advanced one tick per
+    simulation step, so they follow the time scale and stand still while
+    the simulation does. Only timers that are due cost anything: a tick
+    looks at one slot, and a paused timer isn't in the wheel at all.
+
+    Timers due on the same tick fire in the order they were scheduled.
+    Every timer belongs to a set of groups, and pausing a group pauses all
+    of them, keeping whatever time they had left. */
+class TimerWheel {
+public:
+    using Id = uint32_t;
+
+    /* One simulation step. */
+    static constexpr float kTickSeconds = 1.0f / 60.0f;
+
+    Id add(float periodSeconds, std::function<void()> callback, uint32_t groups = 0);
+    void remove(Id id);
+
+    /* Keeps the time already elapsed towards the next firing. */
+    void setPeriod(Id id, float periodSeconds);
+    /* Starts counting the period again from now. */
+    void restart(Id id);
+    void setPaused(Id id, bool paused);
+    void setGroupPaused(uint32_t groups, bool paused);
+    void trigger(Id id);
+
+    void advance();
+    /* Seconds until the next timer fires, or infinity if none will. */
+    float nextDue() const;
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+
+    struct Entry {
+        std::function<void()> callback;
+        uint64_t due {0};
+        /* Ticks left while not scheduled. */
+        uint64_t remaining {0};
+        uint64_t seq {0};
+        uint32_t period {1};
+        uint32_t groups {0};
+        uint32_t generation {0};
+        bool paused {false};
+        bool scheduled {false};
+        bool live {false};
+    };
+
+    /* Slots aren't cleaned up when a timer is unscheduled; entries whose
+        generation is stale are skipped when their slot comes round. */
+    struct SlotEntry {
+        Id id;
+        uint32_t generation;
+    };
+
+    static uint32_t toTicks(float seconds);
+    bool isStale(const SlotEntry &slotEntry) const;
+    bool shouldRun(const Entry &entry) const;
+    void schedule(Id id, uint64_t due);
+    void unschedule(Id id);
+    void place(const SlotEntry &slotEntry, uint64_t due);
+    void update(Id id);
+    void release(Id id);
+
+private:
+    /* A deque, so callbacks can add timers while an entry is running. */
+    std::deque<Entry> _entries;
+    std::vector<Id> _free;
+    std::array<std::array<std::vector<SlotEntry>, kSlots>, kLevels> _slots;
+    std::vector<SlotEntry> _cascading;
+    std::vector<SlotEntry> _firing;
+    uint64_t _now {0};
+    uint64_t _nextSeq {0};
+    uint32_t _pausedGroups {0};
+    Id _running {UINT32_MAX};
+    bool _removeRunning {false};
+};
+
+}    // namespace bty
+
+using Timers = bty::SingletonProvider<bty::TimerWheel>;
+
+#endif    // BTY_ENGINE_TIMER_WHEEL_HPP_
@@ -1,42 +1,35 @@
 #include "engine/timer.hpp"
 
-#include <spdlog/spdlog.h>
-
 namespace bty {
 
-Timer::Timer(float durationSeconds, std::function<void()> callback)
-    : _callback(std::move(callback))
-    , _durationSeconds(durationSeconds)
+Timer::Timer(float durationSeconds, std::function<void()> callback, uint32_t groups)
+    : _id(Timers::instance().add(durationSeconds, std::move(callback), groups))
+{
+}
+
+Timer::~Timer()
 {
+    Timers::instance().remove(_id);
 }
 
 void Timer::setDuration(float durationSeconds)
 {
-    _durationSeconds = durationSeconds;
+    Timers::instance().setPeriod(_id, durationSeconds);
 }
 
-void Timer::tick(float dt)
+void Timer::setPaused(bool paused)
 {
-    _elapsedTime += dt;
-    if (_elapsedTime >= _durationSeconds) {
-        _elapsedTime = 0.0f;
-        trigger();
-    }
+    Timers::instance().setPaused(_id, paused);
 }
 
 void Timer::reset()
 {
-    _elapsedTime = 0.0f;
+    Timers::instance().restart(_id);
 }
 
 void Timer::trigger()
 {
-    if (_callback) {
-        _callback();
-    }
-    else {
-        spdlog::warn("Timer without a callback");
-    }
+    Timers::instance().trigger(_id);
 }
 
 }    // namespace bty
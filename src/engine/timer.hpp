@@ -1,22 +1,31 @@
 #ifndef ENGINE_TIMER_HPP_
 #define ENGINE_TIMER_HPP_
 
+#include <cstdint>
 #include <functional>
 
+#include "engine/timer-wheel.hpp"
+
 namespace bty {
 
+/* A repeating timer on the engine's TimerWheel. It runs from construction
+    until it is destroyed, unless paused, by itself or through one of its
+    groups. */
 class Timer {
 public:
-    Timer(float durationSeconds, std::function<void()> callback);
+    Timer(float durationSeconds, std::function<void()> callback, uint32_t groups = 0);
+    ~Timer();
+
+    Timer(const Timer &) = delete;
+    Timer &operator=(const Timer &) = delete;
+
     void setDuration(float durationSeconds);
-    void tick(float dt);
+    void setPaused(bool paused);
     void reset();
     void trigger();
 
 private:
-    std::function<void()> _callback {nullptr};
-    float _durationSeconds {0.0f};
-    float _elapsedTime {0.0f};
+    TimerWheel::Id _id;
 };
 
 }    // namespace bty
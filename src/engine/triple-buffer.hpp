@@ -0,0 +1,53 @@
+#ifndef BTY_ENGINE_TRIPLE_BUFFER_HPP_
+#define BTY_ENGINE_TRIPLE_BUFFER_HPP_
+
+#include <array>
+#include <atomic>
+
+namespace bty {
+
+/* Lock-free hand-off of the latest value from one producer to one consumer.
+    The producer always has a slot to write into and the consumer always has
+    a slot to read from; publish() and acquire() swap through a middle slot,
+    so neither side ever waits on the other. Values the consumer was too slow
+    to pick up are overwritten. */
+template <typename T>
+class TripleBuffer {
+public:
+    T &back()
+    {
+        return _slots[_back];
+    }
+
+    void publish()
+    {
+        _back = _middle.exchange(_back | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    bool acquire()
+    {
+        if (!(_middle.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        _front = _middle.exchange(_front, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    T &front()
+    {
+        return _slots[_front];
+    }
+
+private:
+    static constexpr int kFresh = 4;
+    static constexpr int kIndexMask = 3;
+
+    std::array<T, 3> _slots;
+    int _back {0};
+    int _front {1};
+    std::atomic<int> _middle {2};
+};
+
+}    // namespace bty
+
+#endif    // BTY_ENGINE_TRIPLE_BUFFER_HPP_
@@ -2,6 +2,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "data/bounty.hpp"
@@ -10,13 +11,17 @@
 #include "data/spells.hpp"
 #include "data/villains.hpp"
 #include "engine/engine.hpp"
+#include "engine/frame-arena.hpp"
+#include "engine/profiler.hpp"
 #include "engine/scene-manager.hpp"
+#include "engine/telemetry.hpp"
 #include "engine/texture-cache.hpp"
 #include "game/army-gen.hpp"
 #include "game/game-controls.hpp"
 #include "game/game-options.hpp"
 #include "game/hud.hpp"
 #include "game/state.hpp"
+#include "game/telemetry-events.hpp"
 #include "gfx/gfx.hpp"
 
 static constexpr char const *kSiegeVictoryMessage = {
@@ -114,25 +119,29 @@ void Battle::load()
 
     _dlgVictoryVsMobs.create(5, 10, 30, 9);
     _btVictoryVsMobs = _dlgVictoryVsMobs.addString(1, 1);
-    _dlgVictoryVsMobs.bind(Key::Enter, [this](int) {
-        _engine.getGUI().popDialog();
-        _engine.winEncounterBattle(_mobId);
-    });
-    _dlgVictoryVsMobs.bind(Key::Backspace, [this](int) {
-        _engine.getGUI().popDialog();
-        _engine.winEncounterBattle(_mobId);
-    });
 
     _dlgVictoryVsVillain.create(5, 6, 30, 18);
     _btVictoryVsVillain = _dlgVictoryVsVillain.addString(1, 1);
-    _dlgVictoryVsVillain.bind(Key::Enter, [this](int) {
-        _engine.getGUI().popDialog();
-        _engine.winSiegeBattle(_castleId);
-    });
-    _dlgVictoryVsVillain.bind(Key::Backspace, [this](int) {
-        _engine.getGUI().popDialog();
-        _engine.winSiegeBattle(_castleId);
-    });
+}
+
+std::vector<std::string> Battle::getAssets() const
+{
+    return {
+        "battle/encounter.png",
+        "battle/siege.png",
+        "battle/active-unit.png",
+        "battle/enemy.png",
+        "battle/out-of-control.png",
+        "battle/damage-marker.png",
+        "battle/selection.png",
+        "battle/melee.png",
+        "battle/shoot.png",
+        "battle/magic.png",
+        "battle/obstacle-0.png",
+        "battle/obstacle-1.png",
+        "battle/obstacle-2.png",
+        "fonts/board-font.png",
+    };
 }
 
 void Battle::enter()
@@ -145,7 +154,8 @@ void Battle::enter()
 
     _engine.getGUI().getHUD().setBlankFrame();
 
-    _delayTimer = 0;
+    _scheduler.clear();
+    _inDelay = false;
 
     auto color {bty::getBoxColor(State::difficulty)};
     _dlgVictoryVsMobs.setColor(color);
@@ -254,22 +264,7 @@ void Battle::update(float dt)
         }
     }
 
-    if (_inDelay) {
-        _delayTimer += dt;
-        if (_delayTimer >= _realDelayDuration) {
-            _inDelay = false;
-            _delayTimer = 0;
-            if (_delayCallback) {
-                auto cb = _delayCallback;
-                _delayCallback = nullptr;
-                cb();
-
-                if (battleEnd()) {
-                    return;
-                }
-            }
-        }
-    }
+    _scheduler.update(dt);
 
     for (int i = 0; i < 2; i++) {
         for (int j = 0; j < 5; j++) {
@@ -343,13 +338,13 @@ void Battle::uiUpdateStatus()
     auto &unit = battleGetUnit();
 
     if (unit.flying) {
-        uiSetStatus(fmt::format("{} fly", battleGetName()));
+        uiSetStatus(bty::frameFormat("{} fly", battleGetName()));
     }
     else if (battleCanShoot()) {
-        uiSetStatus(fmt::format("{} Attack, Shoot or Move {}", battleGetName(), unit.moves));
+        uiSetStatus(bty::frameFormat("{} Attack, Shoot or Move {}", battleGetName(), unit.moves));
     }
     else {
-        uiSetStatus(fmt::format("{} Attack or Move {}", battleGetName(), unit.moves));
+        uiSetStatus(bty::frameFormat("{} Attack or Move {}", battleGetName(), unit.moves));
     }
 }
 
@@ -796,7 +791,7 @@ void Battle::battleDoAction(Action action)
 
 void Battle::afnWait(Action action)
 {
-    uiSetStatus(fmt::format("{} wait", battleGetName()));
+    uiSetStatus(bty::frameFormat("{} wait", battleGetName()));
     _unitStates[action.from.x][action.from.y].waits++;
     battleDelayThen([this]() {
         battleOnMove();
@@ -805,7 +800,7 @@ void Battle::afnWait(Action action)
 
 void Battle::afnPass(Action action)
 {
-    uiSetStatus(fmt::format("{} pass", battleGetName()));
+    uiSetStatus(bty::frameFormat("{} pass", battleGetName()));
     _unitStates[action.from.x][action.from.y].moves = 0;
     battleDelayThen([this]() {
         battleOnMove();
@@ -837,7 +832,7 @@ void Battle::afnTryMove(Action action)
                 /* Can shoot. */
                 if (_cursorMode != Cursor::Shoot && battleGetUnit().ammo > 0 && !boardAnyEnemyAround()) {
                     uiSetCursorMode(Cursor::Shoot);
-                    uiSetStatus(fmt::format("{} Shoot ({} left)", battleGetName(), battleGetUnit().ammo));
+                    uiSetStatus(bty::frameFormat("{} Shoot ({} left)", battleGetName(), battleGetUnit().ammo));
                 }
                 /* Already shooting, want to wait. */
                 else {
@@ -870,7 +865,7 @@ void Battle::afnMeleeAttack(Action action)
 
     int kills = battleAttack(action.from.x, action.from.y, action.to.x, action.to.y, false, false, false, 0);
 
-    uiSetStatus(fmt::format("{} attack {}, {} die", battleGetName(), kUnits[_armies[action.to.x][action.to.y]].namePlural, kills));
+    uiSetStatus(bty::frameFormat("{} attack {}, {} die", battleGetName(), kUnits[_armies[action.to.x][action.to.y]].namePlural, kills));
     battleGetUnit().moves = 0;
 
     battleDelayThen([this, action, retaliate]() {
@@ -894,7 +889,7 @@ void Battle::afnShootAttack(Action action)
 
     int kills = battleAttack(action.from.x, action.from.y, action.to.x, action.to.y, true, false, false, 0);
 
-    uiSetStatus(fmt::format("{} shoot {}, {} die", battleGetName(), kUnits[_armies[action.to.x][action.to.y]].namePlural, kills));
+    uiSetStatus(bty::frameFormat("{} shoot {}, {} die", battleGetName(), kUnits[_armies[action.to.x][action.to.y]].namePlural, kills));
     battleGetUnit().moves = 0;
 
     battleDelayThen([this, action]() {
@@ -906,15 +901,39 @@ void Battle::afnShootAttack(Action action)
 
 void Battle::battleDelayThen(std::function<void()> callback)
 {
+    /* A new delay replaces whatever was pending; the old sequence sees its
+        id is stale and ends without running its callback. */
     _inDelay = true;
-    _delayTimer = 0;
-    _delayCallback = callback;
+    _scheduler.spawn(battleDelaySequence(std::move(callback), ++_delayId));
+}
+
+bty::Task Battle::battleDelaySequence(std::function<void()> callback, int delayId)
+{
+    co_await _scheduler.delay(_realDelayDuration);
+
+    if (delayId != _delayId) {
+        co_return;
+    }
+
+    _inDelay = false;
+    if (callback) {
+        callback();
+
+        /* In instant mode the next delay resumes within the same update, so
+            this is the only place to catch the battle ending. Whatever the
+            callback queued is dropped, and staying in the delay keeps the AI
+            from acting again. */
+        if (battleEnd()) {
+            ++_delayId;
+            _inDelay = true;
+        }
+    }
 }
 
 void Battle::afnRetaliate(Action action)
 {
     int kills = battleAttack(action.from.x, action.from.y, action.to.x, action.to.y, false, false, true, 0);
-    uiSetStatus(fmt::format("{} retaliate, killing {}", kUnits[_armies[action.from.x][action.from.y]].namePlural, kills));
+    uiSetStatus(bty::frameFormat("{} retaliate, killing {}", kUnits[_armies[action.from.x][action.from.y]].namePlural, kills));
 
     battleDelayThen([this, action]() {
         uiUpdateCount(action.to.x, action.to.y);
@@ -941,7 +960,7 @@ void Battle::battleSwitchTeam()
 
     battleResetMoves();
     if (_unitStates[_curUnit.x][_curUnit.y].frozen && !boardAnyEnemyAround()) {
-        uiSetStatus(fmt::format("{} are frozen", battleGetName()));
+        uiSetStatus(bty::frameFormat("{} are frozen", battleGetName()));
         battleDelayThen([this]() {
             battleOnMove();
         });
@@ -1205,7 +1224,7 @@ void Battle::afnSpellTeleport(Action action)
     _choosingTeleportDest = false;
     boardMoveUnitTo(action.from.x, action.from.y, action.to.x, action.to.y);
     _spCurrent.setPosition(16.0f + battleGetUnit().x * 48.0f, 24.0f + battleGetUnit().y * 40.0f);
-    uiSetStatus(fmt::format("{} are teleported", kUnits[_armies[_teleportTargetTeam][_teleportTargetUnit]].namePlural));
+    uiSetStatus(bty::frameFormat("{} are teleported", kUnits[_armies[_teleportTargetTeam][_teleportTargetUnit]].namePlural));
     battleDelayThen([this]() {
         uiUpdateState();
     });
@@ -1216,7 +1235,7 @@ void Battle::afnSpellClone(Action action)
     int clone_amount = 10 * State::spell_power;
     auto [unit, enemy] = boardGetUnitAt(action.to.x, action.to.y);
     _unitStates[0][unit].count += clone_amount;
-    uiSetStatus(fmt::format("{} {} are cloned", clone_amount, kUnits[_armies[0][unit]].namePlural));
+    uiSetStatus(bty::frameFormat("{} {} are cloned", clone_amount, kUnits[_armies[0][unit]].namePlural));
     uiUpdateCounts();
     battleDelayThen([this]() {
         uiUpdateState();
@@ -1228,7 +1247,7 @@ void Battle::afnSpellFreeze(Action action)
     auto [unit, enemy] = boardGetUnitAt(action.to.x, action.to.y);
     int team = enemy ? !_curUnit.x : _curUnit.x;
     _unitStates[team][unit].frozen = true;
-    uiSetStatus(fmt::format("{} are frozen", kUnits[_armies[team][unit]].namePlural));
+    uiSetStatus(bty::frameFormat("{} are frozen", kUnits[_armies[team][unit]].namePlural));
     battleDelayThen([this]() {
         uiUpdateState();
     });
@@ -1242,7 +1261,7 @@ void Battle::afnSpellResurrect(Action action)
     numResurrected = std::min(numResurrected, us.startCount - us.count);
     us.count += numResurrected;
     State::followers_killed = std::max(0, State::followers_killed - numResurrected);
-    uiSetStatus(fmt::format("{} {} are resurrected", numResurrected, kUnits[_armies[0][unit]].namePlural));
+    uiSetStatus(bty::frameFormat("{} {} are resurrected", numResurrected, kUnits[_armies[0][unit]].namePlural));
     uiUpdateCounts();
     battleDelayThen([this]() {
         uiUpdateState();
@@ -1270,7 +1289,7 @@ void Battle::afnSpellFireball(Action action)
 
     int kills = battleAttack(action.from.x, action.from.y, targetTeam, targetUnit, false, true, false, 25 * State::spell_power);
 
-    uiSetStatus(fmt::format("Fireball kills {} {}", kills, kUnits[_armies[targetTeam][targetUnit]].namePlural));
+    uiSetStatus(bty::frameFormat("Fireball kills {} {}", kills, kUnits[_armies[targetTeam][targetUnit]].namePlural));
     battleGetUnit().moves = 0;
 
     battleDelayThen([=, this]() {
@@ -1301,7 +1320,7 @@ void Battle::afnSpellLightning(Action action)
 
     int kills = battleAttack(action.from.x, action.from.y, targetTeam, targetUnit, false, true, false, 10 * State::spell_power);
 
-    uiSetStatus(fmt::format("Lightning kills {} {}", kills, kUnits[_armies[targetTeam][targetUnit]].namePlural));
+    uiSetStatus(bty::frameFormat("Lightning kills {} {}", kills, kUnits[_armies[targetTeam][targetUnit]].namePlural));
     battleGetUnit().moves = 0;
 
     battleDelayThen([=, this]() {
@@ -1337,14 +1356,14 @@ void Battle::afnSpellTurnUndead(Action action)
 
     int magicDmg = 0;
     if (!(kUnits[_armies[targetTeam][targetUnit]].abilities & AbilityUndead)) {
-        uiSetStatus(fmt::format("{} are not undead!", kUnits[_armies[targetTeam][targetUnit]].namePlural));
+        uiSetStatus(bty::frameFormat("{} are not undead!", kUnits[_armies[targetTeam][targetUnit]].namePlural));
         battleDelayThen([=, this]() {
             uiUpdateState();
         });
     }
     else {
         int kills = battleAttack(action.from.x, action.from.y, targetTeam, targetUnit, false, true, false, 50 * State::spell_power);
-        uiSetStatus(fmt::format("Turn undead kills {} {}", kills, kUnits[_armies[targetTeam][targetUnit]].namePlural));
+        uiSetStatus(bty::frameFormat("Turn undead kills {} {}", kills, kUnits[_armies[targetTeam][targetUnit]].namePlural));
         battleGetUnit().moves = 0;
         battleDelayThen([=, this]() {
             uiUpdateCount(targetTeam, targetUnit);
@@ -1397,6 +1416,8 @@ void Battle::battleVictory()
 {
     int goldTotal = addVictoryGold();
 
+    Telemetry::instance().emit(TelemetryBattle {_siege ? _castleId : _mobId, State::followers_killed, State::gold, State::days, _siege, true, {}});
+
     if (_siege) {
         /* Check occupier of the castle. */
         if (State::castle_occupants[_castleId] != 0x7F) {
@@ -1406,13 +1427,14 @@ void Battle::battleVictory()
             if (State::contract == villain) {
                 State::gold += kVillainRewards[State::contract];
                 _btVictoryVsVillain->setString(fmt::format(kSiegeVictoryMessage, kShortHeroNames[State::hero], bty::numberK(goldTotal), kVillains[villain][0], kVillainRewards[villain]));
-                _engine.getGUI().pushDialog(_dlgVictoryVsVillain);
+                _engine.getScheduler().spawn(victorySequence(_dlgVictoryVsVillain, true, _castleId));
                 State::villains_captured[State::contract] = true;
+                Telemetry::instance().emit(TelemetryVillainCaptured {villain, State::days, static_cast<int32_t>(std::count(State::villains_captured.begin(), State::villains_captured.end(), true))});
                 State::contract = 17;
             }
             else {
                 _btVictoryVsVillain->setString(fmt::format(kSiegeVictoryMessageNoContract, kShortHeroNames[State::hero], bty::numberK(goldTotal), kVillains[villain][0]));
-                _engine.getGUI().pushDialog(_dlgVictoryVsVillain);
+                _engine.getScheduler().spawn(victorySequence(_dlgVictoryVsVillain, true, _castleId));
                 relocateVillain(villain);
             }
         }
@@ -1420,29 +1442,13 @@ void Battle::battleVictory()
             /* The castle we sieged was occupied by monsters. */
             _btVictoryVsMobs->setString(fmt::format(kEncounterVictoryMessage, kShortHeroNames[State::hero], bty::numberK(goldTotal)));
             /* Make sure we count it as a siege win though. */
-            _dlgVictoryVsMobs.bind(Key::Enter, [this](int) {
-                _engine.getGUI().popDialog();
-                _engine.winSiegeBattle(_castleId);
-            });
-            _dlgVictoryVsMobs.bind(Key::Backspace, [this](int) {
-                _engine.getGUI().popDialog();
-                _engine.winSiegeBattle(_castleId);
-            });
-            _engine.getGUI().pushDialog(_dlgVictoryVsMobs);
+            _engine.getScheduler().spawn(victorySequence(_dlgVictoryVsMobs, true, _castleId));
         }
     }
     else {
         _btVictoryVsMobs->setString(fmt::format(kEncounterVictoryMessage, kShortHeroNames[State::hero], bty::numberK(goldTotal)));
         /* Make sure we count it as an encounter win. */
-        _dlgVictoryVsMobs.bind(Key::Enter, [this](int) {
-            _engine.getGUI().popDialog();
-            _engine.winEncounterBattle(_mobId);
-        });
-        _dlgVictoryVsMobs.bind(Key::Backspace, [this](int) {
-            _engine.getGUI().popDialog();
-            _engine.winEncounterBattle(_mobId);
-        });
-        _engine.getGUI().pushDialog(_dlgVictoryVsMobs);
+        _engine.getScheduler().spawn(victorySequence(_dlgVictoryVsMobs, false, _mobId));
     }
 
     for (int i = 0; i < 5; i++) {
@@ -1451,12 +1457,26 @@ void Battle::battleVictory()
     }
 }
 
+/* Runs on the engine's scheduler, since it ends by leaving the battle. */
+bty::Task Battle::victorySequence(bty::Dialog &dialog, bool siege, int id)
+{
+    co_await _engine.getGUI().confirm(_engine.getScheduler(), dialog);
+
+    if (siege) {
+        _engine.winSiegeBattle(id);
+    }
+    else {
+        _engine.winEncounterBattle(id);
+    }
+}
+
 void Battle::battleDefeat()
 {
     for (int i = 0; i < 5; i++) {
         (*_extEnemyArmy)[i] = _armies[1][i];
         (*_extEnemyCounts)[i] = _unitStates[1][i].count;
     }
+    Telemetry::instance().emit(TelemetryBattle {_siege ? _castleId : _mobId, State::followers_killed, State::gold, State::days, _siege, false, {}});
     _engine.loseBattle();
 }
 
@@ -1598,7 +1618,7 @@ void Battle::pauseUseMagic()
     SceneMan::instance().setScene("usemagic");
 }
 
-void Battle::uiSetStatus(const std::string &msg, bool waitForEnter)
+void Battle::uiSetStatus(std::string_view msg, bool waitForEnter)
 {
     if (waitForEnter) {
         _engine.getGUI().getHUD().setError(msg);
@@ -1669,6 +1689,8 @@ void Battle::uiSetCursorMode(Cursor c)
 
 void Battle::aiMakeAction()
 {
+    BTY_PROFILE_ZONE("Battle::aiMakeAction");
+
     auto &unit = battleGetUnit();
 
     uiUpdateCurrentUnit();
@@ -1717,7 +1739,7 @@ void Battle::aiMakeAction()
             /* Find an unoccupied adjacent tile. */
             glm::ivec2 tile = boardGetAdjacentTile(target);
             if (tile.x != -1 && tile.y != -1) {
-                uiSetStatus(fmt::format("{} fly", battleGetName()));
+                uiSetStatus(bty::frameFormat("{} fly", battleGetName()));
                 battleDoAction({.id = AidTryMove, .from = _curUnit, .to = {tile.x, tile.y}});
                 moved = !unit.flying;
                 battleDelayThen(nullptr);
@@ -1865,7 +1887,7 @@ void Battle::aiMakeAction()
             }
 
             if (nextX != -1 && nextY != -1) {
-                uiSetStatus(fmt::format("{} Move", battleGetName()));
+                uiSetStatus(bty::frameFormat("{} Move", battleGetName()));
                 battleDoAction({.id = AidTryMove, .from = _curUnit, .to = {nextX, nextY}, .nextUnit = false});
                 battleDelayThen([this, unit]() {
                     if (unit.moves == 0) {
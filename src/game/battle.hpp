@@ -2,9 +2,11 @@
 #define BTY_GAME_BATTLE_HPP_
 
 #include <array>
+#include <string_view>
 
 #include "engine/component.hpp"
 #include "engine/dialog.hpp"
+#include "engine/task.hpp"
 #include "engine/textbox.hpp"
 #include "gfx/font.hpp"
 #include "gfx/sprite.hpp"
@@ -39,7 +41,6 @@ struct Action {
     ActionId id;
     glm::ivec2 from;
     glm::ivec2 to;
-    std::string fmtstr;
     bool nextUnit {true};
 };
 
@@ -48,6 +49,7 @@ public:
     Battle(bty::Engine &engine);
 
     void load() override;
+    std::vector<std::string> getAssets() const override;
     void enter() override;
     void render() override;
     bool handleEvent(Event event) override;
@@ -111,7 +113,7 @@ private:
     void uiConfirm();
     void uiConfirmSpell();
     void uiConfirmMenu(int opt);
-    void uiSetStatus(const std::string &msg, bool waitForEnter = false);
+    void uiSetStatus(std::string_view msg, bool waitForEnter = false);
     void uiSetCursorMode(Cursor cursor);
     void uiUpdateState();
     void uiUpdateCursor();
@@ -136,6 +138,8 @@ private:
     UnitState &battleGetUnit();
     const UnitState &battleGetUnit() const;
     void battleDelayThen(std::function<void()> callback);
+    bty::Task battleDelaySequence(std::function<void()> callback, int delayId);
+    bty::Task victorySequence(bty::Dialog &dialog, bool siege, int id);
     void battleOnMove();
     void battleDoAction(Action action);
     void battleUseSpell(int spell);
@@ -204,13 +208,13 @@ private:
     bool _choosingTeleportDest {false};
     int _teleportTargetUnit {-1};
     int _teleportTargetTeam {-1};
-    float _delayTimer {0};
     float _realDelayDuration {1.2f};
     bool _siege {false};
     std::array<int, 5> *_extEnemyArmy;
     std::array<int, 5> *_extEnemyCounts;
     std::array<int, 30> _terrain;
-    std::function<void()> _delayCallback {nullptr};
+    bty::Scheduler _scheduler;
+    int _delayId {0};
     bool _hitMarkerVisible {false};
     Cursor _cursorMode {Cursor::Move};
     bool _inDelay {false};
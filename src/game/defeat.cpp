@@ -43,6 +43,13 @@ void Defeat::load()
     _btName = _message.addString(1, 2);
 }
 
+std::vector<std::string> Defeat::getAssets() const
+{
+    return {
+        "bg/king-dead.png",
+    };
+}
+
 void Defeat::enter()
 {
     _pressedEnterOnce = false;
@@ -14,6 +14,7 @@ public:
     Defeat(bty::Engine &engine);
 
     void load() override;
+    std::vector<std::string> getAssets() const override;
     void enter() override;
     void render() override;
     bool handleEvent(Event event) override;
@@ -0,0 +1,151 @@
+#include "game/entity-grid.hpp"
+
+#include <algorithm>
+
+EntityGrid::EntityGrid()
+{
+    clear();
+    _results.reserve(64);
+}
+
+void EntityGrid::clear()
+{
+    for (auto &continent : _continents) {
+        continent.heads.fill(kNoNode);
+        continent.nodes.clear();
+    }
+}
+
+EntityGrid::Handle EntityGrid::add(int c, const GridEntity &entity)
+{
+    auto &continent = _continents[c];
+
+    const auto handle = static_cast<Handle>(continent.nodes.size());
+    continent.nodes.push_back({entity});
+    link(continent, handle);
+
+    return handle;
+}
+
+void EntityGrid::remove(int c, Handle handle)
+{
+    auto &continent = _continents[c];
+    if (continent.nodes[handle].cell != kNoNode) {
+        unlink(continent, handle);
+    }
+}
+
+void EntityGrid::restore(int c, Handle handle)
+{
+    auto &continent = _continents[c];
+    if (continent.nodes[handle].cell == kNoNode) {
+        link(continent, handle);
+    }
+}
+
+void EntityGrid::move(int c, Handle handle, glm::ivec2 tile)
+{
+    auto &continent = _continents[c];
+    auto &node = continent.nodes[handle];
+
+    node.entity.tile = tile;
+    if (node.cell == kNoNode || node.cell == cellOf(tile)) {
+        return;
+    }
+
+    unlink(continent, handle);
+    link(continent, handle);
+}
+
+const GridEntity &EntityGrid::get(int c, Handle handle) const
+{
+    return _continents[c].nodes[handle].entity;
+}
+
+std::span<const GridEntity> EntityGrid::inRange(int c, int x, int y, int range)
+{
+    return inRect(c, x - range, y - range, x + range, y + range);
+}
+
+std::span<const GridEntity> EntityGrid::inRect(int c, int minX, int minY, int maxX, int maxY)
+{
+    const auto &continent = _continents[c];
+
+    _results.clear();
+
+    const int minCellX = std::clamp(minX / kCellTiles, 0, kCells - 1);
+    const int minCellY = std::clamp(minY / kCellTiles, 0, kCells - 1);
+    const int maxCellX = std::clamp(maxX / kCellTiles, 0, kCells - 1);
+    const int maxCellY = std::clamp(maxY / kCellTiles, 0, kCells - 1);
+
+    for (int cy = minCellY; cy <= maxCellY; cy++) {
+        for (int cx = minCellX; cx <= maxCellX; cx++) {
+            for (int n = continent.heads[cx + cy * kCells]; n != kNoNode; n = continent.nodes[n].next) {
+                const auto &entity = continent.nodes[n].entity;
+                if (entity.tile.x >= minX && entity.tile.x <= maxX && entity.tile.y >= minY && entity.tile.y <= maxY) {
+                    _results.push_back(entity);
+                }
+            }
+        }
+    }
+
+    std::sort(_results.begin(), _results.end(), [](const GridEntity &a, const GridEntity &b) {
+        return a.index < b.index;
+    });
+
+    return _results;
+}
+
+std::span<const GridEntity> EntityGrid::atTile(int c, int x, int y)
+{
+    return inRect(c, x, y, x, y);
+}
+
+const GridEntity *EntityGrid::find(int c, int x, int y, GridEntityKind kind)
+{
+    for (const auto &entity : atTile(c, x, y)) {
+        if (entity.kind == kind) {
+            return &entity;
+        }
+    }
+    return nullptr;
+}
+
+int EntityGrid::cellOf(glm::ivec2 tile)
+{
+    const int cx = std::clamp(tile.x / kCellTiles, 0, kCells - 1);
+    const int cy = std::clamp(tile.y / kCellTiles, 0, kCells - 1);
+    return cx + cy * kCells;
+}
+
+void EntityGrid::link(Continent &continent, Handle handle)
+{
+    auto &node = continent.nodes[handle];
+    node.cell = cellOf(node.entity.tile);
+    node.prev = kNoNode;
+    node.next = continent.heads[node.cell];
+
+    if (node.next != kNoNode) {
+        continent.nodes[node.next].prev = handle;
+    }
+    continent.heads[node.cell] = handle;
+}
+
+void EntityGrid::unlink(Continent &continent, Handle handle)
+{
+    auto &node = continent.nodes[handle];
+
+    if (node.prev != kNoNode) {
+        continent.nodes[node.prev].next = node.next;
+    }
+    else {
+        continent.heads[node.cell] = node.next;
+    }
+    if (node.next != kNoNode) {
+        continent.nodes[node.next].prev = node.prev;
+    }
+
+    node.cell = kNoNode;
+    node.prev = kNoNode;
+    node.next = kNoNode;
+}
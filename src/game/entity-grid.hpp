@@ -0,0 +1,81 @@
+#ifndef BTY_GAME_ENTITY_GRID_HPP_
+#define BTY_GAME_ENTITY_GRID_HPP_
+
+#include <array>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <span>
+#include <vector>
+
+enum GridEntityKind : uint8_t {
+    GRID_MOB,
+    GRID_FRIENDLY_MOB,
+};
+
+struct GridEntity {
+    GridEntityKind kind;
+    /* Slot in State::mobs. */
+    int index;
+    glm::ivec2 tile;
+};
+
+/* Uniform grid over each continent's overworld entities, so finding what's
+    near a tile only looks at the cells around it, not at everything on the
+    continent. Each cell is an intrusive list, so moving an entity between
+    cells is a couple of pointer swaps.
+
+    Query results are sorted by index, i.e. the order the old scans over
+    State visited them in, and stay valid until the next query. */
+class EntityGrid {
+public:
+    using Handle = int;
+
+    static constexpr int kMapTiles = 64;
+    static constexpr int kCellTiles = 4;
+    static constexpr int kCells = kMapTiles / kCellTiles;
+
+    EntityGrid();
+
+    void clear();
+    /* Handles are given out in order, starting from 0 on each continent,
+        and stay with their entity until clear(). */
+    Handle add(int continent, const GridEntity &entity);
+    /* Takes the entity out of the grid; restore() puts it back. */
+    void remove(int continent, Handle handle);
+    void restore(int continent, Handle handle);
+    void move(int continent, Handle handle, glm::ivec2 tile);
+    const GridEntity &get(int continent, Handle handle) const;
+
+    /* Everything within range tiles of x, y on both axes. */
+    std::span<const GridEntity> inRange(int continent, int x, int y, int range);
+    /* Inclusive. */
+    std::span<const GridEntity> inRect(int continent, int minX, int minY, int maxX, int maxY);
+    std::span<const GridEntity> atTile(int continent, int x, int y);
+    /* The first entity of that kind on the tile, or null. */
+    const GridEntity *find(int continent, int x, int y, GridEntityKind kind);
+
+private:
+    static constexpr int kNoNode = -1;
+
+    struct Node {
+        GridEntity entity;
+        int cell {kNoNode};
+        int prev {kNoNode};
+        int next {kNoNode};
+    };
+
+    struct Continent {
+        std::array<int, kCells * kCells> heads;
+        std::vector<Node> nodes;
+    };
+
+    static int cellOf(glm::ivec2 tile);
+    void link(Continent &continent, Handle handle);
+    void unlink(Continent &continent, Handle handle);
+
+private:
+    std::array<Continent, 4> _continents;
+    std::vector<GridEntity> _results;
+};
+
+#endif    // BTY_GAME_ENTITY_GRID_HPP_
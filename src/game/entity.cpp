@@ -22,6 +22,11 @@ glm::vec2 Entity::getCenter() const
     return {_position.x + 24, _position.y + 16};
 }
 
+glm::vec2 Entity::getRenderCenter() const
+{
+    return getCenter() + getRenderPosition() - getPosition();
+}
+
 bool Entity::canMove(int id, int, int, int)
 {
     return id == Tile_Grass;
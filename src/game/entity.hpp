@@ -27,6 +27,7 @@ public:
     void moveToTile(const Tile &tile);
     const Tile &getTile() const;
     glm::vec2 getCenter() const;
+    glm::vec2 getRenderCenter() const;
     void setDebug(bool val);
     bool getDebug() const;
     void draw();
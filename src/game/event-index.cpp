@@ -0,0 +1,109 @@
+#include "game/event-index.hpp"
+
+#include <iterator>
+#include <string>
+
+#include "data/castles.hpp"
+#include "data/tiles.hpp"
+#include "data/towns.hpp"
+#include "game/state.hpp"
+
+static constexpr int kSignsPerContinent = 22;
+
+static constexpr int kArtifactTiles[] = {
+    Tile_AfctScroll,
+    Tile_AfctShield,
+    Tile_AfctCrown,
+    Tile_AfctAmulet,
+    Tile_AfctRing,
+    Tile_AfctAnchor,
+    Tile_AfctBook,
+    Tile_AfctSword,
+};
+
+static bool isShopTile(int id)
+{
+    return id == Tile_ShopCave || id == Tile_ShopTree || id == Tile_ShopDungeon || id == Tile_ShopWagon;
+}
+
+void EventIndex::build(int c, const unsigned char *tiles)
+{
+    _events[c].fill({});
+
+    /* Signs are numbered in the order the original scanned for them: top
+        row first, left to right. */
+    int sign = c * kSignsPerContinent;
+    for (int y = kSize - 1; y >= 0; y--) {
+        for (int x = 0; x < kSize; x++) {
+            const int id = tiles[x + y * kSize];
+            if (id == Tile_GenSign) {
+                set(c, x, y, EVENT_SIGN, sign++);
+            }
+            else if (id == Tile_Chest) {
+                set(c, x, y, EVENT_CHEST, CHEST_RANDOM);
+            }
+            else {
+                for (int i = 0; i < static_cast<int>(std::size(kArtifactTiles)); i++) {
+                    if (id == kArtifactTiles[i]) {
+                        set(c, x, y, EVENT_ARTIFACT, i);
+                    }
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(std::size(kTownInfo)); i++) {
+        if (kTownInfo[i].continent == c) {
+            set(c, kTownInfo[i].x, kSize - 1 - kTownInfo[i].y, EVENT_TOWN, i);
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(std::size(kCastleInfo)); i++) {
+        if (kCastleInfo[i].continent == c) {
+            set(c, kCastleInfo[i].x, kSize - 1 - kCastleInfo[i].y, EVENT_CASTLE, i);
+        }
+    }
+
+    /* The map chests still there; the sail map wins if they ever share. */
+    const auto &mapTile = State::continent_map_tiles[c];
+    if (get(c, mapTile.x, mapTile.y).kind == EVENT_CHEST) {
+        set(c, mapTile.x, mapTile.y, EVENT_CHEST, CHEST_CONTINENT_MAP);
+    }
+    if (c < static_cast<int>(State::sail_map_tiles.size())) {
+        const auto &sailTile = State::sail_map_tiles[c];
+        if (get(c, sailTile.x, sailTile.y).kind == EVENT_CHEST) {
+            set(c, sailTile.x, sailTile.y, EVENT_CHEST, CHEST_SAIL_MAP);
+        }
+    }
+
+    /* Teleport caves are shop caves too, and come first. */
+    for (int i = 0; i < 2; i++) {
+        const auto &cave = State::teleport_cave_tiles[c][i];
+        set(c, cave.x, cave.y, EVENT_TELEPORT_CAVE, i);
+    }
+
+    /* Unused shop slots sit at 0, 0, so only take shops on a shop tile, and
+        the first shop on a tile. */
+    for (int i = 0; i < static_cast<int>(State::shops[c].size()); i++) {
+        const auto &shop = State::shops[c][i];
+        if (shop.x < 0 || shop.x >= kSize || shop.y < 0 || shop.y >= kSize) {
+            continue;
+        }
+        if (isShopTile(tiles[shop.x + shop.y * kSize]) && get(c, shop.x, shop.y).kind == EVENT_NONE) {
+            set(c, shop.x, shop.y, EVENT_SHOP, i);
+        }
+    }
+}
+
+void EventIndex::clear(int c, int x, int y)
+{
+    set(c, x, y, EVENT_NONE, 0);
+}
+
+void EventIndex::set(int c, int x, int y, MapEventKind kind, int id)
+{
+    if (x < 0 || x >= kSize || y < 0 || y >= kSize) {
+        return;
+    }
+    _events[c][x + y * kSize] = {kind, static_cast<uint16_t>(id)};
+}
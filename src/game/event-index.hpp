@@ -0,0 +1,59 @@
+#ifndef BTY_GAME_EVENT_INDEX_HPP_
+#define BTY_GAME_EVENT_INDEX_HPP_
+
+#include <array>
+#include <cstdint>
+
+enum MapEventKind : uint8_t {
+    EVENT_NONE,
+    EVENT_SIGN,
+    EVENT_TOWN,
+    EVENT_CASTLE,
+    EVENT_SHOP,
+    EVENT_TELEPORT_CAVE,
+    EVENT_ARTIFACT,
+    EVENT_CHEST,
+};
+
+enum ChestKind : uint8_t {
+    CHEST_RANDOM,
+    CHEST_SAIL_MAP,
+    CHEST_CONTINENT_MAP,
+};
+
+struct MapEvent {
+    MapEventKind kind {EVENT_NONE};
+    /* Index into kSigns (continent included), kTownInfo, kCastleInfo,
+        State::shops or State::teleport_cave_tiles, the artifact number, or
+        a ChestKind, depending on kind. */
+    uint16_t id {0};
+};
+
+/* What every event tile on each continent leads to, looked up by
+    coordinate instead of by scanning the map or the tables in data/. Built
+    from the tiles and State once the world exists, and kept in step when
+    an event is used up. */
+class EventIndex {
+public:
+    static constexpr int kSize = 64;
+
+    void build(int continent, const unsigned char *tiles);
+    void clear(int continent, int x, int y);
+
+    const MapEvent &get(int continent, int x, int y) const
+    {
+        static constexpr MapEvent kNoEvent {};
+        if (x < 0 || x >= kSize || y < 0 || y >= kSize) {
+            return kNoEvent;
+        }
+        return _events[continent][x + y * kSize];
+    }
+
+private:
+    void set(int continent, int x, int y, MapEventKind kind, int id);
+
+private:
+    std::array<std::array<MapEvent, kSize * kSize>, 4> _events {};
+};
+
+#endif    // BTY_GAME_EVENT_INDEX_HPP_
@@ -0,0 +1,72 @@
+#include "game/flow-field.hpp"
+
+static constexpr glm::ivec2 kSteps[4] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+static bool inMap(glm::ivec2 tile)
+{
+    return tile.x >= 0 && tile.x < FlowField::kSize && tile.y >= 0 && tile.y < FlowField::kSize;
+}
+
+void FlowField::update(const Passability &passability, PassLayer layer, int continent, glm::ivec2 target)
+{
+    if (&passability == _passability && passability.getRevision() == _revision && layer == _layer && continent == _continent && target == _target) {
+        return;
+    }
+
+    _passability = &passability;
+    _revision = passability.getRevision();
+    _layer = layer;
+    _continent = continent;
+    _target = target;
+
+    _distances.fill(kUnreachable);
+    _next.fill(kNoStep);
+
+    if (!inMap(target)) {
+        return;
+    }
+
+    int head = 0;
+    int tail = 0;
+    _distances[target.x + target.y * kSize] = 0;
+    _queue[tail++] = static_cast<uint16_t>(target.x + target.y * kSize);
+
+    while (head != tail) {
+        const int current = _queue[head++];
+        const glm::ivec2 tile {current % kSize, current / kSize};
+
+        for (int i = 0; i < 4; i++) {
+            const auto from = tile - kSteps[i];
+            if (!inMap(from) || !passability.test(layer, from.x, from.y)) {
+                continue;
+            }
+
+            const int index = from.x + from.y * kSize;
+            if (_distances[index] != kUnreachable) {
+                continue;
+            }
+            /* from reaches tile by taking step i. */
+            _distances[index] = _distances[current] + 1;
+            _next[index] = static_cast<uint8_t>(i);
+            _queue[tail++] = static_cast<uint16_t>(index);
+        }
+    }
+}
+
+uint16_t FlowField::getDistance(glm::ivec2 tile) const
+{
+    if (!inMap(tile)) {
+        return kUnreachable;
+    }
+    return _distances[tile.x + tile.y * kSize];
+}
+
+glm::ivec2 FlowField::getNext(glm::ivec2 tile) const
+{
+    if (!inMap(tile)) {
+        return tile;
+    }
+
+    const auto step = _next[tile.x + tile.y * kSize];
+    return step == kNoStep ? tile : tile + kSteps[step];
+}
@@ -0,0 +1,47 @@
+#ifndef BTY_GAME_FLOW_FIELD_HPP_
+#define BTY_GAME_FLOW_FIELD_HPP_
+
+#include <array>
+#include <cstdint>
+#include <glm/vec2.hpp>
+
+#include "game/passability.hpp"
+
+/* Breadth-first distances over one layer of a continent to a single
+    target tile, with each tile knowing which neighbour is a step closer.
+    Everything chasing the same target steers by reading its own tile,
+    whatever the number of chasers.
+
+    The target itself doesn't have to be passable; the hero can stand on a
+    bridge or in a doorway that mobs can't. */
+class FlowField {
+public:
+    static constexpr int kSize = 64;
+    static constexpr uint16_t kUnreachable = 0xFFFF;
+
+    /* Recomputes only if the target, continent or passability changed
+        since last time. */
+    void update(const Passability &passability, PassLayer layer, int continent, glm::ivec2 target);
+
+    /* Steps to the target, or kUnreachable. */
+    uint16_t getDistance(glm::ivec2 tile) const;
+    /* The neighbour one step closer to the target, or tile itself if it's
+        the target or can't reach it. */
+    glm::ivec2 getNext(glm::ivec2 tile) const;
+
+private:
+    static constexpr uint8_t kNoStep = 0xFF;
+
+    std::array<uint16_t, kSize * kSize> _distances;
+    /* Index into the step table in flow-field.cpp, or kNoStep. */
+    std::array<uint8_t, kSize * kSize> _next;
+    std::array<uint16_t, kSize * kSize> _queue;
+
+    const Passability *_passability {nullptr};
+    uint32_t _revision {0};
+    PassLayer _layer {PASS_MOB};
+    int _continent {-1};
+    glm::ivec2 _target {-1, -1};
+};
+
+#endif    // BTY_GAME_FLOW_FIELD_HPP_
@@ -0,0 +1,20 @@
+#include "game/fog.hpp"
+
+#include <algorithm>
+
+void Fog::reveal(int minX, int minY, int maxX, int maxY)
+{
+    minX = std::max(minX, 0);
+    minY = std::max(minY, 0);
+    maxX = std::min(maxX, kSize - 1);
+    maxY = std::min(maxY, kSize - 1);
+
+    if (minX > maxX || minY > maxY) {
+        return;
+    }
+
+    const auto mask = (~uint64_t {0} >> (kSize - 1 - (maxX - minX))) << minX;
+    for (int y = minY; y <= maxY; y++) {
+        _rows[y] |= mask;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef BTY_GAME_FOG_HPP_
+#define BTY_GAME_FOG_HPP_
+
+#include <array>
+#include <cstdint>
+
+/* Which tiles of a 64x64 continent the hero has seen, a row to a uint64_t
+    with bit x for tile x. What a seen tile looks like comes from the live
+    tile map, so 512 bytes covers a continent. */
+class Fog {
+public:
+    static constexpr int kSize = 64;
+
+    void clear()
+    {
+        _rows.fill(0);
+    }
+
+    /* Reveals the inclusive rect, clipped to the continent. */
+    void reveal(int minX, int minY, int maxX, int maxY);
+
+    bool isSeen(int x, int y) const
+    {
+        if (x < 0 || x >= kSize || y < 0 || y >= kSize) {
+            return false;
+        }
+        return (_rows[y] >> x) & 1;
+    }
+
+    uint64_t row(int y) const
+    {
+        return _rows[y];
+    }
+
+    /* Raw rows, for saving and loading. */
+    std::array<uint64_t, kSize> &getRows()
+    {
+        return _rows;
+    }
+
+private:
+    std::array<uint64_t, kSize> _rows {};
+};
+
+#endif    // BTY_GAME_FOG_HPP_
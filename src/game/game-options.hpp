@@ -6,6 +6,16 @@ struct GameOptions {
     bool music {true};
     bool sound {true};
     int combat_delay {5};
+    int capture_frames {1};
+    /* Frames recorded by an F5 profiler trace. */
+    int trace_frames {120};
+    /* Frames slower than this get written to flight/; 0 turns it off. */
+    float slow_frame_ms {50.0f};
+    bool render_thread {true};
+    /* Handle input again just before recording the snapshot. */
+    bool late_latch_input {false};
+    /* Skip battle delays and scene fades, e.g. for headless AI battles. */
+    bool instant_waits {false};
 };
 
 #endif    // GAME_GAME_OPTIONS_HPP_
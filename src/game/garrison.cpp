@@ -105,6 +105,13 @@ void Garrison::load()
     }
 }
 
+std::vector<std::string> Garrison::getAssets() const
+{
+    return {
+        "bg/castle.png",
+    };
+}
+
 void Garrison::render()
 {
     GFX::instance().drawSprite(_spBg);
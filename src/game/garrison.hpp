@@ -16,6 +16,7 @@ public:
     Garrison(bty::Engine &engine);
 
     void load() override;
+    std::vector<std::string> getAssets() const override;
     void enter() override;
     void render() override;
     void renderLate() override;
@@ -2,7 +2,6 @@
 
 #include <spdlog/spdlog.h>
 
-#include "data/tiles.hpp"
 #include "engine/texture-cache.hpp"
 #include "game/map.hpp"
 
@@ -51,19 +50,21 @@ void Hero::setMoving(bool val)
     updateTexture();
 }
 
-bool Hero::canMove(int id, int x, int y, int c)
+bool Hero::canMove(int id, int, int, int)
+{
+    return passMask(id) & (1 << getPassLayer());
+}
+
+PassLayer Hero::getPassLayer() const
 {
     switch (_mount) {
         case Mount::Fly:
-            return true;
+            return PASS_FLY;
         case Mount::Boat:
-            return id == Tile_BridgeHorizontal || id == Tile_BridgeVertical || id == Tile_WaterConnector || (id >= Tile_WaterIRT && id <= Tile_Water);
-        case Mount::Walk:
-            return id <= Tile_GrassInFrontOfCastle || id == Tile_MobBlocker || id == Tile_BridgeHorizontal || id == Tile_BridgeVertical || (id >= Tile_SandELT && id <= Tile_Sand);
+            return PASS_BOAT;
         default:
-            break;
+            return PASS_WALK;
     }
-    return false;
 }
 
 float Hero::getSpeedMul() const
@@ -2,6 +2,7 @@
 #define BTY_GAME_HERO_HPP_
 
 #include "game/entity.hpp"
+#include "game/passability.hpp"
 
 namespace bty {
 struct Texture;
@@ -19,6 +20,7 @@ public:
     bool canMove(int id, int x, int y, int c) override;
     void setMount(Mount mount);
     Mount getMount() const;
+    PassLayer getPassLayer() const;
     void setMoving(bool val);
 
     float getSpeedMul() const;
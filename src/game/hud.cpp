@@ -152,7 +152,7 @@ void Hud::setPuzzle(bool *villains, bool *artifacts)
     }
 }
 
-void Hud::setTitle(const std::string &str)
+void Hud::setTitle(std::string_view str)
 {
     _btName.setString(str);
     _btDays.setString("");
@@ -177,7 +177,7 @@ void Hud::update(float dt)
     _spMagic.update(dt);
 }
 
-void Hud::setError(const std::string &msg, std::function<void()> then)
+void Hud::setError(std::string_view msg, std::function<void()> then)
 {
     _errorCallback = then;
     _btError.setString(msg);
@@ -3,6 +3,7 @@
 
 #include <functional>
 #include <glm/mat4x4.hpp>
+#include <string_view>
 #include <vector>
 
 #include "data/color.hpp"
@@ -25,8 +26,8 @@ public:
     void setTimestop(int amount);
     void clearTimestop();
 
-    void setError(const std::string &msg, std::function<void()> then = nullptr);
-    void setTitle(const std::string &msg); /* Similar to setError except it doesn't take input. */
+    void setError(std::string_view msg, std::function<void()> then = nullptr);
+    void setTitle(std::string_view msg); /* Similar to setError except it doesn't take input. */
     void clearError();
     bool getError() const;
 
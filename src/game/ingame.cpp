@@ -2,6 +2,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
 #include <glm/gtc/matrix_transform.hpp>
@@ -17,25 +19,40 @@
 #include "data/tiles.hpp"
 #include "data/towns.hpp"
 #include "data/villains.hpp"
+#include "engine/alloc-tracker.hpp"
 #include "engine/engine.hpp"
+#include "engine/profiler.hpp"
 #include "engine/scene-manager.hpp"
+#include "engine/telemetry.hpp"
 #include "engine/texture-cache.hpp"
+#include "engine/timer-wheel.hpp"
 #include "game/army-gen.hpp"
 #include "game/chest.hpp"
 #include "game/game-options.hpp"
 #include "game/state.hpp"
+#include "game/state-mirror.hpp"
 
 #define CUTE_C2_IMPLEMENTATION
 #include "game/cute_c2.hpp"
 #include "game/hud.hpp"
 #include "game/shop-gen.hpp"
+#include "game/telemetry-events.hpp"
+#include "game/timer-groups.hpp"
 #include "gfx/gfx.hpp"
 
+/* Steps of walking before it counts as steady, enough for anything that
+    grows on the first steps to have settled. */
+static constexpr int kAllocWarmupSteps = 30;
+/* How far off a tile's centre still counts as on it when travelling. */
+static constexpr float kTravelSlack = 4.0f;
+/* Travel gives up after this long without reaching a new tile. */
+static constexpr float kTravelGiveUpSeconds = 2.0f;
+
 Ingame::Ingame(bty::Engine &engine)
     : _engine(engine)
-    , _dayTimer(16.0f, std::bind(&Ingame::dayTick, this))
-    , _timestopTimer(0.25f, std::bind(&Ingame::timestopTick, this))
-    , _automoveTimer(0.0f, std::bind(&Ingame::automoveTick, this))
+    , _dayTimer(16.0f, std::bind(&Ingame::dayTick, this), TIMER_GROUP_OVERWORLD | TIMER_GROUP_CALENDAR)
+    , _timestopTimer(0.25f, std::bind(&Ingame::timestopTick, this), TIMER_GROUP_OVERWORLD)
+    , _automoveTimer(0.0f, std::bind(&Ingame::automoveTick, this), TIMER_GROUP_OVERWORLD)
     , _dbgCollisionRect({0.2f, 0.4f, 0.7f, 0.9f}, {8, 8}, {0, 0})
     , _chestGold(engine)
     , _chestCommission(engine)
@@ -43,6 +60,8 @@ Ingame::Ingame(bty::Engine &engine)
     , _chestSpellCapacity(engine)
     , _chestSpell(engine)
 {
+    /* Constructed before the first visit, so hold the clocks until then. */
+    Timers::instance().setGroupPaused(TIMER_GROUP_OVERWORLD, true);
 }
 
 void Ingame::setup()
@@ -80,9 +99,7 @@ void Ingame::setup()
     }
 
     for (int i = 0; i < 4; i++) {
-        State::visited_tiles[i].clear();
-        State::visited_tiles[i].resize(4096);
-        std::fill(State::visited_tiles[i].begin(), State::visited_tiles[i].end(), 0xFF);
+        State::fog[i].clear();
         State::sail_maps_found[i] = false;
         State::continent_maps_found[i] = false;
         State::tiles[i] = _map.getTiles(i);
@@ -178,13 +195,22 @@ void Ingame::setup()
 
 void Ingame::render()
 {
+    bty::AllocTracker::watch();
+
+    /* Follow the interpolated hero, unless the puzzle has the camera. */
+    if (_tempPuzzleContinent == -1) {
+        updateCamera();
+    }
+
     GFX::instance().setView(_mapView);
-    _map.draw(_mapView);
+    _map.draw(_mapView, _zoom);
     drawMobs();
     if (State::boat_rented && _spHero.getMount() != Mount::Boat) {
         GFX::instance().drawSprite(_spBoat);
     }
     _spHero.draw();
+
+    bty::AllocTracker::endWatch(_steadySteps > kAllocWarmupSteps);
 }
 
 void Ingame::renderLate()
@@ -200,7 +226,7 @@ void Ingame::enter()
     State::combat = false;
     auto color {bty::getBoxColor(State::difficulty)};
     _paused = false;
-    _moveFlags = DIR_FLAG_NONE;
+    stopTravel();
     auto &hud {_engine.getGUI().getHUD()};
     hud.setHudFrame();
     hud.setHero(State::hero, State::rank);
@@ -225,18 +251,33 @@ void Ingame::enter()
         updateCamera();
     }
     _engine.getGUI().showHUD();
+
+    Timers::instance().setGroupPaused(TIMER_GROUP_OVERWORLD, false);
+}
+
+void Ingame::unload()
+{
+    Timers::instance().setGroupPaused(TIMER_GROUP_OVERWORLD, true);
 }
 
 void Ingame::load()
 {
+    BTY_PROFILE_ZONE("Ingame::load");
+
     if (_loaded) {
         return;
     }
 
     auto &textures {Textures::instance()};
 
+    std::vector<std::string> unitPaths;
+    for (int i = 0; i < UnitId::UnitCount; i++) {
+        unitPaths.push_back(fmt::format("units/{}.png", i));
+    }
+    textures.preload(unitPaths);
+
     for (int i = 0; i < UnitId::UnitCount; i++) {
-        _texUnits[i] = textures.get(fmt::format("units/{}.png", i), {2, 2});
+        _texUnits[i] = textures.get(unitPaths[i], {2, 2});
     }
 
     _map.load();
@@ -385,6 +426,33 @@ void Ingame::load()
     _loaded = true;
 }
 
+bool Ingame::isPersistent() const
+{
+    return true;
+}
+
+std::vector<std::string> Ingame::getAssets() const
+{
+    std::vector<std::string> assets {
+        "hero/walk-moving.png",
+        "hero/walk-stationary.png",
+        "hero/boat-moving.png",
+        "hero/boat-stationary.png",
+        "hero/flying.png",
+    };
+    for (int i = 0; i < UnitId::UnitCount; i++) {
+        assets.push_back(fmt::format("units/{}.png", i));
+    }
+    for (int i = 0; i < 10; i++) {
+        assets.push_back(fmt::format("tilesets/tileset{}.png", i));
+    }
+    /* Shared with the HUD's contract portraits. */
+    for (int i = 0; i < 17; i++) {
+        assets.push_back(fmt::format("villains/{}.png", i));
+    }
+    return assets;
+}
+
 void Ingame::handlePauseOptions(int opt)
 {
     _engine.getGUI().popDialog();
@@ -453,6 +521,10 @@ bool Ingame::handleEvent(Event event)
 
 bool Ingame::handleKeyDown(Key key)
 {
+    if (!_travelPath.empty() && (key == Key::Up || key == Key::Down || key == Key::Left || key == Key::Right)) {
+        stopTravel();
+    }
+
     switch (key) {
         case Key::Up:
             _moveFlags |= DIR_FLAG_UP;
@@ -488,12 +560,21 @@ bool Ingame::handleKeyDown(Key key)
         case Key::F:
             flyLand();
             break;
+        case Key::T:
+            openTravel();
+            break;
         case Key::J:
             sailTo(0);
             break;
         case Key::L:
             sailTo(3);
             break;
+        case Key::Minus:
+            zoom(1);
+            break;
+        case Key::Equal:
+            zoom(-1);
+            break;
         default:
             return false;
     }
@@ -523,9 +604,13 @@ bool Ingame::handleKeyUp(Key key)
 
 void Ingame::update(float dt)
 {
+    bty::AllocTracker::watch();
+
     if (State::auto_move) {
         automove(dt);
-        _automoveTimer.tick(dt);
+    }
+    else if (!_travelPath.empty()) {
+        travel(dt);
     }
 	else {
 		if (_moveFlags == DIR_FLAG_NONE) {
@@ -536,11 +621,15 @@ void Ingame::update(float dt)
 		}
     }
 
-    if (State::timestop) {
-        _timestopTimer.tick(dt);
-    }
-    else if (!_paused && !_engine.getGUI().hasDialog() && !_engine.getGUI().getHUD().getError()) {
-        _dayTimer.tick(dt);
+    /* Decides which timers run this step; the wheel fires them once the
+        scene has updated. */
+    _automoveTimer.setPaused(!State::auto_move);
+    _timestopTimer.setPaused(!State::timestop);
+
+    const bool worldStopped = State::timestop || _paused || _engine.getGUI().hasDialog() || _engine.getGUI().getHUD().getError();
+    Timers::instance().setGroupPaused(TIMER_GROUP_CALENDAR, worldStopped);
+
+    if (!worldStopped) {
         updateMobs(dt);
     }
 
@@ -549,10 +638,20 @@ void Ingame::update(float dt)
     }
 
     updateAnimations(dt);
+
+    /* Walking is the steady state, so once it has gone on for a moment it
+        should not allocate at all. Steps that open a dialog or start a fade
+        don't count, and neither does the debug overlay. */
+    const bool walking = !State::auto_move && _moveFlags != DIR_FLAG_NONE && !_paused && !_engine.getGUI().hasDialog() && !_engine.getGameOptions().debug && !SceneMan::instance().transitioning();
+    _steadySteps = walking ? _steadySteps + 1 : 0;
+
+    bty::AllocTracker::endWatch(_steadySteps > kAllocWarmupSteps);
 }
 
 void Ingame::genTiles()
 {
+    BTY_PROFILE_ZONE("Ingame::genTiles");
+
     for (int i = 0; i < 26; i++) {
         State::castle_occupants[i] = 0x7F;
         for (int j = 0; j < 5; j++) {
@@ -891,42 +990,59 @@ void Ingame::genTiles()
     _engine.getGUI().getHUD().setPuzzle(State::villains_captured.data(), State::artifacts_found.data());
 
     _map.createGeometry();
+    rebuildEntityGrid();
+    rebuildEventIndex();
+    SharedState::instance().resetTick();
 }
 
-void Ingame::updateCamera()
+/* The last level is replaced by whatever fits the whole continent on screen. */
+static constexpr float kZoomLevels[] = {1.0f, 0.5f, 0.25f, 0.125f, 0.0f};
+static constexpr int kNumZoomLevels = sizeof(kZoomLevels) / sizeof(kZoomLevels[0]);
+
+void Ingame::zoom(int delta)
 {
-    glm::vec2 camCenter = _spHero.getCenter();
-    glm::vec3 camPos = {camCenter.x - 130, camCenter.y - 120, 0.0f};
-    _mapView = _uiView * glm::translate(-camPos);
+    _zoomLevel = std::clamp(_zoomLevel + delta, 0, kNumZoomLevels - 1);
+    updateCamera();
 }
 
-void Ingame::updateVisitedTiles()
+void Ingame::updateCamera()
 {
-    const glm::ivec2 tile {State::x, State::y};
-    auto *visited = State::visited_tiles[State::continent].data();
-    auto *tiles = _map.getTiles(State::continent);
+    glm::vec2 camCenter = _spHero.getRenderCenter();
+    glm::vec2 screenCenter = {130.0f, 120.0f};
 
-    int range = 4;
-    int offset = range / 2;
+    if (_zoomLevel == kNumZoomLevels - 1) {
+        _zoom = std::min(320.0f / (64 * 48.0f), 224.0f / (64 * 40.0f));
+        camCenter = {32 * 48.0f, 32 * 40.0f};
+        screenCenter = {160.0f, 112.0f};
+    }
+    else {
+        _zoom = kZoomLevels[_zoomLevel];
+    }
 
-    for (int i = 0; i <= range; i++) {
-        for (int j = 0; j <= range; j++) {
-            int x = tile.x - offset + i;
-            int y = tile.y - offset + j;
+    _mapView = _uiView * glm::translate(glm::vec3 {screenCenter, 0.0f}) * glm::scale(glm::vec3 {_zoom, _zoom, 1.0f}) * glm::translate(-glm::vec3 {camCenter, 0.0f});
 
-            if (x < 0 || x > 63 || y < 0 || y > 63) {
-                continue;
-            }
+    /* Tile range covered by the view, plus one tile so sprites straddling
+        the edge don't pop. */
+    const glm::vec2 topLeft = camCenter - screenCenter / _zoom;
+    const glm::vec2 bottomRight = camCenter + (glm::vec2 {320.0f, 224.0f} - screenCenter) / _zoom;
 
-            int index = x + y * 64;
-            visited[index] = tiles[index];
-        }
-    }
+    _visibleTiles = {
+        std::max(0, static_cast<int>(topLeft.x / 48.0f) - 1),
+        std::max(0, static_cast<int>(topLeft.y / 40.0f) - 1),
+        std::min(63, static_cast<int>(bottomRight.x / 48.0f) + 1),
+        std::min(63, static_cast<int>(bottomRight.y / 40.0f) + 1),
+    };
+}
+
+void Ingame::updateVisitedTiles()
+{
+    State::fog[State::continent].reveal(State::x - 2, State::y - 2, State::x + 2, State::y + 2);
 }
 
 void Ingame::moveHeroTo(int x, int y, int c)
 {
     this->_spHero.moveToTile(_map.getTile(x, y, c));
+    this->_spHero.snap();
     updateCamera();
 
     State::x = x;
@@ -1292,6 +1408,8 @@ void Ingame::endWeekBudget(bool search)
 
     State::gold = balance;
 
+    Telemetry::instance().emit(TelemetryWeekBudget {State::weeks_passed, commission, boat, armyTotalCost, balance, outOfGold, {}});
+
     auto dialog = _engine.getGUI().makeDialog(1, 18, 30, 9);
     dialog->addString(1, 1, fmt::format(kBudgetMessage, State::weeks_passed, bty::numberK(State::gold), commission, boat, armyTotalCost, bty::numberK(balance)));
     dialog->addString(15, 3, armyInfo);
@@ -1334,12 +1452,14 @@ void Ingame::disgrace()
 
 void Ingame::defeat()
 {
+    Telemetry::instance().emit(TelemetryGameOver {State::days, State::gold, State::followers_killed, State::score, false, {}});
     _engine.getGUI().getHUD().setDays(0);
     SceneMan::instance().setScene("defeat");
 }
 
 void Ingame::victory()
 {
+    Telemetry::instance().emit(TelemetryGameOver {State::days, State::gold, State::followers_killed, State::score, true, {}});
     _engine.getGUI().getHUD().setBlankFrame();
     SceneMan::instance().setScene("victory");
 }
@@ -1381,57 +1501,40 @@ void Ingame::dismissSlot(int slot)
     bty::sortArmy(State::army, State::counts);
 }
 
-bool Ingame::heroCanMove(int id)
-{
-    return _spHero.canMove(id, 0, 0, 0);
-}
-
-bool Ingame::mobCanMove(int id)
-{
-    return id == Tile_Grass;
-}
-
-bool Ingame::moveIncrement(c2AABB &box, float dx, float dy, Tile &centerTile, Tile &collidedTile, bool (Ingame::*canMove)(int), bool mob)
+bool Ingame::moveIncrement(c2AABB &box, float dx, float dy, Tile &centerTile, Tile &collidedTile, PassLayer layer, bool mob)
 {
-    box.min.x += dx;
-    box.max.x += dx;
-    box.min.y += dy;
-    box.max.y += dy;
-
-    /* Test. */
-    centerTile = _map.getTile(box.min.x + 4, box.min.y + 4, State::continent);
+    /* What counts for collision is the point in the middle of the box. */
+    const c2v middle {box.min.x + kEntitySizeX / 2, box.min.y + kEntitySizeY / 2};
 
+    Tile ignore {-1, -1, -1};
+    bool passThrough = false;
     if (!mob) {
-        /* Tile center is the same as the last event tile we collided with.
-		If we're not overlapping any other tiles, don't collide. */
-        if (centerTile.tx == _dbgLastEventTile.tx && centerTile.ty == _dbgLastEventTile.ty) {
-            return false;
-        }
+        /* Don't collide with the last event tile again while still on it. */
+        ignore = _dbgLastEventTile;
         /* Don't endlessly loop between the two teleport caves just because
 		they are technically different tiles. */
-        else if (_dbgLastEventTile.id == Tile_ShopCave) {
-            for (int i = 0; i < 2; i++) {
-                if (_dbgLastEventTile.tx == State::teleport_cave_tiles[State::continent][i].x && _dbgLastEventTile.ty == State::teleport_cave_tiles[State::continent][i].y) {
-                    return false;
-                }
-            }
-        }
+        passThrough = _dbgLastEventTile.id == Tile_ShopCave && _eventIndex.get(State::continent, _dbgLastEventTile.tx, _dbgLastEventTile.ty).kind == EVENT_TELEPORT_CAVE;
     }
 
-    /* Collided; undo move and register it. */
-    if (!(this->*canMove)(centerTile.id)) {
-        box.min.x -= dx;
-        box.max.x -= dx;
-        box.min.y -= dy;
-        box.max.y -= dy;
-        collidedTile = centerTile;
-        centerTile = _map.getTile(box.min.x + 4, box.min.y + 4, State::continent);
-        return true;
-    }
-    /* Didn't collide; confirm move. */
-    else {
-        return false;
+    c2v moved {dx, dy};
+    bool collided = false;
+    if (!passThrough) {
+        const auto sweep = _map.sweep({middle, middle}, {dx, dy}, State::continent, layer, ignore);
+        moved = {sweep.box.min.x - middle.x, sweep.box.min.y - middle.y};
+        if (sweep.blocked) {
+            collidedTile = sweep.blockedTile;
+            collided = true;
+        }
     }
+
+    box.min.x += moved.x;
+    box.max.x += moved.x;
+    box.min.y += moved.y;
+    box.max.y += moved.y;
+
+    centerTile = _map.getTile(box.min.x + 4, box.min.y + 4, State::continent);
+
+    return collided;
 }
 
 void Ingame::moveMob(Mob &mob, float dt, const glm::vec2 &dir)
@@ -1450,11 +1553,12 @@ void Ingame::moveMob(Mob &mob, float dt, const glm::vec2 &dir)
     Tile centerTile {-1, -1, -1};
     Tile collidedTile {-1, -1, -1};
 
-    bool collidedX = moveIncrement(aabb, dx, 0, centerTile, collidedTile, &Ingame::mobCanMove, true);
-    bool collidedY = moveIncrement(aabb, 0, dy, centerTile, collidedTile, &Ingame::mobCanMove, true);
+    bool collidedX = moveIncrement(aabb, dx, 0, centerTile, collidedTile, PASS_MOB, true);
+    bool collidedY = moveIncrement(aabb, 0, dy, centerTile, collidedTile, PASS_MOB, true);
 
     if (centerTile.tx != mob.tile.x || centerTile.ty != mob.tile.y) {
         mob.tile = {centerTile.tx, centerTile.ty};
+        _entityGrid.move(State::continent, mob.id % 40, mob.tile);
     }
 
     mob.entity.setPosition(aabb.min.x - kEntityOffsetX, aabb.min.y - kEntityOffsetY);
@@ -1504,8 +1608,8 @@ void Ingame::moveHero(float dt)
     Tile centerTile {-1, -1, -1};
     Tile collidedTile {-1, -1, -1};
 
-    bool collidedX = moveIncrement(aabb, dx, 0, centerTile, collidedTile, &Ingame::heroCanMove, false);
-    bool collidedY = moveIncrement(aabb, 0, dy, centerTile, collidedTile, &Ingame::heroCanMove, false);
+    bool collidedX = moveIncrement(aabb, dx, 0, centerTile, collidedTile, _spHero.getPassLayer(), false);
+    bool collidedY = moveIncrement(aabb, 0, dy, centerTile, collidedTile, _spHero.getPassLayer(), false);
 
     bool teleport {false};
 
@@ -1680,19 +1784,146 @@ void Ingame::sailTo(int continent)
     }
 }
 
-void Ingame::drawMobs()
+void Ingame::openTravel()
 {
-    for (auto *mob : getMobsInRange(State::x, State::y, 4)) {
-        if (mob->dead) {
-            continue;
+    const auto &fog = State::fog[State::continent];
+
+    /* Anywhere on this continent the hero has seen, towns on the left and
+        castles on the right. */
+    _travelChoices.clear();
+    std::vector<std::pair<glm::ivec2, std::string>> options;
+    int numTowns = 0;
+    int numCastles = 0;
+
+    for (int i = 0; i < 26; i++) {
+        const glm::ivec2 tile {kTownInfo[i].x, 63 - kTownInfo[i].y};
+        if (kTownInfo[i].continent == State::continent && fog.isSeen(tile.x, tile.y)) {
+            options.push_back({{3, 6 + numTowns++}, kTownInfo[i].name});
+            _travelChoices.push_back(tile);
+        }
+    }
+    for (int i = 0; i < 26; i++) {
+        const glm::ivec2 tile {kCastleInfo[i].x, 63 - kCastleInfo[i].y};
+        if (kCastleInfo[i].continent == State::continent && fog.isSeen(tile.x, tile.y)) {
+            options.push_back({{18, 6 + numCastles++}, kCastleInfo[i].name});
+            _travelChoices.push_back(tile);
         }
-        mob->entity.draw();
+    }
+
+    if (_travelChoices.empty()) {
+        _engine.getGUI().getHUD().setError("  You have not seen any towns or castles!");
+        return;
+    }
+
+    auto dialog = _engine.getGUI().makeDialog(1, 3, 30, 24);
+    dialog->addString(3, 3, "Towns and castles you've seen");
+    dialog->addString(7, 20, "Travel to which?");
+    for (const auto &[position, name] : options) {
+        dialog->addOption(position.x, position.y, name);
+    }
+    dialog->bind(Key::Enter, [this](int opt) {
+        travelTo(_travelChoices[opt]);
+        _engine.getGUI().popDialog();
+    });
+}
+
+void Ingame::travelTo(glm::ivec2 tile)
+{
+    stopTravel();
+
+    _travelLayer = _spHero.getPassLayer();
+    if (!_map.getPathfinder(State::continent).find(_travelLayer, {State::x, State::y}, tile, _travelPath)) {
+        _travelPath.clear();
+        _engine.getGUI().getHUD().setError("    There is no way there from here!");
+    }
+}
+
+void Ingame::travel(float dt)
+{
+    /* Anything that takes over from walking ends the trip: an event
+        opening a dialog, boarding or leaving the boat, pausing. */
+    if (_paused || _engine.getGUI().hasDialog() || _spHero.getPassLayer() != _travelLayer) {
+        stopTravel();
+        _spHero.setMoving(false);
+        return;
+    }
+
+    const auto aabb = _spHero.getAABB();
+    const glm::vec2 position {aabb.min.x + kEntitySizeX / 2, aabb.min.y + kEntitySizeY / 2};
+    const auto tileCentre = [](glm::ivec2 tile) {
+        return glm::vec2 {tile.x * 48.0f + 24.0f, tile.y * 40.0f + 20.0f};
+    };
+
+    /* Move on from a waypoint once the hero is on it, but only turn once
+        lined up with the next one, or the corner gets clipped. */
+    while (State::x == _travelPath[_travelStep].x && State::y == _travelPath[_travelStep].y) {
+        if (_travelStep + 1 == _travelPath.size()) {
+            stopTravel();
+            _spHero.setMoving(false);
+            return;
+        }
+
+        const auto centre = tileCentre(_travelPath[_travelStep]);
+        const auto next = _travelPath[_travelStep + 1] - _travelPath[_travelStep];
+        if ((next.x != 0 && std::abs(position.y - centre.y) > kTravelSlack) || (next.y != 0 && std::abs(position.x - centre.x) > kTravelSlack)) {
+            break;
+        }
+        _travelStep++;
+    }
+
+    if (State::x != _travelLastTile.x || State::y != _travelLastTile.y) {
+        _travelLastTile = {State::x, State::y};
+        _travelStuckTime = 0.0f;
+    }
+    else if ((_travelStuckTime += dt) > kTravelGiveUpSeconds) {
+        stopTravel();
+        _spHero.setMoving(false);
+        return;
+    }
+
+    const auto target = tileCentre(_travelPath[_travelStep]);
+    _moveFlags = DIR_FLAG_NONE;
+    if (target.x - position.x > kTravelSlack) {
+        _moveFlags |= DIR_FLAG_RIGHT;
+    }
+    else if (position.x - target.x > kTravelSlack) {
+        _moveFlags |= DIR_FLAG_LEFT;
+    }
+    if (target.y - position.y > kTravelSlack) {
+        _moveFlags |= DIR_FLAG_DOWN;
+    }
+    else if (position.y - target.y > kTravelSlack) {
+        _moveFlags |= DIR_FLAG_UP;
+    }
+
+    moveHero(dt);
+}
+
+void Ingame::stopTravel()
+{
+    _travelPath.clear();
+    _travelStep = 0;
+    _travelLastTile = {-1, -1};
+    _travelStuckTime = 0.0f;
+    _moveFlags = DIR_FLAG_NONE;
+}
+
+void Ingame::drawMobs()
+{
+    for (const auto &entity : _entityGrid.inRect(State::continent, _visibleTiles.x, _visibleTiles.y, _visibleTiles.z, _visibleTiles.w)) {
+        State::mobs[State::continent][entity.index].entity.draw();
     }
 }
 
 void Ingame::collideTeleportCave(const Tile &tile)
 {
-    auto dest = glm::ivec2 {tile.tx, tile.ty} == State::teleport_cave_tiles[State::continent][0] ? State::teleport_cave_tiles[State::continent][1] : State::teleport_cave_tiles[State::continent][0];
+    const auto &event = _eventIndex.get(State::continent, tile.tx, tile.ty);
+    if (event.kind != EVENT_TELEPORT_CAVE) {
+        spdlog::warn("Couldn't find teleport cave at [{}] {} {}", State::continent, tile.tx, tile.ty);
+        return;
+    }
+
+    const auto dest = State::teleport_cave_tiles[State::continent][1 - event.id];
     moveHeroTo(dest.x, dest.y, State::continent);
 }
 
@@ -1700,13 +1931,10 @@ void Ingame::updateMobs(float dt)
 {
     const auto &heroPos = _spHero.getPosition();
 
-    int continent = State::continent;
-
-    for (auto *mob : getMobsInRange(State::x, State::y, 4)) {
-        if (mob->dead) {
-            continue;
-        }
+    _mobFlow.update(_map.getPassability(State::continent), PASS_MOB, State::continent, {State::x, State::y});
 
+    for (const auto &entity : _entityGrid.inRange(State::continent, State::x, State::y, 4)) {
+        auto *mob = &State::mobs[State::continent][entity.index];
         const auto mob_pos = mob->entity.getPosition();
 
         float distanceX = std::abs(heroPos.x - mob_pos.x);
@@ -1714,22 +1942,37 @@ void Ingame::updateMobs(float dt)
 
         glm::vec2 dir {0.0f, 0.0f};
 
-        if (distanceX > 3.0f) {
-            dir.x = heroPos.x > mob_pos.x ? 1.0f : -1.0f;
+        /* Follow the flow field around trees and water until next to the
+            hero, then close in on them directly. */
+        const auto next = _mobFlow.getNext(mob->tile);
+        if (next != mob->tile && _mobFlow.getDistance(mob->tile) > 1) {
+            const auto aabb = mob->entity.getAABB();
+            const float offsetX = next.x * 48.0f + 24.0f - (aabb.min.x + kEntitySizeX / 2);
+            const float offsetY = next.y * 40.0f + 20.0f - (aabb.min.y + kEntitySizeY / 2);
+
+            if (std::abs(offsetX) > 3.0f) {
+                dir.x = offsetX > 0.0f ? 1.0f : -1.0f;
+            }
+            if (std::abs(offsetY) > 3.0f) {
+                dir.y = offsetY > 0.0f ? 1.0f : -1.0f;
+            }
         }
+        else {
+            if (distanceX > 3.0f) {
+                dir.x = heroPos.x > mob_pos.x ? 1.0f : -1.0f;
+            }
 
-        if (distanceY > 3.0f) {
-            dir.y = heroPos.y > mob_pos.y ? 1.0f : -1.0f;
+            if (distanceY > 3.0f) {
+                dir.y = heroPos.y > mob_pos.y ? 1.0f : -1.0f;
+            }
         }
 
         if (_spHero.getMount() == Mount::Walk && distanceX < 12.0f && distanceY < 12.0f) {
-            for (auto j = 0u; j < State::friendly_mobs[State::continent].size(); j++) {
-                if (State::friendly_mobs[State::continent][j] == mob->id) {
-                    tryJoin(mob->army[0], mob->counts[0], [this, mob]() {
-                        mob->dead = true;
-                    });
-                    return;
-                }
+            if (entity.kind == GRID_FRIENDLY_MOB) {
+                tryJoin(mob->army[0], mob->counts[0], [this, mob]() {
+                    killMob(*mob);
+                });
+                return;
             }
 
             _engine.startEncounterBattle(mob->id);
@@ -1744,20 +1987,10 @@ void Ingame::updateMobs(float dt)
 
 void Ingame::collideSign(const Tile &tile)
 {
-    int index = 0;
-    auto *tiles = _map.getTiles(State::continent);
-    for (int y = 63; y >= 0; y--) {
-        for (int x = 0; x < 64; x++) {
-            if (tiles[y * 64 + x] == Tile_GenSign) {
-                if (x == tile.tx && y == tile.ty) {
-                    _engine.getGUI().showMessage(1, 21, 30, 6, fmt::format("A sign reads\n\n{}", kSigns[index + State::continent * 22]));
-                    goto foundSign;
-                }
-                index++;
-            }
-        }
+    const auto &event = _eventIndex.get(State::continent, tile.tx, tile.ty);
+    if (event.kind == EVENT_SIGN) {
+        _engine.getGUI().showMessage(1, 21, 30, 6, fmt::format("A sign reads\n\n{}", kSigns[event.id]));
     }
-foundSign:;
 }
 
 bool Ingame::events(const Tile &tile, bool &teleport)
@@ -1805,7 +2038,7 @@ bool Ingame::events(const Tile &tile, bool &teleport)
             SceneMan::instance().setScene("wizard");
             break;
         case Tile_ShopCave:
-            if (glm::ivec2 {tile.tx, tile.ty} == State::teleport_cave_tiles[State::continent][0] || glm::ivec2 {tile.tx, tile.ty} == State::teleport_cave_tiles[State::continent][1]) {
+            if (_eventIndex.get(State::continent, tile.tx, tile.ty).kind == EVENT_TELEPORT_CAVE) {
                 collideTeleportCave(tile);
                 teleport = true;
             }
@@ -1834,31 +2067,28 @@ bool Ingame::events(const Tile &tile, bool &teleport)
 
 void Ingame::collideShop(const Tile &tile)
 {
-    int shop_id = -1;
-    for (auto i = 0u; i < State::shops[State::continent].size(); i++) {
-        if (State::shops[State::continent][i].x == tile.tx && State::shops[State::continent][i].y == tile.ty) {
-            shop_id = i;
-            break;
-        }
-    }
-    if (shop_id == -1) {
+    const auto &event = _eventIndex.get(State::continent, tile.tx, tile.ty);
+    if (event.kind != EVENT_SHOP) {
         spdlog::warn("Failed to find shop at [{}] {} {}", State::continent, tile.tx, tile.ty);
     }
     else {
-        _engine.openShop(State::shops[State::continent][shop_id]);
+        _engine.openShop(State::shops[State::continent][event.id]);
     }
 }
 
 void Ingame::collideChest(const Tile &tile)
 {
+    const auto chest = _eventIndex.get(State::continent, tile.tx, tile.ty).id;
+
     _map.setTile(tile, State::continent, Tile_Grass);
+    _eventIndex.clear(State::continent, tile.tx, tile.ty);
 
-    if (State::continent < 3 && tile.tx == State::sail_map_tiles[State::continent].x && tile.ty == State::sail_map_tiles[State::continent].y) {
+    if (chest == CHEST_SAIL_MAP) {
         State::sail_maps_found[State::continent + 1] = true;
         _btSailMapDest->setString(kContinentNames[State::continent + 1]);
         _engine.getGUI().pushDialog(_dlgSailMap);
     }
-    else if (tile.tx == State::continent_map_tiles[State::continent].x && tile.ty == State::continent_map_tiles[State::continent].y) {
+    else if (chest == CHEST_CONTINENT_MAP) {
         State::continent_maps_found[State::continent] = true;
         _engine.getGUI().pushDialog(_dlgContMap);
     }
@@ -1869,19 +2099,14 @@ void Ingame::collideChest(const Tile &tile)
 
 void Ingame::collideCastle(const Tile &tile)
 {
-    int castleId = -1;
+    const auto &event = _eventIndex.get(State::continent, tile.tx, tile.ty);
 
-    for (int i = 0; i < 26; i++) {
-        if (kCastleInfo[i].x == tile.tx && kCastleInfo[i].y == 63 - tile.ty && kCastleInfo[i].continent == State::continent) {
-            castleId = i;
-        }
-    }
-
-    if (castleId == -1) {
+    if (event.kind != EVENT_CASTLE) {
         spdlog::warn("Failed to find castle at [{},{}] in {}", tile.tx, tile.ty, kContinentNames[State::continent]);
         return;
     }
 
+    const int castleId = event.id;
     int occupier = State::castle_occupants[castleId];
 
     if (occupier == -1) {
@@ -1910,47 +2135,30 @@ void Ingame::collideCastle(const Tile &tile)
 
 void Ingame::collideTown(const Tile &tile)
 {
-    int townId = -1;
+    const auto &event = _eventIndex.get(State::continent, tile.tx, tile.ty);
 
-    for (int i = 0; i < 26; i++) {
-        if (kTownInfo[i].continent == State::continent && kTownInfo[i].x == tile.tx && 63 - kTownInfo[i].y == tile.ty) {
-            townId = i;
-            break;
-        }
-    }
-
-    if (townId == -1) {
+    if (event.kind != EVENT_TOWN) {
         spdlog::warn("Couldn't find town at {}, {}", tile.tx, tile.ty);
         return;
     }
 
+    const int townId = event.id;
     State::towns[townId].visited = true;
     _engine.openTown(&State::towns[townId]);
 }
 
 void Ingame::collideArtifact(const Tile &tile)
 {
-    _map.setTile(tile, State::continent, Tile_Grass);
-
-    static constexpr const int artifact_ids[8] = {
-        Tile_AfctScroll,
-        Tile_AfctShield,
-        Tile_AfctCrown,
-        Tile_AfctAmulet,
-        Tile_AfctRing,
-        Tile_AfctAnchor,
-        Tile_AfctBook,
-        Tile_AfctSword,
-    };
+    const auto &event = _eventIndex.get(State::continent, tile.tx, tile.ty);
+    if (event.kind != EVENT_ARTIFACT) {
+        spdlog::warn("Couldn't find artifact at [{}] {} {}", State::continent, tile.tx, tile.ty);
+        return;
+    }
 
-    int artifact = -1;
+    const int artifact = event.id;
 
-    for (int i = 0; i < 8; i++) {
-        if (tile.id == artifact_ids[i]) {
-            artifact = i;
-            break;
-        }
-    }
+    _map.setTile(tile, State::continent, Tile_Grass);
+    _eventIndex.clear(State::continent, tile.tx, tile.ty);
 
     State::artifacts_found[artifact] = true;
 
@@ -2080,43 +2288,19 @@ void Ingame::flyLand()
     auto mount = _spHero.getMount();
 
     if (mount == Mount::Fly) {
-        c2AABB ent_shape = _spHero.getAABB();
-
-        int range = 4;
-        int offset = range / 2;
-
-        /* No need to check surrounding tiles if we can't land on the current tile anyway. */
-        if (_map.getTile(_spHero.getCenter(), State::continent).id != Tile_Grass) {
-            goto endLoop;
-        }
-
-        /* Make sure we're not intersecting any collidable tiles when we land. */
-        for (int i = 0; i <= range; i++) {
-            for (int j = 0; j <= range; j++) {
-                int x = State::x - offset + i;
-                int y = State::y - offset + j;
-
-                if (x == State::x && y == State::y) {
-                    continue;
-                }
-
-                if (x < 0 || x > 63 || y < 0 || y > 63) {
-                    continue;
-                }
+        const auto &passability = _map.getPassability(State::continent);
+        const auto center = _map.getTile(_spHero.getCenter(), State::continent);
+        const auto box = _spHero.getAABB();
 
-                c2AABB tileShape;
-                tileShape.min.x = 48.0f * x;
-                tileShape.min.y = 40.0f * y;
-                tileShape.max.x = tileShape.min.x + 48.0f;
-                tileShape.max.y = tileShape.min.y + 40.0f;
+        /* Land only where the hero isn't overlapping anything collidable. */
+        const int minX = static_cast<int>(std::floor(box.min.x / 48.0f));
+        const int minY = static_cast<int>(std::floor(box.min.y / 40.0f));
+        const int maxX = static_cast<int>(std::floor((box.max.x - 1.0f) / 48.0f));
+        const int maxY = static_cast<int>(std::floor((box.max.y - 1.0f) / 40.0f));
 
-                if (_map.getTile(ent_shape.min.x, ent_shape.min.y, State::continent).id != Tile_Grass && !c2AABBtoAABB(ent_shape, tileShape)) {
-                    goto endLoop;
-                }
-            }
+        if (passability.test(PASS_LAND, center.tx, center.ty) && passability.testRect(PASS_LAND, minX, minY, maxX, maxY)) {
+            _spHero.setMount(Mount::Walk);
         }
-        _spHero.setMount(Mount::Walk);
-    endLoop:;
     }
     else if (mount == Mount::Walk) {
         bool canFly = true;
@@ -2138,6 +2322,7 @@ void Ingame::flyLand()
 void Ingame::dayTick()
 {
     State::days--;
+    Telemetry::instance().emit(TelemetryDay {State::days, State::gold, State::weeks_passed, State::continent, State::followers_killed});
     if (State::days == 0) {
         defeat();
     }
@@ -2165,20 +2350,35 @@ void Ingame::timestopTick()
     }
 }
 
-std::vector<Mob *> Ingame::getMobsInRange(int x, int y, int range)
+void Ingame::rebuildEntityGrid()
 {
-    std::vector<Mob *> moblist;
+    _entityGrid.clear();
 
-    for (auto &mob : State::mobs[State::continent]) {
-        if (mob.dead) {
-            continue;
-        }
-        if (std::abs(x - mob.tile.x) <= range && std::abs(y - mob.tile.y) <= range) {
-            moblist.push_back(&mob);
+    for (int c = 0; c < 4; c++) {
+        for (int i = 0; i < 40; i++) {
+            const auto &mob = State::mobs[c][i];
+            const auto &friendly = State::friendly_mobs[c];
+            const bool isFriendly = std::find(friendly.begin(), friendly.end(), mob.id) != friendly.end();
+
+            _entityGrid.add(c, {isFriendly ? GRID_FRIENDLY_MOB : GRID_MOB, i, mob.tile});
+            if (mob.dead) {
+                _entityGrid.remove(c, i);
+            }
         }
     }
+}
 
-    return moblist;
+void Ingame::rebuildEventIndex()
+{
+    for (int c = 0; c < 4; c++) {
+        _eventIndex.build(c, _map.getTiles(c));
+    }
+}
+
+void Ingame::killMob(Mob &mob)
+{
+    mob.dead = true;
+    _entityGrid.remove(mob.id / 40, mob.id % 40);
 }
 
 void Ingame::automoveTick()
@@ -2199,8 +2399,8 @@ void Ingame::automove(float dt)
     Tile centerTile {-1, -1, -1};
     Tile collidedTile {-1, -1, -1};
 
-    moveIncrement(aabb, dx, 0, centerTile, collidedTile, &Ingame::heroCanMove, false);
-    moveIncrement(aabb, 0, dy, centerTile, collidedTile, &Ingame::heroCanMove, false);
+    moveIncrement(aabb, dx, 0, centerTile, collidedTile, _spHero.getPassLayer(), false);
+    moveIncrement(aabb, 0, dy, centerTile, collidedTile, _spHero.getPassLayer(), false);
 
     _spHero.setPosition(aabb.min.x - kEntityOffsetX, aabb.min.y - kEntityOffsetY);
 
@@ -2212,8 +2412,15 @@ void Ingame::automove(float dt)
     updateCamera();
 }
 
-void Ingame::saveState(std::ofstream &f)
+static constexpr int kFogBytes = Fog::kSize * sizeof(uint64_t);
+static constexpr int kLegacyFogBytes = 4096;
+/* Tiles, hero, boat and towns, which follow the fog in a save. */
+static constexpr size_t kSaveTailBytes = 4 * 4096 + 8 + 4 + 1 + 8 + 1 + sizeof(TownGen) * std::tuple_size_v<decltype(State::towns)>;
+
+void Ingame::saveState(std::ostream &f)
 {
+    BTY_PROFILE_ZONE("Ingame::saveState");
+
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 40; j++) {
             f.write((char *)State::mobs[i][j].army.data(), 5 * 4);
@@ -2296,7 +2503,7 @@ void Ingame::saveState(std::ofstream &f)
     }
 
     for (int i = 0; i < 4; i++) {
-        f.write((char *)State::visited_tiles[i].data(), 4096);
+        f.write((char *)State::fog[i].getRows().data(), kFogBytes);
     }
 
     for (int i = 0; i < 4; i++) {
@@ -2321,6 +2528,8 @@ void Ingame::saveState(std::ofstream &f)
 
 void Ingame::loadState(std::ifstream &f)
 {
+    BTY_PROFILE_ZONE("Ingame::loadState");
+
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 40; j++) {
             State::mobs[i][j].entity.setTexture(nullptr);
@@ -2408,8 +2617,30 @@ void Ingame::loadState(std::ifstream &f)
         f.read((char *)State::friendly_mobs[i].data(), 4 * num_friendly_mobs);
     }
 
+    /* Older saves kept a copy of every seen tile's id instead of a bit,
+        4096 bytes a continent with 0xFF for unseen. Everything from here
+        to the end is a fixed size either way, so what's left says which
+        this is. */
+    const auto fogStart = f.tellg();
+    f.seekg(0, std::ios::end);
+    const auto remaining = static_cast<size_t>(f.tellg() - fogStart);
+    f.seekg(fogStart);
+
+    const bool legacyFog = remaining == 4 * kLegacyFogBytes + kSaveTailBytes;
     for (int i = 0; i < 4; i++) {
-        f.read((char *)State::visited_tiles[i].data(), 4096);
+        if (legacyFog) {
+            std::array<unsigned char, kLegacyFogBytes> visited;
+            f.read((char *)visited.data(), kLegacyFogBytes);
+            State::fog[i].clear();
+            for (int j = 0; j < kLegacyFogBytes; j++) {
+                if (visited[j] != 0xFF) {
+                    State::fog[i].reveal(j % 64, j / 64, j % 64, j / 64);
+                }
+            }
+        }
+        else {
+            f.read((char *)State::fog[i].getRows().data(), kFogBytes);
+        }
     }
 
     for (int i = 0; i < 4; i++) {
@@ -2417,6 +2648,9 @@ void Ingame::loadState(std::ifstream &f)
     }
 
     _map.createGeometry();
+    rebuildEntityGrid();
+    rebuildEventIndex();
+    SharedState::instance().resetTick();
 
     auto &hud {_engine.getGUI().getHUD()};
     hud.setHero(State::hero, State::rank);
@@ -2461,7 +2695,6 @@ void Ingame::loadState(std::ifstream &f)
 
 void Ingame::updateAnimations(float dt)
 {
-    _map.update(dt);
     _spHero.update(dt);
 
     for (auto &mob : State::mobs[State::continent]) {
@@ -2477,7 +2710,7 @@ void Ingame::winSiegeBattle(int castleId)
 
 void Ingame::winEncounterBattle(int mobId)
 {
-    State::mobs[State::continent][mobId % 40].dead = true;
+    killMob(State::mobs[State::continent][mobId % 40]);
 }
 
 void Ingame::pause()
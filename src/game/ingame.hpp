@@ -15,6 +15,9 @@
 #include "game/chest-spell.hpp"
 #include "game/defeat.hpp"
 #include "game/dir-flags.hpp"
+#include "game/entity-grid.hpp"
+#include "game/event-index.hpp"
+#include "game/flow-field.hpp"
 #include "game/game-controls.hpp"
 #include "game/garrison.hpp"
 #include "game/hero.hpp"
@@ -57,6 +60,9 @@ public:
     void render() override;
     void renderLate() override;
     void load() override;
+    void unload() override;
+    bool isPersistent() const override;
+    std::vector<std::string> getAssets() const override;
     void enter() override;
 
     void setup();
@@ -68,7 +74,7 @@ public:
     void setBoatPosition(float x, float y);
     void disgrace();
 
-    void saveState(std::ofstream &f);
+    void saveState(std::ostream &f);
     void loadState(std::ifstream &f);
 
 private:
@@ -99,8 +105,9 @@ private:
     void automoveTick();
 
     /* Movement */
-    bool moveIncrement(c2AABB &box, float dx, float dy, Tile &centerTile, Tile &collidedTile, bool (Ingame::*canMove)(int), bool mob);
+    bool moveIncrement(c2AABB &box, float dx, float dy, Tile &centerTile, Tile &collidedTile, PassLayer layer, bool mob);
     void updateCamera();
+    void zoom(int delta);
     void sailTo(int continent);
     void updateVisitedTiles();
     void moveHero(float dt);
@@ -108,10 +115,12 @@ private:
     void moveMob(Mob &entity, float dt, const glm::vec2 &dir);
     void flyLand();
     void automove(float dt);
+    void openTravel();
+    void travelTo(glm::ivec2 tile);
+    void travel(float dt);
+    void stopTravel();
 
     /* Collision */
-    bool heroCanMove(int id);
-    bool mobCanMove(int id);
     bool events(const Tile &tile, bool &teleport);
     void collideSign(const Tile &tile);
     void collideTown(const Tile &tile);
@@ -126,7 +135,9 @@ private:
 
     void endWeek(bool search);
 
-    std::vector<Mob *> getMobsInRange(int x, int y, int range);
+    void rebuildEntityGrid();
+    void rebuildEventIndex();
+    void killMob(Mob &mob);
 
     void handlePauseOptions(int opt);
     void pause();
@@ -159,13 +170,30 @@ private:
     bty::Text *_btTCGate1;
 
     int _moveFlags {DIR_FLAG_NONE};
+    /* Route being walked by travelTo, and the tiles offered to it. */
+    std::vector<glm::ivec2> _travelPath;
+    size_t _travelStep {0};
+    PassLayer _travelLayer {PASS_WALK};
+    glm::ivec2 _travelLastTile {-1, -1};
+    float _travelStuckTime {0.0f};
+    std::vector<glm::ivec2> _travelChoices;
     bool _loaded {false};
     bool _paused {false};
+    /* Steps spent walking without anything else going on. */
+    int _steadySteps {0};
 
     Map _map;
+    /* Mob handles are their slot in State::mobs. */
+    EntityGrid _entityGrid;
+    EventIndex _eventIndex;
+    /* Towards the hero, over tiles mobs can walk. */
+    FlowField _mobFlow;
     Hero _spHero;
     glm::mat4 _uiView;
     glm::mat4 _mapView;
+    int _zoomLevel {0};
+    float _zoom {1.0f};
+    glm::ivec4 _visibleTiles {0, 0, 63, 63};
     std::array<const bty::Texture *, 25> _texUnits;
 
     /* Clocks */
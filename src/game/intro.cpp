@@ -45,6 +45,13 @@ void Intro::load()
     });
 }
 
+std::vector<std::string> Intro::getAssets() const
+{
+    return {
+        "bg/intro.png",
+    };
+}
+
 void Intro::enter()
 {
     _pickedHero = false;
@@ -21,6 +21,7 @@ public:
     bool handleEvent(Event event) override;
     bool handleKey(Key key) override;
     void load() override;
+    std::vector<std::string> getAssets() const override;
     void enter() override;
     void render() override;
 
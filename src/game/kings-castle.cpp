@@ -95,6 +95,13 @@ void KingsCastle::load()
     }
 }
 
+std::vector<std::string> KingsCastle::getAssets() const
+{
+    return {
+        "bg/castle.png",
+    };
+}
+
 void KingsCastle::render()
 {
     GFX::instance().drawSprite(_spBg);
@@ -17,6 +17,7 @@ public:
     KingsCastle(bty::Engine &engine);
     void render() override;
     void load();
+    std::vector<std::string> getAssets() const override;
     void enter();
     bool handleEvent(Event event) override;
     void update(float dt) override;
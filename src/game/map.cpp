@@ -2,9 +2,18 @@
 
 #include <spdlog/spdlog.h>
 
+#include <cmath>
+#include <functional>
 #include <glm/gtc/type_ptr.hpp>
+#include <limits>
 
+#include "engine/frame-arena.hpp"
+#include "engine/job-system.hpp"
+#include "engine/profiler.hpp"
 #include "engine/texture-cache.hpp"
+#include "game/timer-groups.hpp"
+#include "gfx/gfx.hpp"
+#include "gfx/gpu-registry.hpp"
 #include "gfx/shader.hpp"
 #include "gfx/texture.hpp"
 
@@ -13,17 +22,42 @@ struct Vertex {
     glm::vec2 uv;
 };
 
+Map::Map()
+    : _tilesetAnimTimer(0.18f, std::bind(&Map::nextTileset, this), TIMER_GROUP_OVERWORLD)
+{
+}
+
 Map::~Map()
 {
-    glDeleteVertexArrays(4, _vaos);
-    glDeleteBuffers(4, _vbos);
-    glDeleteProgram(_shader);
+    auto &registry {GpuResources::instance()};
+    auto &gfx {GFX::instance()};
+    for (int i = 0; i < 4; i++) {
+        registry.remove(bty::GpuResourceType::Buffer, _vbos[i]);
+        gfx.releaseBuffer(_vbos[i]);
+    }
+    registry.remove(bty::GpuResourceType::Program, _shader);
+    for (int i = 0; i < 4; i++) {
+        registry.remove(bty::GpuResourceType::Texture, _lodTextures[i]);
+        gfx.releaseTexture(_lodTextures[i]);
+    }
+    registry.remove(bty::GpuResourceType::Buffer, _lodVbo);
+
+    gfx.releaseBuffer(_lodVbo);
+    gfx.releaseProgram(_shader);
 }
 
 void Map::load()
 {
+    BTY_PROFILE_ZONE("Map::load");
+
+    std::vector<std::string> tilesetPaths;
+    for (int i = 0; i < 10; i++) {
+        tilesetPaths.push_back(fmt::format("tilesets/tileset{}.png", i));
+    }
+    Textures::instance().preload(tilesetPaths);
+
     for (int i = 0; i < 10; i++) {
-        _texTilesets[i] = Textures::instance().get(fmt::format("tilesets/tileset{}.png", i));
+        _texTilesets[i] = Textures::instance().get(tilesetPaths[i]);
     }
 
     _numVerts = 4096 * 6;
@@ -36,7 +70,11 @@ void Map::load()
     };
 
     glCreateBuffers(4, _vbos);
-    glCreateVertexArrays(4, _vaos);
+
+    auto &registry {GpuResources::instance()};
+    for (int i = 0; i < 4; i++) {
+        registry.add(bty::GpuResourceType::Buffer, _vbos[i], bty::GpuCategory::Map, 4096 * 6 * sizeof(GLfloat) * 4);
+    }
 
     auto &textures {Textures::instance()};
 
@@ -56,18 +94,13 @@ void Map::load()
         std::copy(_tiles[i].begin(), _tiles[i].end(), _readOnlyTiles[i].begin());
 
         glNamedBufferStorage(_vbos[i], 4096 * 6 * sizeof(GLfloat) * 4, nullptr, GL_DYNAMIC_STORAGE_BIT);
-        glBindVertexArray(_vaos[i]);
-        glBindBuffer(GL_ARRAY_BUFFER, _vbos[i]);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4, nullptr);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4, (const void *)(2 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
-        glBindVertexArray(GL_NONE);
     }
 
+    createLod();
+
     const auto &basePath = textures.getBasePath();
 
-    _shader = bty::loadShader(fmt::format("{}/shaders/map.glsl.vert", basePath), fmt::format("{}/shaders/map.glsl.frag", basePath));
+    _shader = bty::loadShader(fmt::format("{}/shaders/map.glsl.vert", basePath), fmt::format("{}/shaders/map.glsl.frag", basePath), bty::GpuCategory::Map);
     if (_shader == GL_NONE) {
         spdlog::warn("Map: Failed to load shader");
     }
@@ -77,26 +110,33 @@ void Map::load()
     }
 }
 
-void Map::draw(const glm::mat4 &camera)
+void Map::draw(const glm::mat4 &camera, float zoom)
 {
-    glProgramUniformMatrix4fv(_shader, _viewLoc, 1, GL_FALSE, glm::value_ptr(camera));
-    glProgramUniform1i(_shader, _texLoc, 0);
+    bty::Mesh mesh {
+        .program = _shader,
+        .cameraLoc = _viewLoc,
+        .textureLoc = _texLoc,
+    };
+
+    if (zoom < 0.5f) {
+        /* A tile is 12x10 pixels or less on screen at this point, so its
+            average colour is close enough. */
+        mesh.texture = _lodTextures[_continent];
+        mesh.vbo = _lodVbo;
+        mesh.count = 6;
+    }
+    else {
+        mesh.texture = _texTilesets[_curTilesetIndex]->handle;
+        mesh.vbo = _vbos[_continent];
+        mesh.count = _numVerts;
+    }
 
-    glUseProgram(_shader);
-    glBindVertexArray(_vaos[_continent]);
-    glBindTextureUnit(0, _texTilesets[_curTilesetIndex]->handle);
-    glDrawArrays(GL_TRIANGLES, 0, _numVerts);
-    glBindVertexArray(GL_NONE);
-    glUseProgram(GL_NONE);
+    GFX::instance().drawMesh(mesh, camera);
 }
 
-void Map::update(float dt)
+void Map::nextTileset()
 {
-    _tilesetAnimTimer += dt;
-    if (_tilesetAnimTimer >= 0.18f) {
-        _tilesetAnimTimer = 0;
-        _curTilesetIndex = (_curTilesetIndex + 1) % 10;
-    }
+    _curTilesetIndex = (_curTilesetIndex + 1) % 10;
 }
 
 Tile Map::getTile(int tx, int ty, int continent) const
@@ -131,45 +171,78 @@ unsigned char *Map::getTiles(int continent)
     return _tiles[continent].data();
 }
 
+const Passability &Map::getPassability(int continent) const
+{
+    return _passability[continent];
+}
+
+Pathfinder &Map::getPathfinder(int continent)
+{
+    return _pathfinders[continent];
+}
+
 void Map::createGeometry()
 {
+    BTY_PROFILE_ZONE("Map::createGeometry");
+
     for (int continent = 0; continent < 4; continent++) {
-        float texAdvX = 1.0f / (_texTilesets[0]->width / 50.0f);
-        float texAdvY = 1.0f / (_texTilesets[0]->height / 42.0f);
-
-        float pxOfsX = 1.0f / _texTilesets[0]->width;
-        float pxOfsY = 1.0f / _texTilesets[0]->height;
-
-        std::vector<Vertex> vertices(4096 * 6);
-
-        auto *vtx = &vertices[0];
-
-        for (int i = 0; i < 64; i++) {
-            for (int j = 0; j < 64; j++) {
-                float l = i * 48.0f;
-                float t = j * 40.0f;
-                float r = (i + 1) * 48.0f;
-                float b = (j + 1) * 40.0f;
-
-                int tileId = _tiles[continent][j * 64 + i];
-                int tileX = tileId % 16;
-                int tileY = tileId / 16;
-
-                float ua = tileX * texAdvX + pxOfsX;
-                float ub = (tileX + 1) * texAdvX - pxOfsX;
-                float va = tileY * texAdvY + pxOfsY;
-                float vb = (tileY + 1) * texAdvY - pxOfsY;
-
-                *vtx++ = {{l, t}, {ua, va}};
-                *vtx++ = {{r, t}, {ub, va}};
-                *vtx++ = {{l, b}, {ua, vb}};
-                *vtx++ = {{r, t}, {ub, va}};
-                *vtx++ = {{r, b}, {ub, vb}};
-                *vtx++ = {{l, b}, {ua, vb}};
+        _passability[continent].build(_tiles[continent].data());
+        _pathfinders[continent].build(&_passability[continent], _tiles[continent].data());
+    }
+
+    /* Scratch for the four continents' vertices, carved out here because
+        the workers can't allocate from it themselves. Freed on return. */
+    bty::Arena scratch(4 * 4096 * 6 * sizeof(Vertex) + alignof(Vertex));
+    std::array<Vertex *, 4> continentVertices;
+    for (auto &vertices : continentVertices) {
+        vertices = scratch.allocate<Vertex>(4096 * 6);
+    }
+
+    /* Building the vertices is most of the cost of starting a game, and the
+        continents don't depend on each other. Uploads stay on this thread. */
+    Jobs::instance().parallelFor(4, 1, [&](size_t begin, size_t end) {
+        for (size_t continent = begin; continent < end; continent++) {
+            float texAdvX = 1.0f / (_texTilesets[0]->width / 50.0f);
+            float texAdvY = 1.0f / (_texTilesets[0]->height / 42.0f);
+
+            float pxOfsX = 1.0f / _texTilesets[0]->width;
+            float pxOfsY = 1.0f / _texTilesets[0]->height;
+
+            auto *vtx = continentVertices[continent];
+
+            for (int i = 0; i < 64; i++) {
+                for (int j = 0; j < 64; j++) {
+                    float l = i * 48.0f;
+                    float t = j * 40.0f;
+                    float r = (i + 1) * 48.0f;
+                    float b = (j + 1) * 40.0f;
+
+                    int tileId = _tiles[continent][j * 64 + i];
+                    int tileX = tileId % 16;
+                    int tileY = tileId / 16;
+
+                    float ua = tileX * texAdvX + pxOfsX;
+                    float ub = (tileX + 1) * texAdvX - pxOfsX;
+                    float va = tileY * texAdvY + pxOfsY;
+                    float vb = (tileY + 1) * texAdvY - pxOfsY;
+
+                    *vtx++ = {{l, t}, {ua, va}};
+                    *vtx++ = {{r, t}, {ub, va}};
+                    *vtx++ = {{l, b}, {ua, vb}};
+                    *vtx++ = {{r, t}, {ub, va}};
+                    *vtx++ = {{r, b}, {ub, vb}};
+                    *vtx++ = {{l, b}, {ua, vb}};
+                }
             }
         }
+    });
 
-        glNamedBufferSubData(_vbos[continent], 0, 4096 * 6 * sizeof(GLfloat) * 4, vertices.data());
+    for (int continent = 0; continent < 4; continent++) {
+        glNamedBufferSubData(_vbos[continent], 0, 4096 * 6 * sizeof(GLfloat) * 4, continentVertices[continent]);
+        GpuResources::instance().addUpload(4096 * 6 * sizeof(GLfloat) * 4);
+        GFX::instance().invalidateBuffer(_vbos[continent]);
+
+        updateLod(continent);
     }
 }
 
@@ -187,6 +260,8 @@ void Map::setTile(const Tile &tile, int continent, int id)
     }
 
     _tiles[continent][tile.tx + tile.ty * 64] = id;
+    _passability[continent].set(tile.tx, tile.ty, id);
+    _pathfinders[continent].patch(tile.tx, tile.ty);
 
     float texAdvX = 1.0f / (_texTilesets[0]->width / 50.0f);
     float texAdvY = 1.0f / (_texTilesets[0]->height / 42.0f);
@@ -222,6 +297,200 @@ void Map::setTile(const Tile &tile, int continent, int id)
     auto offset = (tile.ty + tile.tx * 64) * size;
 
     glNamedBufferSubData(_vbos[continent], offset, size, vertices);
+    GpuResources::instance().addUpload(size);
+    GFX::instance().invalidateBuffer(_vbos[continent]);
+
+    if (_lodTextures[continent] != GL_NONE && id < static_cast<int>(_tileColors.size())) {
+        glTextureSubImage2D(_lodTextures[continent], 0, tile.tx, tile.ty, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &_tileColors[id]);
+        GpuResources::instance().addUpload(sizeof(_tileColors[id]));
+        GFX::instance().invalidateTexture(_lodTextures[continent]);
+    }
+}
+
+TileSweep Map::sweep(const c2AABB &box, c2v delta, int continent, PassLayer layer, const Tile &ignore) const
+{
+    static constexpr float kTileW = 48.0f;
+    static constexpr float kTileH = 40.0f;
+    /* Kept between a box stopped moving right or down and the tile it hit,
+        so the box's max doesn't land in it. */
+    static constexpr float kGap = 0.01f;
+
+    TileSweep result {box, false, {-1, -1, -1}};
+    const auto &passability = _passability[continent];
+
+    const auto column = [](float x) {
+        return static_cast<int>(std::floor(x / kTileW));
+    };
+    const auto row = [](float y) {
+        return static_cast<int>(std::floor(y / kTileH));
+    };
+
+    /* Whether the box has to stop before entering tx, ty. */
+    const auto enter = [&](int tx, int ty) {
+        if (ignore.id != -1 && tx == ignore.tx && ty == ignore.ty) {
+            return false;
+        }
+        if (!passability.test(layer, tx, ty)) {
+            result.blocked = true;
+            result.blockedTile = getTile(tx, ty, continent);
+            return true;
+        }
+        return false;
+    };
+
+    const int stepX = delta.x > 0.0f ? 1 : (delta.x < 0.0f ? -1 : 0);
+    const int stepY = delta.y > 0.0f ? 1 : (delta.y < 0.0f ? -1 : 0);
+    int leadX = stepX > 0 ? column(box.max.x) : column(box.min.x);
+    int leadY = stepY > 0 ? row(box.max.y) : row(box.min.y);
+
+    constexpr float kNever = std::numeric_limits<float>::infinity();
+    c2v moved = delta;
+
+    /* Walk the leading edges from one tile boundary to the next, checking
+        the row or column of tiles entered at each. */
+    for (;;) {
+        float tX = kNever;
+        float tY = kNever;
+        if (stepX > 0) {
+            tX = ((leadX + 1) * kTileW - box.max.x) / delta.x;
+        }
+        else if (stepX < 0) {
+            tX = (leadX * kTileW - box.min.x) / delta.x;
+        }
+        if (stepY > 0) {
+            tY = ((leadY + 1) * kTileH - box.max.y) / delta.y;
+        }
+        else if (stepY < 0) {
+            tY = (leadY * kTileH - box.min.y) / delta.y;
+        }
+
+        const float t = std::min(tX, tY);
+        if (t > 1.0f) {
+            break;
+        }
+
+        bool stopped = false;
+        if (tX <= tY) {
+            leadX += stepX;
+            const int minRow = row(box.min.y + delta.y * t);
+            const int maxRow = row(box.max.y + delta.y * t);
+            for (int ty = minRow; ty <= maxRow && !stopped; ty++) {
+                stopped = enter(leadX, ty);
+            }
+            if (stopped) {
+                moved.x = stepX > 0 ? std::max(0.0f, leadX * kTileW - kGap - box.max.x) : std::min(0.0f, (leadX + 1) * kTileW - box.min.x);
+                moved.y = delta.y * t;
+            }
+        }
+        else {
+            leadY += stepY;
+            const int minColumn = column(box.min.x + delta.x * t);
+            const int maxColumn = column(box.max.x + delta.x * t);
+            for (int tx = minColumn; tx <= maxColumn && !stopped; tx++) {
+                stopped = enter(tx, leadY);
+            }
+            if (stopped) {
+                moved.x = delta.x * t;
+                moved.y = stepY > 0 ? std::max(0.0f, leadY * kTileH - kGap - box.max.y) : std::min(0.0f, (leadY + 1) * kTileH - box.min.y);
+            }
+        }
+
+        if (stopped) {
+            break;
+        }
+    }
+
+    result.box.min.x += moved.x;
+    result.box.max.x += moved.x;
+    result.box.min.y += moved.y;
+    result.box.max.y += moved.y;
+
+    return result;
+}
+
+void Map::createLod()
+{
+    const auto *tileset = _texTilesets[0];
+    if (!tileset) {
+        return;
+    }
+
+    /* Average each tile's 48x40 interior out of the first tileset frame. The
+        tileset is laid out as 16 columns of 50x42 cells with a 1px border. */
+    std::vector<uint8_t> pixels(tileset->width * tileset->height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTextureImage(tileset->handle, 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLsizei>(pixels.size()), pixels.data());
+
+    const int columns = tileset->width / 50;
+    const int rows = tileset->height / 42;
+
+    _tileColors.assign(columns * rows, 0);
+
+    for (int id = 0; id < columns * rows; id++) {
+        const int cellX = (id % 16) * 50 + 1;
+        const int cellY = (id / 16) * 42 + 1;
+
+        uint32_t sum[4] {0};
+        for (int y = cellY; y < cellY + 40; y++) {
+            const uint8_t *px = &pixels[(y * tileset->width + cellX) * 4];
+            for (int x = 0; x < 48; x++, px += 4) {
+                sum[0] += px[0];
+                sum[1] += px[1];
+                sum[2] += px[2];
+                sum[3] += px[3];
+            }
+        }
+
+        uint8_t *color = reinterpret_cast<uint8_t *>(&_tileColors[id]);
+        for (int c = 0; c < 4; c++) {
+            color[c] = static_cast<uint8_t>(sum[c] / (48 * 40));
+        }
+    }
+
+    auto &registry {GpuResources::instance()};
+
+    glCreateTextures(GL_TEXTURE_2D, 4, _lodTextures);
+    for (int i = 0; i < 4; i++) {
+        glTextureStorage2D(_lodTextures[i], 1, GL_RGBA8, 64, 64);
+        glTextureParameteri(_lodTextures[i], GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(_lodTextures[i], GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(_lodTextures[i], GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(_lodTextures[i], GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        registry.add(bty::GpuResourceType::Texture, _lodTextures[i], bty::GpuCategory::Map, 64 * 64 * 4);
+    }
+
+    /* clang-format off */
+    Vertex quad[6] = {
+        {{0.0f, 0.0f}, {0.0f, 0.0f}},
+        {{64 * 48.0f, 0.0f}, {1.0f, 0.0f}},
+        {{0.0f, 64 * 40.0f}, {0.0f, 1.0f}},
+        {{64 * 48.0f, 0.0f}, {1.0f, 0.0f}},
+        {{64 * 48.0f, 64 * 40.0f}, {1.0f, 1.0f}},
+        {{0.0f, 64 * 40.0f}, {0.0f, 1.0f}},
+    };
+    /* clang-format on */
+
+    glCreateBuffers(1, &_lodVbo);
+    glNamedBufferStorage(_lodVbo, sizeof(quad), quad, 0);
+
+    registry.add(bty::GpuResourceType::Buffer, _lodVbo, bty::GpuCategory::Map, sizeof(quad));
+}
+
+void Map::updateLod(int continent)
+{
+    if (_lodTextures[continent] == GL_NONE) {
+        return;
+    }
+
+    std::vector<uint32_t> pixels(4096);
+    for (int i = 0; i < 4096; i++) {
+        int id = _tiles[continent][i];
+        pixels[i] = id < static_cast<int>(_tileColors.size()) ? _tileColors[id] : 0;
+    }
+
+    glTextureSubImage2D(_lodTextures[continent], 0, 0, 0, 64, 64, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    GpuResources::instance().addUpload(pixels.size() * sizeof(pixels[0]));
+    GFX::instance().invalidateTexture(_lodTextures[continent]);
 }
 
 void Map::setContinent(int continent)
@@ -2,9 +2,14 @@
 #define BTY_GAME_MAP_HPP_
 
 #include <array>
+#include <cstdint>
 #include <glm/mat4x4.hpp>
 #include <vector>
 
+#include "engine/timer.hpp"
+#include "game/cute_c2.hpp"
+#include "game/passability.hpp"
+#include "game/pathfinder.hpp"
 #include "gfx/gl.hpp"
 
 namespace bty {
@@ -17,35 +22,65 @@ struct Tile {
     int id;
 };
 
+struct TileSweep {
+    /* Where the box got to: all the way, or up against blocked. */
+    c2AABB box;
+    bool blocked;
+    /* The first tile in the way. Event tiles block every layer but flying,
+        which doesn't trigger them, so this is also the event tile, if any. */
+    Tile blockedTile;
+};
+
 class Map {
 public:
+    Map();
     ~Map();
     void setContinent(int continent);
     void load();
-    void draw(const glm::mat4 &camera);
-    void update(float dt);
+    void draw(const glm::mat4 &camera, float zoom = 1.0f);
     Tile getTile(int tx, int ty, int continent) const;
     Tile getTile(float x, float y, int continent) const;
     Tile getTile(glm::vec2 pos, int continent) const;
     Tile getTile(glm::ivec2 coord, int continent) const;
+    /* Call createGeometry() after writing through this. */
     unsigned char *getTiles(int continent);
+    const Passability &getPassability(int continent) const;
+    Pathfinder &getPathfinder(int continent);
     void createGeometry();
     void reset();
     void setTile(const Tile &tile, int continent, int id);
+    /* Moves box by delta, stopping short of the first tile it can't cross
+        in layer, however far that is. Tiles are crossed one at a time, so
+        nothing thin can be skipped over at speed. A box counts as covering
+        the tiles under its min and max, inclusive; a zero-size box is a
+        point. ignore is crossed regardless, unless its id is -1. */
+    TileSweep sweep(const c2AABB &box, c2v delta, int continent, PassLayer layer, const Tile &ignore) const;
+
+private:
+    void nextTileset();
+    void createLod();
+    void updateLod(int continent);
 
 private:
     int _continent {0};
     int _numVerts {0};
     GLuint _vbos[4] {GL_NONE};
-    GLuint _vaos[4] {GL_NONE};
     GLuint _shader {GL_NONE};
     GLint _viewLoc {-1};
     GLint _texLoc {-1};
     const bty::Texture *_texTilesets[10] {nullptr};
-    float _tilesetAnimTimer {0};
+    bty::Timer _tilesetAnimTimer;
     int _curTilesetIndex {0};
     std::array<std::vector<unsigned char>, 4> _tiles;
     std::array<std::vector<unsigned char>, 4> _readOnlyTiles;
+    std::array<Passability, 4> _passability;
+    std::array<Pathfinder, 4> _pathfinders;
+
+    /* Far zoom levels draw each continent as one quad textured with a 64x64
+        map of average tile colours, instead of 4096 tile quads. */
+    std::vector<uint32_t> _tileColors;
+    GLuint _lodTextures[4] {GL_NONE};
+    GLuint _lodVbo {GL_NONE};
 };
 
 #endif    // BTY_GAME_MAP_HPP_
@@ -0,0 +1,103 @@
+#include "game/passability.hpp"
+
+#include <algorithm>
+
+#include "data/tiles.hpp"
+
+static constexpr uint8_t computePassMask(int id)
+{
+    uint8_t mask = 1 << PASS_FLY;
+
+    if (id <= Tile_GrassInFrontOfCastle || id == Tile_MobBlocker || id == Tile_BridgeHorizontal || id == Tile_BridgeVertical || (id >= Tile_SandELT && id <= Tile_Sand)) {
+        mask |= 1 << PASS_WALK;
+    }
+    if (id == Tile_BridgeHorizontal || id == Tile_BridgeVertical || id == Tile_WaterConnector || (id >= Tile_WaterIRT && id <= Tile_Water)) {
+        mask |= 1 << PASS_BOAT;
+    }
+    if (id == Tile_Grass) {
+        mask |= (1 << PASS_MOB) | (1 << PASS_LAND);
+    }
+
+    return mask;
+}
+
+static constexpr auto kPassMasks = []() {
+    std::array<uint8_t, 256> masks {};
+    for (int id = 0; id < 256; id++) {
+        masks[id] = computePassMask(id);
+    }
+    return masks;
+}();
+
+static constexpr uint8_t kOffMapMask = computePassMask(-1);
+
+uint8_t passMask(int id)
+{
+    return id < 0 ? kOffMapMask : kPassMasks[id & 0xFF];
+}
+
+void Passability::build(const unsigned char *tiles)
+{
+    _revision++;
+
+    for (auto &layer : _layers) {
+        layer.fill(0);
+    }
+
+    for (int y = 0; y < kSize; y++) {
+        for (int x = 0; x < kSize; x++) {
+            const auto mask = kPassMasks[tiles[x + y * kSize]];
+            for (int layer = 0; layer < PASS_LAYER_COUNT; layer++) {
+                _layers[layer][y] |= static_cast<uint64_t>((mask >> layer) & 1) << x;
+            }
+        }
+    }
+}
+
+void Passability::set(int x, int y, int id)
+{
+    if (x < 0 || x >= kSize || y < 0 || y >= kSize) {
+        return;
+    }
+
+    _revision++;
+
+    const auto mask = passMask(id);
+    const auto bit = uint64_t {1} << x;
+
+    for (int layer = 0; layer < PASS_LAYER_COUNT; layer++) {
+        if ((mask >> layer) & 1) {
+            _layers[layer][y] |= bit;
+        }
+        else {
+            _layers[layer][y] &= ~bit;
+        }
+    }
+}
+
+bool Passability::testRect(PassLayer layer, int minX, int minY, int maxX, int maxY) const
+{
+    /* Whatever hangs off the map is judged as off-map. */
+    if (minX < 0 || minY < 0 || maxX >= kSize || maxY >= kSize) {
+        if (!(kOffMapMask & (1 << layer))) {
+            return false;
+        }
+        minX = std::max(minX, 0);
+        minY = std::max(minY, 0);
+        maxX = std::min(maxX, kSize - 1);
+        maxY = std::min(maxY, kSize - 1);
+    }
+
+    if (minX > maxX || minY > maxY) {
+        return true;
+    }
+
+    const auto mask = (~uint64_t {0} >> (kSize - 1 - (maxX - minX))) << minX;
+    for (int y = minY; y <= maxY; y++) {
+        if ((_layers[layer][y] & mask) != mask) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef BTY_GAME_PASSABILITY_HPP_
+#define BTY_GAME_PASSABILITY_HPP_
+
+#include <array>
+#include <cstdint>
+
+enum PassLayer {
+    PASS_WALK,
+    PASS_BOAT,
+    PASS_FLY,
+    /* Wandering armies keep to grass. */
+    PASS_MOB,
+    /* Where flying can end. */
+    PASS_LAND,
+    PASS_LAYER_COUNT,
+};
+
+/* Layers a tile id can be crossed in, as bits of 1 << PassLayer. An id of -1
+    is off the map, which walking and flying allow. */
+uint8_t passMask(int id);
+
+/* One bit per tile and layer for a 64x64 continent, a row to a uint64_t,
+    so a layer is 512 bytes and a whole row can be tested at once. */
+class Passability {
+public:
+    static constexpr int kSize = 64;
+
+    void build(const unsigned char *tiles);
+    void set(int x, int y, int id);
+
+    bool test(PassLayer layer, int x, int y) const
+    {
+        if (x < 0 || x >= kSize || y < 0 || y >= kSize) {
+            return passMask(-1) & (1 << layer);
+        }
+        return (_layers[layer][y] >> x) & 1;
+    }
+
+    /* Bit x is set if tile (x, y) is passable. */
+    uint64_t row(PassLayer layer, int y) const
+    {
+        return _layers[layer][y];
+    }
+
+    /* Whether every tile in the inclusive rect is passable. */
+    bool testRect(PassLayer layer, int minX, int minY, int maxX, int maxY) const;
+
+    /* Goes up on every build() and set(), so anything derived from the
+        layers can tell it's stale. */
+    uint32_t getRevision() const
+    {
+        return _revision;
+    }
+
+private:
+    std::array<std::array<uint64_t, kSize>, PASS_LAYER_COUNT> _layers {};
+    uint32_t _revision {0};
+};
+
+#endif    // BTY_GAME_PASSABILITY_HPP_
@@ -0,0 +1,434 @@
+#include "game/pathfinder.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+#include "data/tiles.hpp"
+
+static constexpr glm::ivec2 kSteps[4] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+static bool inMap(glm::ivec2 tile)
+{
+    return tile.x >= 0 && tile.x < Pathfinder::kSize && tile.y >= 0 && tile.y < Pathfinder::kSize;
+}
+
+static int indexOf(glm::ivec2 tile)
+{
+    return tile.x + tile.y * Pathfinder::kSize;
+}
+
+static glm::ivec2 tileOf(int index)
+{
+    return {index % Pathfinder::kSize, index / Pathfinder::kSize};
+}
+
+static int heuristic(glm::ivec2 a, glm::ivec2 b)
+{
+    return (std::abs(a.x - b.x) + std::abs(a.y - b.y)) * Pathfinder::kStepCost;
+}
+
+void Pathfinder::build(const Passability *passability, const unsigned char *tiles)
+{
+    _passability = passability;
+    _tiles = tiles;
+
+    for (int layer = 0; layer < kLayers; layer++) {
+        auto &graph = _layers[layer];
+        graph.nodeAt.fill(-1);
+        for (auto &nodes : graph.clusters) {
+            nodes.clear();
+        }
+        for (int cluster = 0; cluster < kClusters * kClusters; cluster++) {
+            buildCluster(static_cast<PassLayer>(layer), cluster);
+        }
+    }
+}
+
+void Pathfinder::patch(int x, int y)
+{
+    if (!_passability || !inMap({x, y})) {
+        return;
+    }
+
+    /* The tile can only be on borders its own cluster shares, but the
+        neighbours on the other side of those have nodes there too. */
+    const int cluster = clusterOf({x, y});
+    const int cx = cluster % kClusters;
+    const int cy = cluster / kClusters;
+
+    for (int layer = 0; layer < kLayers; layer++) {
+        buildCluster(static_cast<PassLayer>(layer), cluster);
+        for (const auto &step : kSteps) {
+            if (cx + step.x >= 0 && cx + step.x < kClusters && cy + step.y >= 0 && cy + step.y < kClusters) {
+                buildCluster(static_cast<PassLayer>(layer), cluster + step.x + step.y * kClusters);
+            }
+        }
+    }
+}
+
+bool Pathfinder::find(PassLayer layer, glm::ivec2 from, glm::ivec2 to, std::vector<glm::ivec2> &path)
+{
+    path.clear();
+
+    if (!_passability || layer >= kLayers || !inMap(from) || !inMap(to)) {
+        return false;
+    }
+    if (from == to) {
+        return true;
+    }
+
+    int totalCost = 0;
+    if (passable(layer, from)) {
+        return route(layer, from, to, path, totalCost);
+    }
+
+    /* Standing somewhere closed, e.g. in a town's doorway; the graph only
+        knows open tiles, so leave through whichever neighbour is best. */
+    int bestCost = -1;
+    for (const auto &step : kSteps) {
+        const auto exit = from + step;
+        if (!inMap(exit) || !passable(layer, exit)) {
+            continue;
+        }
+        if (!route(layer, exit, to, _candidate, totalCost)) {
+            continue;
+        }
+        totalCost += cost(layer, exit);
+        if (bestCost == -1 || totalCost < bestCost) {
+            bestCost = totalCost;
+            path.assign(1, exit);
+            path.insert(path.end(), _candidate.begin(), _candidate.end());
+        }
+    }
+
+    return bestCost != -1;
+}
+
+bool Pathfinder::route(PassLayer layer, glm::ivec2 from, glm::ivec2 to, std::vector<glm::ivec2> &path, int &totalCost)
+{
+    path.clear();
+    totalCost = 0;
+
+    if (from == to) {
+        return true;
+    }
+    if (passable(layer, to)) {
+        return search(layer, from, to, path, totalCost);
+    }
+
+    /* Head for whichever open tile next to it is cheapest to reach, then
+        step in. */
+    int bestCost = -1;
+    for (const auto &step : kSteps) {
+        const auto approach = to + step;
+        if (!inMap(approach) || !passable(layer, approach)) {
+            continue;
+        }
+
+        int approachCost = 0;
+        if (approach != from && !search(layer, from, approach, _approach, approachCost)) {
+            continue;
+        }
+        if (approach == from) {
+            _approach.clear();
+        }
+        if (bestCost == -1 || approachCost < bestCost) {
+            bestCost = approachCost;
+            std::swap(path, _approach);
+        }
+    }
+
+    if (bestCost == -1) {
+        path.clear();
+        return false;
+    }
+
+    path.push_back(to);
+    totalCost = bestCost + cost(layer, to);
+    return true;
+}
+
+int Pathfinder::clusterOf(glm::ivec2 tile)
+{
+    return tile.x / kClusterTiles + (tile.y / kClusterTiles) * kClusters;
+}
+
+bool Pathfinder::passable(PassLayer layer, glm::ivec2 tile) const
+{
+    return _passability->test(layer, tile.x, tile.y);
+}
+
+int Pathfinder::cost(PassLayer layer, glm::ivec2 tile) const
+{
+    if (layer == PASS_WALK) {
+        const int id = _tiles[indexOf(tile)];
+        if (id >= Tile_SandELT && id <= Tile_Sand) {
+            return kSandStepCost;
+        }
+    }
+    return kStepCost;
+}
+
+void Pathfinder::buildCluster(PassLayer layer, int cluster)
+{
+    auto &graph = _layers[layer];
+    auto &nodes = graph.clusters[cluster];
+
+    for (const auto &node : nodes) {
+        graph.nodeAt[indexOf(node.tile)] = -1;
+    }
+    nodes.clear();
+
+    const int cx = cluster % kClusters;
+    const int cy = cluster / kClusters;
+    const glm::ivec2 origin {cx * kClusterTiles, cy * kClusterTiles};
+    const int last = kClusterTiles - 1;
+
+    /* Both clusters on a border walk it in the same direction, so they
+        agree on where its nodes go. */
+    if (cy > 0) {
+        scanBorder(layer, cluster, origin, origin + glm::ivec2 {0, -1}, {1, 0});
+    }
+    if (cx < kClusters - 1) {
+        scanBorder(layer, cluster, origin + glm::ivec2 {last, 0}, origin + glm::ivec2 {last + 1, 0}, {0, 1});
+    }
+    if (cy < kClusters - 1) {
+        scanBorder(layer, cluster, origin + glm::ivec2 {0, last}, origin + glm::ivec2 {0, last + 1}, {1, 0});
+    }
+    if (cx > 0) {
+        scanBorder(layer, cluster, origin, origin + glm::ivec2 {-1, 0}, {0, 1});
+    }
+
+    for (auto &node : nodes) {
+        flood(layer, cluster, node.tile, false);
+        for (int i = 0; i < static_cast<int>(nodes.size()); i++) {
+            const int distance = floodDistance(nodes[i].tile);
+            if (nodes[i].tile != node.tile && distance != -1) {
+                node.edges.push_back({i, distance});
+            }
+        }
+    }
+}
+
+void Pathfinder::scanBorder(PassLayer layer, int cluster, glm::ivec2 inside, glm::ivec2 outside, glm::ivec2 step)
+{
+    int runStart = -1;
+
+    for (int i = 0; i <= kClusterTiles; i++) {
+        const bool open = i < kClusterTiles && passable(layer, inside + step * i) && passable(layer, outside + step * i);
+
+        if (open && runStart == -1) {
+            runStart = i;
+        }
+        else if (!open && runStart != -1) {
+            const int runEnd = i - 1;
+            if (runEnd - runStart + 1 >= kSplitOpening) {
+                addNode(layer, cluster, inside + step * runStart);
+                addNode(layer, cluster, inside + step * runEnd);
+            }
+            else {
+                addNode(layer, cluster, inside + step * ((runStart + runEnd) / 2));
+            }
+            runStart = -1;
+        }
+    }
+}
+
+void Pathfinder::addNode(PassLayer layer, int cluster, glm::ivec2 tile)
+{
+    auto &graph = _layers[layer];
+    auto &nodes = graph.clusters[cluster];
+
+    if (graph.nodeAt[indexOf(tile)] != -1 || nodes.size() >= kMaxClusterNodes) {
+        return;
+    }
+
+    graph.nodeAt[indexOf(tile)] = static_cast<int8_t>(nodes.size());
+    nodes.push_back({tile, {}});
+}
+
+void Pathfinder::flood(PassLayer layer, int cluster, glm::ivec2 from, bool reverse)
+{
+    _floodGen++;
+    _open.clear();
+
+    const glm::ivec2 min {(cluster % kClusters) * kClusterTiles, (cluster / kClusters) * kClusterTiles};
+    const glm::ivec2 max {min.x + kClusterTiles - 1, min.y + kClusterTiles - 1};
+
+    const int start = indexOf(from);
+    _floodSeen[start] = _floodGen;
+    _floodDist[start] = 0;
+    _floodPrev[start] = -1;
+    _open.push_back({0, start});
+
+    /* from itself is expanded even if it's closed; the hero can be standing
+        in a town's doorway. */
+    while (!_open.empty()) {
+        std::pop_heap(_open.begin(), _open.end(), std::greater<> {});
+        const auto [distance, current] = _open.back();
+        _open.pop_back();
+
+        if (distance > _floodDist[current]) {
+            continue;
+        }
+
+        const auto tile = tileOf(current);
+        for (const auto &step : kSteps) {
+            const auto next = tile + step;
+            if (next.x < min.x || next.x > max.x || next.y < min.y || next.y > max.y || !passable(layer, next)) {
+                continue;
+            }
+
+            const int index = indexOf(next);
+            const int nextDistance = distance + cost(layer, reverse ? tile : next);
+            if (_floodSeen[index] != _floodGen || nextDistance < _floodDist[index]) {
+                _floodSeen[index] = _floodGen;
+                _floodDist[index] = nextDistance;
+                _floodPrev[index] = static_cast<int16_t>(current);
+                _open.push_back({nextDistance, index});
+                std::push_heap(_open.begin(), _open.end(), std::greater<> {});
+            }
+        }
+    }
+}
+
+int Pathfinder::floodDistance(glm::ivec2 tile) const
+{
+    const int index = indexOf(tile);
+    return _floodSeen[index] == _floodGen ? _floodDist[index] : -1;
+}
+
+void Pathfinder::appendFlooded(glm::ivec2 tile, std::vector<glm::ivec2> &path) const
+{
+    const auto first = path.size();
+    for (int index = indexOf(tile); _floodPrev[index] != -1; index = _floodPrev[index]) {
+        path.push_back(tileOf(index));
+    }
+    std::reverse(path.begin() + first, path.end());
+}
+
+glm::ivec2 Pathfinder::abstractTile(PassLayer layer, int id, glm::ivec2 from, glm::ivec2 to) const
+{
+    if (id == kStartNode) {
+        return from;
+    }
+    if (id == kGoalNode) {
+        return to;
+    }
+    return _layers[layer].clusters[id / kMaxClusterNodes][id % kMaxClusterNodes].tile;
+}
+
+bool Pathfinder::search(PassLayer layer, glm::ivec2 from, glm::ivec2 to, std::vector<glm::ivec2> &path, int &totalCost)
+{
+    const auto &graph = _layers[layer];
+    const int startCluster = clusterOf(from);
+    const int goalCluster = clusterOf(to);
+    const auto &startNodes = graph.clusters[startCluster];
+    const auto &goalNodes = graph.clusters[goalCluster];
+
+    path.clear();
+
+    /* What from costs to reach each node of its cluster, and each node of
+        the goal's cluster costs to reach to. */
+    flood(layer, startCluster, from, false);
+    for (int i = 0; i < static_cast<int>(startNodes.size()); i++) {
+        _startCosts[i] = floodDistance(startNodes[i].tile);
+    }
+    const int direct = startCluster == goalCluster ? floodDistance(to) : -1;
+
+    flood(layer, goalCluster, to, true);
+    for (int i = 0; i < static_cast<int>(goalNodes.size()); i++) {
+        _goalCosts[i] = floodDistance(goalNodes[i].tile);
+    }
+
+    _searchGen++;
+    _open.clear();
+
+    const auto visit = [&](int id, int parent, int costSoFar) {
+        if (_searchSeen[id] == _searchGen && _searchCost[id] <= costSoFar) {
+            return;
+        }
+        _searchSeen[id] = _searchGen;
+        _searchCost[id] = costSoFar;
+        _searchParent[id] = parent;
+        _open.push_back({costSoFar + heuristic(abstractTile(layer, id, from, to), to), id});
+        std::push_heap(_open.begin(), _open.end(), std::greater<> {});
+    };
+
+    visit(kStartNode, -1, 0);
+
+    while (!_open.empty()) {
+        std::pop_heap(_open.begin(), _open.end(), std::greater<> {});
+        const auto [estimate, current] = _open.back();
+        _open.pop_back();
+
+        const int costSoFar = _searchCost[current];
+        if (estimate != costSoFar + heuristic(abstractTile(layer, current, from, to), to)) {
+            continue;
+        }
+        if (current == kGoalNode) {
+            break;
+        }
+
+        if (current == kStartNode) {
+            if (direct != -1) {
+                visit(kGoalNode, current, direct);
+            }
+            for (int i = 0; i < static_cast<int>(startNodes.size()); i++) {
+                if (_startCosts[i] != -1) {
+                    visit(startCluster * kMaxClusterNodes + i, current, _startCosts[i]);
+                }
+            }
+            continue;
+        }
+
+        const int cluster = current / kMaxClusterNodes;
+        const auto &node = graph.clusters[cluster][current % kMaxClusterNodes];
+
+        for (const auto &edge : node.edges) {
+            visit(cluster * kMaxClusterNodes + edge.to, current, costSoFar + edge.cost);
+        }
+        for (const auto &step : kSteps) {
+            const auto next = node.tile + step;
+            if (!inMap(next) || clusterOf(next) == cluster || graph.nodeAt[indexOf(next)] == -1) {
+                continue;
+            }
+            visit(clusterOf(next) * kMaxClusterNodes + graph.nodeAt[indexOf(next)], current, costSoFar + cost(layer, next));
+        }
+        if (cluster == goalCluster && _goalCosts[current % kMaxClusterNodes] != -1) {
+            visit(kGoalNode, current, costSoFar + _goalCosts[current % kMaxClusterNodes]);
+        }
+    }
+
+    if (_searchSeen[kGoalNode] != _searchGen) {
+        return false;
+    }
+
+    totalCost = _searchCost[kGoalNode];
+
+    _abstractPath.clear();
+    for (int id = kGoalNode; id != -1; id = _searchParent[id]) {
+        _abstractPath.push_back(id);
+    }
+    std::reverse(_abstractPath.begin(), _abstractPath.end());
+
+    /* Fill in each hop: neighbouring clusters are a single step apart,
+        anything else is a walk across one cluster. */
+    for (size_t i = 1; i < _abstractPath.size(); i++) {
+        const auto a = abstractTile(layer, _abstractPath[i - 1], from, to);
+        const auto b = abstractTile(layer, _abstractPath[i], from, to);
+        if (a == b) {
+            continue;
+        }
+        if (clusterOf(a) != clusterOf(b)) {
+            path.push_back(b);
+        }
+        else {
+            flood(layer, clusterOf(a), a, false);
+            appendFlooded(b, path);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,109 @@
+#ifndef BTY_GAME_PATHFINDER_HPP_
+#define BTY_GAME_PATHFINDER_HPP_
+
+#include <array>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <utility>
+#include <vector>
+
+#include "game/passability.hpp"
+
+/* Hierarchical A* over one continent, for walking, sailing and flying.
+
+    The continent is cut into 8x8 clusters. Wherever two clusters meet
+    across open tiles there is a node on each side, and each cluster knows
+    what its own nodes cost to go between. A route is found over those
+    nodes first and then filled in one cluster at a time, so a search only
+    ever floods a cluster or two of actual tiles.
+
+    Costs are per tile entered, with sand as slow as moveHero makes it. */
+class Pathfinder {
+public:
+    static constexpr int kSize = 64;
+    static constexpr int kClusterTiles = 8;
+    static constexpr int kClusters = kSize / kClusterTiles;
+    static constexpr int kStepCost = 10;
+    static constexpr int kSandStepCost = 17;
+
+    /* Both stay owned by the Map and must outlive this. */
+    void build(const Passability *passability, const unsigned char *tiles);
+    /* Call once tile x, y and its passability have changed. */
+    void patch(int x, int y);
+
+    /* The tiles to step onto, in order, to get from one tile to another,
+        ending with to. to may itself be impassable, e.g. a town, as long
+        as it can be stepped into from a tile that isn't. Only PASS_WALK,
+        PASS_BOAT and PASS_FLY have routes. */
+    bool find(PassLayer layer, glm::ivec2 from, glm::ivec2 to, std::vector<glm::ivec2> &path);
+
+private:
+    static constexpr int kLayers = PASS_FLY + 1;
+    static constexpr int kMaxClusterNodes = 16;
+    /* Openings at least this wide get a node at each end instead of one
+        in the middle. */
+    static constexpr int kSplitOpening = 6;
+    static constexpr int kNumAbstract = kClusters * kClusters * kMaxClusterNodes + 2;
+    static constexpr int kStartNode = kNumAbstract - 2;
+    static constexpr int kGoalNode = kNumAbstract - 1;
+
+    struct Edge {
+        int to;
+        int cost;
+    };
+
+    struct Node {
+        glm::ivec2 tile;
+        /* To other nodes in the same cluster. */
+        std::vector<Edge> edges;
+    };
+
+    struct Layer {
+        std::array<std::vector<Node>, kClusters * kClusters> clusters;
+        /* The tile's node in its cluster, or -1. */
+        std::array<int8_t, kSize * kSize> nodeAt;
+    };
+
+    static int clusterOf(glm::ivec2 tile);
+    bool passable(PassLayer layer, glm::ivec2 tile) const;
+    int cost(PassLayer layer, glm::ivec2 tile) const;
+
+    void buildCluster(PassLayer layer, int cluster);
+    void scanBorder(PassLayer layer, int cluster, glm::ivec2 inside, glm::ivec2 outside, glm::ivec2 step);
+    void addNode(PassLayer layer, int cluster, glm::ivec2 tile);
+
+    /* Dijkstra over one cluster's tiles. Reversed, the distances are to
+        from instead of from it. */
+    void flood(PassLayer layer, int cluster, glm::ivec2 from, bool reverse);
+    int floodDistance(glm::ivec2 tile) const;
+    /* Appends the flooded route to tile, not including where it started. */
+    void appendFlooded(glm::ivec2 tile, std::vector<glm::ivec2> &path) const;
+
+    /* find() once from is known to be open. */
+    bool route(PassLayer layer, glm::ivec2 from, glm::ivec2 to, std::vector<glm::ivec2> &path, int &totalCost);
+    bool search(PassLayer layer, glm::ivec2 from, glm::ivec2 to, std::vector<glm::ivec2> &path, int &totalCost);
+    glm::ivec2 abstractTile(PassLayer layer, int id, glm::ivec2 from, glm::ivec2 to) const;
+
+private:
+    const Passability *_passability {nullptr};
+    const unsigned char *_tiles {nullptr};
+    std::array<Layer, kLayers> _layers;
+
+    /* Search scratch, reused so finding a route doesn't allocate once warm. */
+    std::vector<std::pair<int, int>> _open;
+    uint32_t _floodGen {0};
+    std::array<uint32_t, kSize * kSize> _floodSeen {};
+    std::array<int, kSize * kSize> _floodDist {};
+    std::array<int16_t, kSize * kSize> _floodPrev {};
+    uint32_t _searchGen {0};
+    std::array<uint32_t, kNumAbstract> _searchSeen {};
+    std::array<int, kNumAbstract> _searchCost {};
+    std::array<int, kNumAbstract> _searchParent {};
+    std::array<int, kMaxClusterNodes> _startCosts {};
+    std::array<int, kMaxClusterNodes> _goalCosts {};
+    std::vector<int> _abstractPath;
+    std::vector<glm::ivec2> _candidate;
+    std::vector<glm::ivec2> _approach;
+};
+
+#endif    // BTY_GAME_PATHFINDER_HPP_
@@ -22,11 +22,19 @@ void SaveManager::load()
     _dlgLoading.addString(1, 1, "Loading...");
 }
 
+bool SaveManager::isPersistent() const
+{
+    return true;
+}
+
 void SaveManager::enter()
 {
     _dlgLoading.setColor(bty::getBoxColor(State::difficulty));
     _waitingForSaves = true;
-    _savesFuture = std::async(&SaveManager::getSaves, this);
+    auto listSaves = [this]() {
+        _saves = getSaves();
+    };
+    Jobs::instance().submit(listSaves, &_savesJob);
 }
 
 void SaveManager::renderLate()
@@ -108,7 +116,7 @@ void SaveManager::setMode(bool toLoad)
 
 void SaveManager::show()
 {
-    auto sf = _savesFuture.get();
+    const auto sf = _saves;
 
     if (sf.failed) {
         _engine.getGUI().showMessage(10, 12, 12, 4, "Failed to\nread saves");
@@ -168,7 +176,7 @@ bool SaveManager::isOverlay() const
 void SaveManager::update(float dt)
 {
     if (_waitingForSaves) {
-        if (_savesFuture._Is_ready()) {
+        if (_savesJob.done()) {
             _waitingForSaves = false;
             show();
         }
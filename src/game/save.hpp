@@ -2,10 +2,10 @@
 #define BTY_GAME_SAVE_HPP_
 
 #include <functional>
-#include <future>
 
 #include "engine/component.hpp"
 #include "engine/dialog.hpp"
+#include "engine/job-system.hpp"
 
 namespace bty {
 class Engine;
@@ -28,6 +28,7 @@ public:
     SaveManager(bty::Engine &engine);
 
     void load() override;
+    bool isPersistent() const override;
     void enter() override;
     void renderLate() override;
     void update(float dt) override;
@@ -47,7 +48,8 @@ private:
 private:
     bty::Engine &_engine;
     bty::Dialog _dlgLoading;
-    std::future<SavesFuture> _savesFuture;
+    SavesFuture _saves;
+    bty::JobCounter _savesJob;
     bool _waitingForSaves {false};
     bool _modeIsLoading {false};
     std::function<void(const std::string &)> _loadCallback {nullptr};
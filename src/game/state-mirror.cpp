@@ -0,0 +1,129 @@
+#include "game/state-mirror.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <new>
+
+#include "game/state.hpp"
+
+template <typename T, size_t N, typename U>
+static void copyArray(T (&dst)[N], const U &src)
+{
+    static_assert(N == std::tuple_size_v<U>);
+    std::copy(src.begin(), src.end(), dst);
+}
+
+bool StateMirror::init(const std::string &name)
+{
+    deinit();
+
+    if (!_memory.create(name, kStateMirrorHeaderSize + sizeof(StateSnapshot))) {
+        return false;
+    }
+
+    auto *base = static_cast<std::byte *>(_memory.data());
+    _header = new (base) StateMirrorHeader {};
+    _snapshot = new (base + kStateMirrorHeaderSize) StateSnapshot {};
+
+    _header->version = kStateSnapshotVersion;
+    _header->headerSize = kStateMirrorHeaderSize;
+    _header->snapshotSize = sizeof(StateSnapshot);
+    /* Written last, so a reader seeing the magic sees the rest. */
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(_header->magic, "BTYS", 4);
+
+    spdlog::info("StateMirror: publishing {} bytes to '{}'", sizeof(StateSnapshot), name);
+    return true;
+}
+
+void StateMirror::deinit()
+{
+    _memory.close();
+    _header = nullptr;
+    _snapshot = nullptr;
+}
+
+void StateMirror::publish()
+{
+    _tick++;
+
+    if (!_header) {
+        return;
+    }
+
+    const auto seq = _header->seq.load(std::memory_order_relaxed);
+    _header->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    fill(*_snapshot);
+
+    _header->seq.store(seq + 2, std::memory_order_release);
+}
+
+void StateMirror::resetTick()
+{
+    _tick = 0;
+}
+
+void StateMirror::fill(StateSnapshot &snapshot) const
+{
+    snapshot.tick = _tick;
+
+    snapshot.hero = State::hero;
+    snapshot.rank = State::rank;
+    snapshot.difficulty = State::difficulty;
+    snapshot.contract = State::contract;
+    snapshot.continent = State::continent;
+    snapshot.score = State::score;
+    snapshot.gold = State::gold;
+    snapshot.leadership = State::leadership;
+    snapshot.permanentLeadership = State::permanent_leadership;
+    snapshot.commission = State::commission;
+    snapshot.spellPower = State::spell_power;
+    snapshot.knownSpells = State::known_spells;
+    snapshot.maxSpells = State::max_spells;
+    snapshot.followersKilled = State::followers_killed;
+    snapshot.days = State::days;
+    snapshot.weeksPassed = State::weeks_passed;
+    snapshot.daysPassedThisWeek = State::days_passed_this_week;
+    snapshot.timestop = State::timestop;
+    snapshot.x = State::x;
+    snapshot.y = State::y;
+    snapshot.boatX = State::boat_x;
+    snapshot.boatY = State::boat_y;
+    snapshot.boatContinent = State::boat_c;
+
+    snapshot.magic = State::magic;
+    snapshot.siege = State::siege;
+    snapshot.boatRented = State::boat_rented;
+    snapshot.autoMove = State::auto_move;
+
+    copyArray(snapshot.army, State::army);
+    copyArray(snapshot.counts, State::counts);
+    copyArray(snapshot.morales, State::morales);
+    copyArray(snapshot.spells, State::spells);
+    copyArray(snapshot.castleOccupants, State::castle_occupants);
+
+    copyArray(snapshot.villainsFound, State::villains_found);
+    copyArray(snapshot.villainsCaptured, State::villains_captured);
+    copyArray(snapshot.artifactsFound, State::artifacts_found);
+    copyArray(snapshot.sailMapsFound, State::sail_maps_found);
+    copyArray(snapshot.continentMapsFound, State::continent_maps_found);
+    copyArray(snapshot.visitedCastles, State::visited_castles);
+
+    for (int continent = 0; continent < 4; continent++) {
+        for (int i = 0; i < 40; i++) {
+            const auto &mob = State::mobs[continent][i];
+            auto &out = snapshot.mobs[continent][i];
+            out.tileX = mob.tile.x;
+            out.tileY = mob.tile.y;
+            out.id = mob.id;
+            copyArray(out.army, mob.army);
+            copyArray(out.counts, mob.counts);
+            out.dead = mob.dead;
+        }
+
+        copyArray(snapshot.fog[continent], State::fog[continent].getRows());
+    }
+}
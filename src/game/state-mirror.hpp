@@ -0,0 +1,144 @@
+#ifndef BTY_GAME_STATE_MIRROR_HPP_
+#define BTY_GAME_STATE_MIRROR_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "engine/shared-memory.hpp"
+#include "engine/singleton.hpp"
+
+/* Shared memory layout, read by tools outside the game, so this header
+    doesn't pull in any of the game. Fields are only ever appended; anything
+    else bumps kStateSnapshotVersion. */
+
+inline constexpr uint32_t kStateSnapshotVersion = 2;
+
+struct StateSnapshotMob {
+    int32_t tileX;
+    int32_t tileY;
+    int32_t id;
+    int32_t army[5];
+    int32_t counts[5];
+    uint8_t dead;
+    uint8_t reserved[3];
+};
+
+struct StateSnapshot {
+    /* Simulation steps since the game was generated or loaded. */
+    uint64_t tick;
+
+    int32_t hero;
+    int32_t rank;
+    int32_t difficulty;
+    int32_t contract;
+    int32_t continent;
+    int32_t score;
+    int32_t gold;
+    int32_t leadership;
+    int32_t permanentLeadership;
+    int32_t commission;
+    int32_t spellPower;
+    int32_t knownSpells;
+    int32_t maxSpells;
+    int32_t followersKilled;
+    int32_t days;
+    int32_t weeksPassed;
+    int32_t daysPassedThisWeek;
+    int32_t timestop;
+    int32_t x;
+    int32_t y;
+    int32_t boatX;
+    int32_t boatY;
+    int32_t boatContinent;
+
+    uint8_t magic;
+    uint8_t siege;
+    uint8_t boatRented;
+    uint8_t autoMove;
+
+    int32_t army[5];
+    int32_t counts[5];
+    int32_t morales[5];
+    int32_t spells[14];
+    int32_t castleOccupants[26];
+
+    uint8_t villainsFound[17];
+    uint8_t villainsCaptured[17];
+    uint8_t artifactsFound[8];
+    uint8_t sailMapsFound[4];
+    uint8_t continentMapsFound[4];
+    uint8_t visitedCastles[26];
+
+    StateSnapshotMob mobs[4][40];
+    /* Bit x of row y is set once tile x, y has been seen, as in
+        State::fog. Version 1 had a tile id per tile here instead. */
+    uint64_t fog[4][64];
+};
+
+/* At the start of the shared memory, followed by the snapshot at
+    headerSize. seq is odd while the game is writing; a reader loads it
+    (acquire), skips if odd, reads the snapshot, issues an acquire fence
+    and loads it again. If both loads match the read was consistent,
+    otherwise it retries. readStateSnapshot() below does exactly that. */
+struct StateMirrorHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t snapshotSize;
+    std::atomic<uint32_t> seq;
+    uint32_t reserved;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+inline constexpr uint32_t kStateMirrorHeaderSize = 64;
+
+static_assert(sizeof(StateMirrorHeader) <= kStateMirrorHeaderSize);
+
+inline bool readStateSnapshot(const void *mapping, StateSnapshot &out)
+{
+    const auto *header = static_cast<const StateMirrorHeader *>(mapping);
+    const auto *snapshot = reinterpret_cast<const std::byte *>(mapping) + header->headerSize;
+
+    for (int attempt = 0; attempt < 64; attempt++) {
+        const auto before = header->seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        std::memcpy(&out, snapshot, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->seq.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Publishes State to shared memory once per simulation step, for map
+    viewers, analytics and bots. The snapshot is filled in place under a
+    seqlock, so readers never hold up the game and the game never waits on
+    them. */
+class StateMirror {
+public:
+    bool init(const std::string &name);
+    void deinit();
+    void publish();
+    /* For a new or loaded game. */
+    void resetTick();
+
+private:
+    void fill(StateSnapshot &snapshot) const;
+
+private:
+    bty::SharedMemory _memory;
+    StateMirrorHeader *_header {nullptr};
+    StateSnapshot *_snapshot {nullptr};
+    uint64_t _tick {0};
+};
+
+using SharedState = bty::SingletonProvider<StateMirror>;
+
+#endif    // BTY_GAME_STATE_MIRROR_HPP_
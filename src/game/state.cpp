@@ -26,7 +26,7 @@ bool State::boat_rented;
 bool State::combat;
 std::array<bool, 26> State::visited_castles;
 std::array<int, 14> State::spells;
-std::array<std::vector<unsigned char>, 4> State::visited_tiles;
+std::array<Fog, 4> State::fog;
 std::array<int, 5> State::army;
 std::array<int, 5> State::counts;
 std::array<int, 5> State::morales;
@@ -5,6 +5,7 @@
 #include <glm/vec2.hpp>
 #include <vector>
 
+#include "game/fog.hpp"
 #include "game/mob.hpp"
 #include "game/shop-info.hpp"
 #include "game/town-gen.hpp"
@@ -37,7 +38,7 @@ public:
     static bool combat;
     static std::array<bool, 26> visited_castles;
     static std::array<int, 14> spells;
-    static std::array<std::vector<unsigned char>, 4> visited_tiles;
+    static std::array<Fog, 4> fog;
     static std::array<int, 5> army;
     static std::array<int, 5> counts;
     static std::array<int, 5> morales;
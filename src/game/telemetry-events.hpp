@@ -0,0 +1,80 @@
+#ifndef BTY_GAME_TELEMETRY_EVENTS_HPP_
+#define BTY_GAME_TELEMETRY_EVENTS_HPP_
+
+#include <cstdint>
+
+/* Payloads for bty::TelemetryRecord. Their layout is the file format: add
+    fields at the end, never reuse a type, and bump TelemetryStream::kVersion
+    when an existing event changes. Padding is spelled out as reserved bytes
+    so none of it is left uninitialised in the file. */
+
+enum TelemetryEventType : uint16_t {
+    TELEMETRY_DAY = 1,
+    TELEMETRY_BATTLE = 2,
+    TELEMETRY_WEEK_BUDGET = 3,
+    TELEMETRY_VILLAIN_CAPTURED = 4,
+    TELEMETRY_GAME_OVER = 5,
+};
+
+/* Once a day, for gold over time. */
+struct TelemetryDay {
+    static constexpr uint16_t kType = TELEMETRY_DAY;
+    int32_t daysLeft;
+    int32_t gold;
+    int32_t weeksPassed;
+    int32_t continent;
+    int32_t followersKilled;
+};
+
+static_assert(sizeof(TelemetryDay) == 20);
+
+struct TelemetryBattle {
+    static constexpr uint16_t kType = TELEMETRY_BATTLE;
+    /* Castle id when a siege, otherwise the mob's. */
+    int32_t id;
+    int32_t followersKilled;
+    int32_t gold;
+    int32_t daysLeft;
+    uint8_t siege;
+    uint8_t won;
+    uint8_t reserved[2];
+};
+
+static_assert(sizeof(TelemetryBattle) == 20);
+
+/* The result of endWeekBudget. */
+struct TelemetryWeekBudget {
+    static constexpr uint16_t kType = TELEMETRY_WEEK_BUDGET;
+    int32_t week;
+    int32_t commission;
+    int32_t boat;
+    int32_t armyCost;
+    int32_t balance;
+    uint8_t outOfGold;
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(TelemetryWeekBudget) == 24);
+
+struct TelemetryVillainCaptured {
+    static constexpr uint16_t kType = TELEMETRY_VILLAIN_CAPTURED;
+    int32_t villain;
+    int32_t daysLeft;
+    int32_t numCaptured;
+};
+
+static_assert(sizeof(TelemetryVillainCaptured) == 12);
+
+struct TelemetryGameOver {
+    static constexpr uint16_t kType = TELEMETRY_GAME_OVER;
+    int32_t daysLeft;
+    int32_t gold;
+    int32_t followersKilled;
+    int32_t score;
+    uint8_t won;
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(TelemetryGameOver) == 20);
+
+#endif    // BTY_GAME_TELEMETRY_EVENTS_HPP_
@@ -0,0 +1,12 @@
+#ifndef BTY_GAME_TIMER_GROUPS_HPP_
+#define BTY_GAME_TIMER_GROUPS_HPP_
+
+enum TimerGroups {
+    TIMER_GROUP_NONE = 0,
+    /* Paused whenever the overworld isn't the current scene. */
+    TIMER_GROUP_OVERWORLD = 1 << 0,
+    /* The day clock, which also stops for menus, dialogs and time stop. */
+    TIMER_GROUP_CALENDAR = 1 << 1,
+};
+
+#endif    // BTY_GAME_TIMER_GROUPS_HPP_
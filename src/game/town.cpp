@@ -50,6 +50,13 @@ void Town::load()
     _btOccupierArmy = _dlgOccupier.addString(1, 3);
 }
 
+std::vector<std::string> Town::getAssets() const
+{
+    return {
+        "bg/town.png",
+    };
+}
+
 void Town::render()
 {
     GFX::instance().drawSprite(_spBg);
@@ -17,6 +17,7 @@ public:
     Town(bty::Engine &engine);
 
     void load() override;
+    std::vector<std::string> getAssets() const override;
     void enter() override;
     void render() override;
     void update(float dt) override;
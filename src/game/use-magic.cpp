@@ -65,6 +65,11 @@ void UseMagic::load()
     }
 }
 
+bool UseMagic::isPersistent() const
+{
+    return true;
+}
+
 void UseMagic::bindSpell(int id, std::function<void()> callback)
 {
     _callbacks[id] = callback;
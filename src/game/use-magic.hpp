@@ -15,6 +15,7 @@ class UseMagic : public Component {
 public:
     UseMagic(bty::Engine &engine);
     void load() override;
+    bool isPersistent() const override;
     void enter() override;
     void bindSpell(int id, std::function<void()> callback);
     bool isOverlay() const override;
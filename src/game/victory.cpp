@@ -68,6 +68,15 @@ void Victory::load()
     _btName = _message.addString(1, 2);
 }
 
+std::vector<std::string> Victory::getAssets() const
+{
+    return {
+        "battle/encounter.png",
+        "bg/king-massive-smile.png",
+        "hero/walk-moving.png",
+    };
+}
+
 void Victory::enter()
 {
     _message.setColor(bty::getBoxColor(State::difficulty));
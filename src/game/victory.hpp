@@ -16,6 +16,7 @@ public:
     Victory(bty::Engine &engine);
 
     void load() override;
+    std::vector<std::string> getAssets() const override;
     void enter() override;
     void render() override;
     void update(float dt) override;
@@ -92,6 +92,13 @@ void ViewArmy::load()
     }
 }
 
+std::vector<std::string> ViewArmy::getAssets() const
+{
+    return {
+        "frame/army.png",
+    };
+}
+
 void ViewArmy::render()
 {
     GFX::instance().drawSprite(_spFrame);
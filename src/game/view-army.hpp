@@ -16,6 +16,7 @@ class ViewArmy : public Component {
 public:
     ViewArmy(bty::Engine &engine);
     void load() override;
+    std::vector<std::string> getAssets() const override;
     void render() override;
     void update(float dt) override;
     bool handleEvent(Event event) override;
@@ -37,6 +37,13 @@ void ViewCharacter::render()
     }
 }
 
+static const std::string kPortraitFilenames[4] = {
+    "crimsaun",
+    "palmer",
+    "tynnestra",
+    "moham",
+};
+
 void ViewCharacter::load()
 {
     _engine.getGUI().getHUD().setBlankFrame();
@@ -46,13 +53,6 @@ void ViewCharacter::load()
     _spFrame.setTexture(textures.get("frame/character.png"));
     _spFrame.setPosition(0, 16);
 
-    static const std::string kPortraitFilenames[4] = {
-        "crimsaun",
-        "palmer",
-        "tynnestra",
-        "moham",
-    };
-
     for (int i = 0; i < 8; i++) {
         _texArtifacts[i] = textures.get(fmt::format("artifacts/36x32/{}.png", i));
         _spArtifacts[i].setPosition(14.0f + (i % 4) * 48, 136.0f + (i / 4) * 40);
@@ -108,6 +108,21 @@ void ViewCharacter::load()
     _spPortrait.setTexture(_texPortraits[State::hero]);
 }
 
+std::vector<std::string> ViewCharacter::getAssets() const
+{
+    std::vector<std::string> assets {"frame/character.png"};
+    for (int i = 0; i < 8; i++) {
+        assets.push_back(fmt::format("artifacts/36x32/{}.png", i));
+    }
+    for (const auto &portrait : kPortraitFilenames) {
+        assets.push_back(fmt::format("char-page/{}.png", portrait));
+    }
+    for (int i = 0; i < 4; i++) {
+        assets.push_back(fmt::format("maps/{}.png", i));
+    }
+    return assets;
+}
+
 bool ViewCharacter::handleEvent(Event event)
 {
     if (event.id == EventId::KeyDown) {
@@ -14,6 +14,7 @@ class ViewCharacter : public Component {
 public:
     ViewCharacter(bty::Engine &engine);
     void load() override;
+    std::vector<std::string> getAssets() const override;
     void render() override;
     bool handleEvent(Event event) override;
     bool handleKey(Key key) override;
@@ -12,6 +12,7 @@
 #include "game/ingame.hpp"
 #include "game/state.hpp"
 #include "gfx/gfx.hpp"
+#include "gfx/gpu-registry.hpp"
 #include "gfx/texture.hpp"
 
 ViewContinent::ViewContinent(bty::Engine &engine)
@@ -29,6 +30,7 @@ void ViewContinent::load()
 
     glCreateTextures(GL_TEXTURE_2D, 1, &_texMap.handle);
     glTextureStorage2D(_texMap.handle, 1, GL_RGBA8, 64, 64);
+    GpuResources::instance().add(bty::GpuResourceType::Texture, _texMap.handle, bty::GpuCategory::UI, 64 * 64 * 4);
     glTextureParameterf(_texMap.handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTextureParameterf(_texMap.handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTextureParameterf(_texMap.handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -41,7 +43,8 @@ void ViewContinent::load()
 
 void ViewContinent::unload()
 {
-    glDeleteTextures(1, &_texMap.handle);
+    GpuResources::instance().remove(bty::GpuResourceType::Texture, _texMap.handle);
+    GFX::instance().releaseTexture(_texMap.handle);
 }
 
 void ViewContinent::render()
@@ -74,6 +77,9 @@ void ViewContinent::update(float dt)
         GL_BGRA,
         GL_UNSIGNED_INT_8_8_8_8_REV,
         &pixel);
+    GpuResources::instance().addUpload(sizeof(pixel));
+
+    GFX::instance().invalidateTexture(_texMap.handle);
 }
 
 void ViewContinent::enter()
@@ -126,14 +132,15 @@ void ViewContinent::genTexture()
     static constexpr uint32_t yellow = 0xFFCCCC00;
     static constexpr uint32_t castle = 0xFFE8E4E8;
 
-    const unsigned char *const map = _fogEnabled ? State::visited_tiles[State::continent].data() : State::tiles[State::continent];
+    const unsigned char *const map = State::tiles[State::continent];
+    const auto &fog = State::fog[State::continent];
 
     std::vector<unsigned char> pixels(64 * 64 * 4);
     unsigned char *p = pixels.data();
 
     for (int i = 0; i < 4096; i++) {
         int id = map[i];
-        if (id == 0xFF) {
+        if (_fogEnabled && !fog.isSeen(i % 64, i / 64)) {
             std::memcpy(p + i * 4, &black, 4);
         }
         else if (id <= Tile_GrassInFrontOfCastle) {
@@ -174,4 +181,7 @@ void ViewContinent::genTexture()
         GL_BGRA,
         GL_UNSIGNED_INT_8_8_8_8_REV,
         pixels.data());
+    GpuResources::instance().addUpload(pixels.size());
+
+    GFX::instance().invalidateTexture(_texMap.handle);
 }
@@ -67,6 +67,19 @@ void ViewPuzzle::load()
     _spBorder[7].setPosition({x, y + 16});
 }
 
+std::vector<std::string> ViewPuzzle::getAssets() const
+{
+    std::vector<std::string> assets;
+    for (int i = 0; i < 17; i++) {
+        assets.push_back(fmt::format("villains/{}.png", i));
+    }
+    for (int i = 0; i < 8; i++) {
+        assets.push_back(fmt::format("artifacts/44x32/{}.png", i));
+        assets.push_back(fmt::format("border-puzzle/{}.png", i));
+    }
+    return assets;
+}
+
 void ViewPuzzle::render()
 {
     SceneMan::instance().getLastScene()->render();
@@ -55,6 +55,14 @@ void Wizard::load()
     });
 }
 
+std::vector<std::string> Wizard::getAssets() const
+{
+    return {
+        "bg/cave.png",
+        "units/6.png",
+    };
+}
+
 void Wizard::handleDialogOption(int opt)
 {
     if (opt == 0) {
@@ -15,6 +15,7 @@ public:
     Wizard(bty::Engine &engine);
 
     void load() override;
+    std::vector<std::string> getAssets() const override;
     void enter() override;
     void render() override;
     void update(float dt) override;
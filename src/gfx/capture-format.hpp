@@ -0,0 +1,59 @@
+#ifndef BTY_GFX_CAPTURE_FORMAT_HPP_
+#define BTY_GFX_CAPTURE_FORMAT_HPP_
+
+#include <cstdint>
+
+namespace bty {
+
+/* Layout of a .btyc capture file:
+    CaptureHeader, then a stream of records, each a CaptureOp byte followed
+    by the op's payload. Resources (programs, textures, buffers, vertex arrays)
+    are written the first time a frame references them and again whenever
+    they are invalidated, so a replayer only has to walk the stream in order. */
+
+inline constexpr char kCaptureMagic[4] = {'B', 'T', 'Y', 'C'};
+inline constexpr uint32_t kCaptureVersion = 1;
+
+struct CaptureHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t frames;
+};
+
+enum class CaptureOp : uint8_t {
+    FrameBegin,
+    FrameEnd,
+    /* u32 id, u32 vsLen, vs, u32 fsLen, fs, u32 numUniforms, { i32 location, u32 nameLen, name } */
+    Program,
+    /* u32 id, u32 target, i32 width, i32 height, i32 depth, i32 minFilter, i32 magFilter, i32 wrapS, i32 wrapT, u32 size, RGBA8 data */
+    Texture,
+    /* u32 id, u32 size, data */
+    Buffer,
+    /* u32 id, u32 numAttribs, { u32 index, i32 size, u32 type, i32 stride, u32 offset, u32 buffer } */
+    VertexArray,
+    /* f32 rgba[4] */
+    Clear,
+    /* u32 program */
+    UseProgram,
+    /* u32 program, i32 location, f32[16] */
+    UniformMat4,
+    /* u32 program, i32 location, i32 */
+    Uniform1i,
+    /* u32 program, i32 location, f32[2] */
+    Uniform2f,
+    /* u32 program, i32 location, f32[4] */
+    Uniform4f,
+    /* u32 unit, u32 texture */
+    BindTexture,
+    /* u32 vao */
+    BindVertexArray,
+    /* u32 mode, i32 first, i32 count */
+    DrawArrays,
+    End,
+};
+
+}    // namespace bty
+
+#endif    // BTY_GFX_CAPTURE_FORMAT_HPP_
@@ -0,0 +1,464 @@
+#include "gfx/command-recorder.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <fstream>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace bty {
+
+void CommandRecorder::start(const std::string &path, int numFrames, int width, int height)
+{
+    if (_active) {
+        spdlog::warn("CommandRecorder: already capturing to '{}'", _path);
+        return;
+    }
+
+    _active = true;
+    _inFrame = false;
+    _framesLeft = numFrames;
+    _framesRecorded = 0;
+    _width = width;
+    _height = height;
+    _path = path;
+    _stream.clear();
+    _capturedPrograms.clear();
+    _capturedTextures.clear();
+    _capturedBuffers.clear();
+    _capturedVaos.clear();
+
+    spdlog::info("CommandRecorder: capturing {} frame(s) to '{}'", numFrames, path);
+}
+
+void CommandRecorder::stop()
+{
+    if (!_active) {
+        return;
+    }
+
+    if (_inFrame) {
+        op(CaptureOp::FrameEnd);
+        _framesRecorded++;
+        _inFrame = false;
+    }
+
+    flush();
+    _active = false;
+    _stream.clear();
+    _stream.shrink_to_fit();
+}
+
+bool CommandRecorder::recording() const
+{
+    return _active && _inFrame;
+}
+
+void CommandRecorder::beginFrame()
+{
+    if (!_active) {
+        return;
+    }
+
+    _inFrame = true;
+    op(CaptureOp::FrameBegin);
+}
+
+void CommandRecorder::endFrame()
+{
+    if (!recording()) {
+        return;
+    }
+
+    op(CaptureOp::FrameEnd);
+    _inFrame = false;
+    _framesRecorded++;
+
+    if (--_framesLeft <= 0) {
+        stop();
+    }
+}
+
+void CommandRecorder::registerProgram(GLuint program, const std::string &vsSrc, const std::string &fsSrc)
+{
+    std::lock_guard lock(_programMutex);
+    _programSources[program] = {vsSrc, fsSrc};
+}
+
+void CommandRecorder::forgetProgram(GLuint program)
+{
+    _capturedPrograms.erase(program);
+}
+
+void CommandRecorder::forgetTexture(GLuint texture)
+{
+    _capturedTextures.erase(texture);
+}
+
+void CommandRecorder::forgetVertexArray(GLuint vao)
+{
+    auto it = _capturedVaos.find(vao);
+    if (it == _capturedVaos.end()) {
+        return;
+    }
+
+    /* The buffers backing a VAO are usually what changed (Text recreates its
+        VBO on every string change), so drop them along with it. */
+    for (auto buffer : it->second) {
+        _capturedBuffers.erase(buffer);
+    }
+
+    _capturedVaos.erase(it);
+}
+
+void CommandRecorder::forgetBuffer(GLuint buffer)
+{
+    _capturedBuffers.erase(buffer);
+
+    /* Vertex arrays are resolved against the buffer definition that preceded
+        them, so anything using it has to be written again too. */
+    std::erase_if(_capturedVaos, [buffer](const auto &entry) {
+        return std::find(entry.second.begin(), entry.second.end(), buffer) != entry.second.end();
+    });
+}
+
+void CommandRecorder::clear()
+{
+    if (recording()) {
+        GLfloat color[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, color);
+        op(CaptureOp::Clear);
+        write(color, sizeof(color));
+    }
+
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void CommandRecorder::useProgram(GLuint program)
+{
+    if (recording()) {
+        if (program != GL_NONE) {
+            captureProgram(program);
+        }
+        op(CaptureOp::UseProgram);
+        write<uint32_t>(program);
+    }
+
+    glUseProgram(program);
+}
+
+void CommandRecorder::programUniform(GLuint program, GLint location, const glm::mat4 &value)
+{
+    if (recording()) {
+        captureProgram(program);
+        op(CaptureOp::UniformMat4);
+        write<uint32_t>(program);
+        write<int32_t>(location);
+        write(glm::value_ptr(value), sizeof(GLfloat) * 16);
+    }
+
+    glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void CommandRecorder::programUniform(GLuint program, GLint location, int value)
+{
+    if (recording()) {
+        captureProgram(program);
+        op(CaptureOp::Uniform1i);
+        write<uint32_t>(program);
+        write<int32_t>(location);
+        write<int32_t>(value);
+    }
+
+    glProgramUniform1i(program, location, value);
+}
+
+void CommandRecorder::programUniform(GLuint program, GLint location, const glm::vec2 &value)
+{
+    if (recording()) {
+        captureProgram(program);
+        op(CaptureOp::Uniform2f);
+        write<uint32_t>(program);
+        write<int32_t>(location);
+        write(glm::value_ptr(value), sizeof(GLfloat) * 2);
+    }
+
+    glProgramUniform2fv(program, location, 1, glm::value_ptr(value));
+}
+
+void CommandRecorder::programUniform(GLuint program, GLint location, const glm::vec4 &value)
+{
+    if (recording()) {
+        captureProgram(program);
+        op(CaptureOp::Uniform4f);
+        write<uint32_t>(program);
+        write<int32_t>(location);
+        write(glm::value_ptr(value), sizeof(GLfloat) * 4);
+    }
+
+    glProgramUniform4fv(program, location, 1, glm::value_ptr(value));
+}
+
+void CommandRecorder::bindTextureUnit(GLuint unit, GLuint texture)
+{
+    if (recording()) {
+        if (texture != GL_NONE) {
+            captureTexture(texture);
+        }
+        op(CaptureOp::BindTexture);
+        write<uint32_t>(unit);
+        write<uint32_t>(texture);
+    }
+
+    glBindTextureUnit(unit, texture);
+}
+
+void CommandRecorder::bindVertexArray(GLuint vao)
+{
+    if (recording()) {
+        if (vao != GL_NONE) {
+            captureVertexArray(vao);
+        }
+        op(CaptureOp::BindVertexArray);
+        write<uint32_t>(vao);
+    }
+
+    glBindVertexArray(vao);
+}
+
+void CommandRecorder::drawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    if (recording()) {
+        op(CaptureOp::DrawArrays);
+        write<uint32_t>(mode);
+        write<int32_t>(first);
+        write<int32_t>(count);
+    }
+
+    glDrawArrays(mode, first, count);
+}
+
+void CommandRecorder::op(CaptureOp op)
+{
+    write<uint8_t>(static_cast<uint8_t>(op));
+}
+
+void CommandRecorder::write(const void *data, size_t size)
+{
+    const char *bytes = static_cast<const char *>(data);
+    _stream.insert(_stream.end(), bytes, bytes + size);
+}
+
+void CommandRecorder::writeString(const std::string &str)
+{
+    write<uint32_t>(static_cast<uint32_t>(str.size()));
+    write(str.data(), str.size());
+}
+
+void CommandRecorder::captureProgram(GLuint program)
+{
+    if (_capturedPrograms.contains(program)) {
+        return;
+    }
+
+    ProgramSource source;
+    {
+        std::lock_guard lock(_programMutex);
+        auto it = _programSources.find(program);
+        if (it == _programSources.end()) {
+            spdlog::warn("CommandRecorder: program {} was not registered", program);
+            _capturedPrograms.insert(program);
+            return;
+        }
+        source = it->second;
+    }
+
+    /* Locations are only stable for a given driver, so store the names too and
+        let the replayer remap them after linking. */
+    GLint numUniforms = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &numUniforms);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<std::pair<GLint, std::string>> uniforms;
+    std::vector<GLchar> name(std::max(maxNameLength, 1));
+
+    for (GLint i = 0; i < numUniforms; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = GL_NONE;
+        glGetActiveUniform(program, i, maxNameLength, &length, &size, &type, name.data());
+        std::string uniformName(name.data(), length);
+        uniforms.push_back({glGetUniformLocation(program, uniformName.c_str()), uniformName});
+    }
+
+    op(CaptureOp::Program);
+    write<uint32_t>(program);
+    writeString(source.vs);
+    writeString(source.fs);
+    write<uint32_t>(static_cast<uint32_t>(uniforms.size()));
+    for (const auto &[location, uniformName] : uniforms) {
+        write<int32_t>(location);
+        writeString(uniformName);
+    }
+
+    _capturedPrograms.insert(program);
+}
+
+void CommandRecorder::captureTexture(GLuint texture)
+{
+    if (_capturedTextures.contains(texture)) {
+        return;
+    }
+
+    GLint target = GL_TEXTURE_2D;
+    GLint width = 0;
+    GLint height = 0;
+    GLint depth = 0;
+    GLint minFilter = GL_NEAREST;
+    GLint magFilter = GL_NEAREST;
+    GLint wrapS = GL_REPEAT;
+    GLint wrapT = GL_REPEAT;
+
+    glGetTextureParameteriv(texture, GL_TEXTURE_TARGET, &target);
+    glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height);
+    glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_DEPTH, &depth);
+    glGetTextureParameteriv(texture, GL_TEXTURE_MIN_FILTER, &minFilter);
+    glGetTextureParameteriv(texture, GL_TEXTURE_MAG_FILTER, &magFilter);
+    glGetTextureParameteriv(texture, GL_TEXTURE_WRAP_S, &wrapS);
+    glGetTextureParameteriv(texture, GL_TEXTURE_WRAP_T, &wrapT);
+
+    uint32_t size = static_cast<uint32_t>(width * height * std::max(depth, 1) * 4);
+    std::vector<char> pixels(size);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTextureImage(texture, 0, GL_RGBA, GL_UNSIGNED_BYTE, size, pixels.data());
+
+    op(CaptureOp::Texture);
+    write<uint32_t>(texture);
+    write<uint32_t>(target);
+    write<int32_t>(width);
+    write<int32_t>(height);
+    write<int32_t>(depth);
+    write<int32_t>(minFilter);
+    write<int32_t>(magFilter);
+    write<int32_t>(wrapS);
+    write<int32_t>(wrapT);
+    write<uint32_t>(size);
+    write(pixels.data(), size);
+
+    _capturedTextures.insert(texture);
+}
+
+void CommandRecorder::captureBuffer(GLuint buffer)
+{
+    if (_capturedBuffers.contains(buffer)) {
+        return;
+    }
+
+    GLint size = 0;
+    glGetNamedBufferParameteriv(buffer, GL_BUFFER_SIZE, &size);
+
+    std::vector<char> data(size);
+    glGetNamedBufferSubData(buffer, 0, size, data.data());
+
+    op(CaptureOp::Buffer);
+    write<uint32_t>(buffer);
+    write<uint32_t>(static_cast<uint32_t>(size));
+    write(data.data(), size);
+
+    _capturedBuffers.insert(buffer);
+}
+
+void CommandRecorder::captureVertexArray(GLuint vao)
+{
+    if (_capturedVaos.contains(vao)) {
+        return;
+    }
+
+    struct Attrib {
+        uint32_t index;
+        int32_t size;
+        uint32_t type;
+        int32_t stride;
+        uint32_t offset;
+        uint32_t buffer;
+    };
+
+    std::vector<Attrib> attribs;
+    std::vector<GLuint> buffers;
+
+    GLint previous = GL_NONE;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous);
+    glBindVertexArray(vao);
+
+    GLint maxAttribs = 0;
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
+
+    for (GLint i = 0; i < maxAttribs; i++) {
+        GLint enabled = GL_FALSE;
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+        if (!enabled) {
+            continue;
+        }
+
+        GLint size = 0;
+        GLint type = GL_FLOAT;
+        GLint stride = 0;
+        GLint buffer = GL_NONE;
+        void *offset = nullptr;
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+        glGetVertexAttribPointerv(i, GL_VERTEX_ATTRIB_ARRAY_POINTER, &offset);
+
+        attribs.push_back({static_cast<uint32_t>(i), size, static_cast<uint32_t>(type), stride, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(offset)), static_cast<uint32_t>(buffer)});
+
+        if (buffer != GL_NONE && std::find(buffers.begin(), buffers.end(), buffer) == buffers.end()) {
+            buffers.push_back(buffer);
+        }
+    }
+
+    glBindVertexArray(previous);
+
+    for (auto buffer : buffers) {
+        captureBuffer(buffer);
+    }
+
+    op(CaptureOp::VertexArray);
+    write<uint32_t>(vao);
+    write<uint32_t>(static_cast<uint32_t>(attribs.size()));
+    for (const auto &attrib : attribs) {
+        write(attrib);
+    }
+
+    _capturedVaos[vao] = std::move(buffers);
+}
+
+void CommandRecorder::flush()
+{
+    op(CaptureOp::End);
+
+    std::ofstream f(_path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!f.good()) {
+        spdlog::warn("CommandRecorder: failed to open '{}' for writing", _path);
+        return;
+    }
+
+    CaptureHeader header;
+    std::copy(std::begin(kCaptureMagic), std::end(kCaptureMagic), header.magic);
+    header.version = kCaptureVersion;
+    header.width = static_cast<uint32_t>(_width);
+    header.height = static_cast<uint32_t>(_height);
+    header.frames = static_cast<uint32_t>(_framesRecorded);
+
+    f.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    f.write(_stream.data(), _stream.size());
+
+    spdlog::info("CommandRecorder: wrote {} frame(s), {} bytes to '{}'", _framesRecorded, _stream.size() + sizeof(header), _path);
+}
+
+}    // namespace bty
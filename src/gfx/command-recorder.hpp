@@ -0,0 +1,89 @@
+#ifndef BTY_GFX_COMMAND_RECORDER_HPP_
+#define BTY_GFX_COMMAND_RECORDER_HPP_
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "engine/singleton.hpp"
+#include "gfx/capture-format.hpp"
+#include "gfx/gl.hpp"
+
+namespace bty {
+
+/* Thin layer between the renderers and GL. Every draw-related call is issued
+    straight through; while a capture is running it is also serialized, along
+    with the contents of any resource it references, for bounty-replay.
+    Only the thread executing render snapshots uses it, apart from
+    registerProgram(), which shaders call wherever they are loaded. */
+class CommandRecorder {
+public:
+    void start(const std::string &path, int numFrames, int width, int height);
+    void stop();
+    bool recording() const;
+    void beginFrame();
+    void endFrame();
+
+    void registerProgram(GLuint program, const std::string &vsSrc, const std::string &fsSrc);
+    void forgetProgram(GLuint program);
+    void forgetTexture(GLuint texture);
+    void forgetVertexArray(GLuint vao);
+    void forgetBuffer(GLuint buffer);
+
+    void clear();
+    void useProgram(GLuint program);
+    void programUniform(GLuint program, GLint location, const glm::mat4 &value);
+    void programUniform(GLuint program, GLint location, int value);
+    void programUniform(GLuint program, GLint location, const glm::vec2 &value);
+    void programUniform(GLuint program, GLint location, const glm::vec4 &value);
+    void bindTextureUnit(GLuint unit, GLuint texture);
+    void bindVertexArray(GLuint vao);
+    void drawArrays(GLenum mode, GLint first, GLsizei count);
+
+private:
+    struct ProgramSource {
+        std::string vs;
+        std::string fs;
+    };
+
+    void op(CaptureOp op);
+    void write(const void *data, size_t size);
+    template <typename T>
+    void write(const T &value)
+    {
+        write(&value, sizeof(T));
+    }
+    void writeString(const std::string &str);
+    void captureProgram(GLuint program);
+    void captureTexture(GLuint texture);
+    void captureBuffer(GLuint buffer);
+    void captureVertexArray(GLuint vao);
+    void flush();
+
+private:
+    bool _active {false};
+    bool _inFrame {false};
+    int _framesLeft {0};
+    int _framesRecorded {0};
+    int _width {0};
+    int _height {0};
+    std::string _path;
+    std::vector<char> _stream;
+    std::mutex _programMutex;
+    std::unordered_map<GLuint, ProgramSource> _programSources;
+    std::unordered_set<GLuint> _capturedPrograms;
+    std::unordered_set<GLuint> _capturedTextures;
+    std::unordered_set<GLuint> _capturedBuffers;
+    std::unordered_map<GLuint, std::vector<GLuint>> _capturedVaos;
+};
+
+}    // namespace bty
+
+using Recorder = bty::SingletonProvider<bty::CommandRecorder>;
+
+#endif    // BTY_GFX_COMMAND_RECORDER_HPP_
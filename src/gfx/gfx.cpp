@@ -4,103 +4,329 @@
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include "engine/profiler.hpp"
+#include "gfx/command-recorder.hpp"
 #include "gfx/font.hpp"
+#include "gfx/gpu-registry.hpp"
 #include "gfx/rect.hpp"
 #include "gfx/shader.hpp"
 #include "gfx/sprite.hpp"
 #include "gfx/text.hpp"
+#include "gfx/vertex-array-cache.hpp"
 
 namespace bty {
 
 Gfx::Gfx()
 {
-    initGLState();
+    initContext();
     loadShaders();
     getUniformLocations();
-    createQuadVao();
+    createQuadVbo();
 }
 
 Gfx::~Gfx()
 {
+    auto &registry {GpuResources::instance()};
+    registry.remove(GpuResourceType::Program, _shdSpriteMulti);
+    registry.remove(GpuResourceType::Program, _shdSpriteSingle);
+    registry.remove(GpuResourceType::Program, _shdRect);
+    registry.remove(GpuResourceType::Program, _shdText);
+    registry.remove(GpuResourceType::Buffer, _quadVbo);
+
     glDeleteProgram(_shdSpriteMulti);
     glDeleteProgram(_shdSpriteSingle);
     glDeleteProgram(_shdRect);
     glDeleteProgram(_shdText);
-    glDeleteVertexArrays(1, &_quadVao);
     glDeleteBuffers(1, &_quadVbo);
 }
 
 void Gfx::clear()
 {
-    glClear(GL_COLOR_BUFFER_BIT);
+    if (_snapshot) {
+        _snapshot->clear = true;
+    }
 }
 
 void Gfx::drawSprite(Sprite &sprite, glm::mat4 &camera)
 {
     const Texture *texture = sprite.getTexture();
 
-    if (texture) {
-        if (texture->framesX > 1 || texture->framesY > 1) {
-            glProgramUniformMatrix4fv(_shdSpriteMulti, _locations[Locations::SpriteTransform], 1, GL_FALSE, glm::value_ptr(sprite.getTransform()));
-            glProgramUniformMatrix4fv(_shdSpriteMulti, _locations[Locations::SpriteCamera], 1, GL_FALSE, glm::value_ptr(camera));
-            glProgramUniform1i(_shdSpriteMulti, _locations[Locations::SpriteTexture], 0);
-            glProgramUniform1i(_shdSpriteMulti, _locations[Locations::SpriteFrame], sprite.getFrame());
-            glProgramUniform1i(_shdSpriteMulti, _locations[Locations::SpriteFlip], static_cast<int>(sprite.getFlip()));
-            glUseProgram(_shdSpriteMulti);
-            glBindTextureUnit(0, texture->handle);
-        }
-        else {
-            glProgramUniformMatrix4fv(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureTransform], 1, GL_FALSE, glm::value_ptr(sprite.getTransform()));
-            glProgramUniformMatrix4fv(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureCamera], 1, GL_FALSE, glm::value_ptr(camera));
-            glProgramUniform1i(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureTexture], 0);
-            glProgramUniform1i(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureFlip], static_cast<int>(sprite.getFlip()));
-            glProgramUniform1i(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureRepeat], static_cast<int>(sprite.getRepeat()));
-            if (sprite.getRepeat()) {
-                const auto size {sprite.getSize()};
-                glm::vec2 scale = {size.x / texture->width, size.y / texture->height};
-                glProgramUniform2fv(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureSize], 1, glm::value_ptr(scale));
-            }
-            glUseProgram(_shdSpriteSingle);
-            glBindTextureUnit(0, texture->handle);
-        }
+    if (!_snapshot || !texture) {
+        return;
+    }
+
+    DrawCommand cmd {.kind = DrawKind::Sprite};
+    cmd.texture = texture->handle;
+    cmd.transform = sprite.getRenderTransform();
+    cmd.camera = camera;
+    cmd.flip = sprite.getFlip();
+
+    if (texture->framesX > 1 || texture->framesY > 1) {
+        cmd.kind = DrawKind::SpriteArray;
+        cmd.frame = sprite.getFrame();
     }
     else {
-        glBindTextureUnit(0, GL_NONE);
-        return;
+        cmd.repeat = sprite.getRepeat();
+        if (cmd.repeat) {
+            const auto size {sprite.getSize()};
+            cmd.size = {size.x / texture->width, size.y / texture->height};
+        }
     }
 
-    glBindVertexArray(_quadVao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(GL_NONE);
-    glUseProgram(GL_NONE);
+    _snapshot->commands.push_back(cmd);
 }
 
 void Gfx::drawRect(Rect &rect, glm::mat4 &camera)
 {
-    glProgramUniformMatrix4fv(_shdRect, _locations[Locations::RectTransform], 1, GL_FALSE, glm::value_ptr(rect.getTransform()));
-    glProgramUniformMatrix4fv(_shdRect, _locations[Locations::RectCamera], 1, GL_FALSE, glm::value_ptr(camera));
-    glProgramUniform4fv(_shdRect, _locations[Locations::RectColor], 1, glm::value_ptr(rect.getColor()));
+    if (!_snapshot) {
+        return;
+    }
+
+    DrawCommand cmd {.kind = DrawKind::Rect};
+    cmd.transform = rect.getRenderTransform();
+    cmd.camera = camera;
+    cmd.color = rect.getColor();
 
-    glUseProgram(_shdRect);
-    glBindVertexArray(_quadVao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(GL_NONE);
-    glUseProgram(GL_NONE);
+    _snapshot->commands.push_back(cmd);
 }
 
 void Gfx::drawText(Text &text, glm::mat4 &camera)
 {
-    glProgramUniformMatrix4fv(_shdText, _locations[Locations::TextTransform], 1, GL_FALSE, glm::value_ptr(text.getTransform()));
-    glProgramUniformMatrix4fv(_shdText, _locations[Locations::TextCamera], 1, GL_FALSE, glm::value_ptr(camera));
-    glProgramUniform1i(_shdText, _locations[Locations::TextTexture], 0);
+    if (!_snapshot || text.getVbo() == GL_NONE) {
+        return;
+    }
+
+    DrawCommand cmd {.kind = DrawKind::Text};
+    cmd.layout = VertexLayout::Pos2Uv2;
+    cmd.vbo = text.getVbo();
+    cmd.count = text.getNumVerts();
+    cmd.transform = text.getRenderTransform();
+    cmd.camera = camera;
+    if (text.getFont() && text.getFont()->getTexture()) {
+        cmd.texture = text.getFont()->getTexture()->handle;
+    }
+
+    _snapshot->commands.push_back(cmd);
+}
+
+void Gfx::drawMesh(const Mesh &mesh, const glm::mat4 &camera)
+{
+    if (!_snapshot || mesh.program == GL_NONE || mesh.vbo == GL_NONE) {
+        return;
+    }
+
+    DrawCommand cmd {.kind = DrawKind::Mesh};
+    cmd.layout = mesh.layout;
+    cmd.program = mesh.program;
+    cmd.cameraLoc = mesh.cameraLoc;
+    cmd.textureLoc = mesh.textureLoc;
+    cmd.texture = mesh.texture;
+    cmd.vbo = mesh.vbo;
+    cmd.count = mesh.count;
+    cmd.camera = camera;
+
+    _snapshot->commands.push_back(cmd);
+}
+
+void Gfx::beginSnapshot(RenderSnapshot &snapshot)
+{
+    snapshot.seq = ++_seq;
+    snapshot.clear = false;
+    snapshot.commands.clear();
+    _snapshot = &snapshot;
+}
+
+void Gfx::endSnapshot()
+{
+    _snapshot = nullptr;
+}
+
+void Gfx::execute(const RenderSnapshot &snapshot, VertexArrayCache &vaos)
+{
+    BTY_PROFILE_ZONE("Gfx::execute");
+
+    applyPending(snapshot.seq, false, vaos);
+
+    auto &rec {Recorder::instance()};
+
+    if (snapshot.clear) {
+        rec.clear();
+    }
+
+    for (const auto &cmd : snapshot.commands) {
+        executeCommand(cmd, vaos);
+    }
+
+    applyPending(snapshot.seq, true, vaos);
+}
+
+void Gfx::executeCommand(const DrawCommand &cmd, VertexArrayCache &vaos)
+{
+    auto &rec {Recorder::instance()};
+
+    switch (cmd.kind) {
+        case DrawKind::SpriteArray:
+            rec.programUniform(_shdSpriteMulti, _locations[Locations::SpriteTransform], cmd.transform);
+            rec.programUniform(_shdSpriteMulti, _locations[Locations::SpriteCamera], cmd.camera);
+            rec.programUniform(_shdSpriteMulti, _locations[Locations::SpriteTexture], 0);
+            rec.programUniform(_shdSpriteMulti, _locations[Locations::SpriteFrame], cmd.frame);
+            rec.programUniform(_shdSpriteMulti, _locations[Locations::SpriteFlip], static_cast<int>(cmd.flip));
+            rec.useProgram(_shdSpriteMulti);
+            rec.bindTextureUnit(0, cmd.texture);
+            rec.bindVertexArray(vaos.get(_quadVbo, VertexLayout::Pos2));
+            rec.drawArrays(GL_TRIANGLES, 0, 6);
+            break;
+        case DrawKind::Sprite:
+            rec.programUniform(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureTransform], cmd.transform);
+            rec.programUniform(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureCamera], cmd.camera);
+            rec.programUniform(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureTexture], 0);
+            rec.programUniform(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureFlip], static_cast<int>(cmd.flip));
+            rec.programUniform(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureRepeat], static_cast<int>(cmd.repeat));
+            if (cmd.repeat) {
+                rec.programUniform(_shdSpriteSingle, _locations[Locations::SpriteSingleTextureSize], cmd.size);
+            }
+            rec.useProgram(_shdSpriteSingle);
+            rec.bindTextureUnit(0, cmd.texture);
+            rec.bindVertexArray(vaos.get(_quadVbo, VertexLayout::Pos2));
+            rec.drawArrays(GL_TRIANGLES, 0, 6);
+            break;
+        case DrawKind::Rect:
+            rec.programUniform(_shdRect, _locations[Locations::RectTransform], cmd.transform);
+            rec.programUniform(_shdRect, _locations[Locations::RectCamera], cmd.camera);
+            rec.programUniform(_shdRect, _locations[Locations::RectColor], cmd.color);
+            rec.useProgram(_shdRect);
+            rec.bindVertexArray(vaos.get(_quadVbo, VertexLayout::Pos2));
+            rec.drawArrays(GL_TRIANGLES, 0, 6);
+            break;
+        case DrawKind::Text:
+            rec.programUniform(_shdText, _locations[Locations::TextTransform], cmd.transform);
+            rec.programUniform(_shdText, _locations[Locations::TextCamera], cmd.camera);
+            rec.programUniform(_shdText, _locations[Locations::TextTexture], 0);
+            rec.useProgram(_shdText);
+            rec.bindVertexArray(vaos.get(cmd.vbo, cmd.layout));
+            if (cmd.texture != GL_NONE)
+                rec.bindTextureUnit(0, cmd.texture);
+            rec.drawArrays(GL_TRIANGLES, 0, cmd.count);
+            break;
+        case DrawKind::Mesh:
+            rec.programUniform(cmd.program, cmd.cameraLoc, cmd.camera);
+            rec.programUniform(cmd.program, cmd.textureLoc, 0);
+            rec.useProgram(cmd.program);
+            rec.bindVertexArray(vaos.get(cmd.vbo, cmd.layout));
+            rec.bindTextureUnit(0, cmd.texture);
+            rec.drawArrays(GL_TRIANGLES, 0, cmd.count);
+            break;
+    }
+
+    rec.bindVertexArray(GL_NONE);
+    rec.useProgram(GL_NONE);
+}
+
+void Gfx::flushReleases(VertexArrayCache &vaos)
+{
+    applyPending(UINT64_MAX, false, vaos);
+    applyPending(UINT64_MAX, true, vaos);
+}
+
+void Gfx::setDeferred(bool deferred)
+{
+    _deferred = deferred;
+}
+
+void Gfx::invalidateBuffer(GLuint buffer)
+{
+    /* Only the capture cares that contents changed. A snapshot being
+        recorded already sees the new contents. */
+    addPending(PendingKind::InvalidateBuffer, buffer, _snapshot ? _seq : _seq + 1);
+}
+
+void Gfx::invalidateTexture(GLuint texture)
+{
+    addPending(PendingKind::InvalidateTexture, texture, _snapshot ? _seq : _seq + 1);
+}
+
+void Gfx::releaseBuffer(GLuint buffer)
+{
+    addPending(PendingKind::ReleaseBuffer, buffer, _seq + 1);
+}
+
+void Gfx::releaseTexture(GLuint texture)
+{
+    addPending(PendingKind::ReleaseTexture, texture, _seq + 1);
+}
 
-    glUseProgram(_shdText);
-    glBindVertexArray(text.getVao());
-    if (text.getFont() && text.getFont()->getTexture())
-        glBindTextureUnit(0, text.getFont()->getTexture()->handle);
-    glDrawArrays(GL_TRIANGLES, 0, text.getNumVerts());
-    glBindVertexArray(GL_NONE);
-    glUseProgram(GL_NONE);
+void Gfx::releaseProgram(GLuint program)
+{
+    addPending(PendingKind::ReleaseProgram, program, _seq + 1);
+}
+
+void Gfx::addPending(PendingKind kind, GLuint handle, uint64_t seq)
+{
+    if (handle == GL_NONE) {
+        return;
+    }
+
+    if (!_deferred) {
+        switch (kind) {
+            case PendingKind::ReleaseBuffer:
+                glDeleteBuffers(1, &handle);
+                break;
+            case PendingKind::ReleaseTexture:
+                glDeleteTextures(1, &handle);
+                break;
+            case PendingKind::ReleaseProgram:
+                glDeleteProgram(handle);
+                break;
+            default:
+                break;
+        }
+        return;
+    }
+
+    std::scoped_lock lock(_pendingMutex);
+    _pending.push_back({kind, handle, seq});
+}
+
+void Gfx::applyPending(uint64_t seq, bool releases, VertexArrayCache &vaos)
+{
+    std::vector<Pending> ready;
+
+    {
+        std::scoped_lock lock(_pendingMutex);
+        std::erase_if(_pending, [&](const Pending &p) {
+            const bool isRelease = p.kind >= PendingKind::ReleaseBuffer;
+            if (isRelease != releases || p.seq > seq) {
+                return false;
+            }
+            ready.push_back(p);
+            return true;
+        });
+    }
+
+    auto &rec {Recorder::instance()};
+
+    for (auto &p : ready) {
+        switch (p.kind) {
+            case PendingKind::InvalidateBuffer:
+                rec.forgetBuffer(p.handle);
+                break;
+            case PendingKind::InvalidateTexture:
+                rec.forgetTexture(p.handle);
+                break;
+            case PendingKind::ReleaseBuffer:
+                vaos.release(p.handle);
+                glDeleteBuffers(1, &p.handle);
+                break;
+            case PendingKind::ReleaseTexture:
+                rec.forgetTexture(p.handle);
+                glDeleteTextures(1, &p.handle);
+                break;
+            case PendingKind::ReleaseProgram:
+                rec.forgetProgram(p.handle);
+                glDeleteProgram(p.handle);
+                break;
+        }
+    }
 }
 
 void Gfx::getUniformLocations()
@@ -155,7 +381,7 @@ void Gfx::loadShaders()
     }
 }
 
-void Gfx::initGLState()
+void Gfx::initContext()
 {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -163,13 +389,17 @@ void Gfx::initGLState()
     glClearColor(0.0f, 163 / 255.0f, 166 / 255.0f, 1.0f);
 }
 
-void Gfx::createQuadVao()
+void Gfx::createQuadVbo()
 {
+    auto &registry {GpuResources::instance()};
+
     if (_quadVbo != GL_NONE) {
+        registry.remove(GpuResourceType::Buffer, _quadVbo);
         glDeleteBuffers(1, &_quadVbo);
     }
 
     glGenBuffers(1, &_quadVbo);
+    registry.add(GpuResourceType::Buffer, _quadVbo, GpuCategory::Core, 48);
 
     /* clang-format off */
     GLfloat quadVerts[] = {
@@ -186,13 +416,6 @@ void Gfx::createQuadVao()
     glBindBuffer(GL_ARRAY_BUFFER, _quadVbo);
     glBufferData(GL_ARRAY_BUFFER, 48, quadVerts, GL_STATIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
-
-    glCreateVertexArrays(1, &_quadVao);
-    glBindVertexArray(_quadVao);
-    glBindBuffer(GL_ARRAY_BUFFER, _quadVbo);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, nullptr);
-    glEnableVertexAttribArray(0);
-    glBindVertexArray(GL_NONE);
 }
 
 void Gfx::setView(const glm::mat4 &mat)
@@ -1,10 +1,14 @@
 #ifndef BTY_GFX_GFX_HPP_
 #define BTY_GFX_GFX_HPP_
 
+#include <cstdint>
 #include <glm/mat4x4.hpp>
+#include <mutex>
+#include <vector>
 
 #include "engine/singleton.hpp"
 #include "gfx/gl.hpp"
+#include "gfx/render-snapshot.hpp"
 
 namespace bty {
 
@@ -32,11 +36,20 @@ enum Locations {
 class Rect;
 class Sprite;
 class Text;
+class VertexArrayCache;
 
+/* The draw* calls don't touch GL; they append to the snapshot between
+    beginSnapshot() and endSnapshot(), and are dropped outside of one.
+    execute() issues a snapshot on whichever thread owns the window context.
+
+    GL objects a snapshot may still reference can't be deleted on the spot,
+    so owners hand them to release*() instead. While deferred, they are
+    deleted once a snapshot recorded after the call has been executed. */
 class Gfx {
 public:
     Gfx();
     ~Gfx();
+    void initContext();
     void clear();
     void setView(const glm::mat4 &mat);
     void drawSprite(Sprite &sprite);
@@ -45,22 +58,56 @@ public:
     void drawSprite(Sprite &sprite, glm::mat4 &camera);
     void drawRect(Rect &rect, glm::mat4 &camera);
     void drawText(Text &text, glm::mat4 &camera);
+    void drawMesh(const Mesh &mesh, const glm::mat4 &camera);
+
+    void beginSnapshot(RenderSnapshot &snapshot);
+    void endSnapshot();
+    void execute(const RenderSnapshot &snapshot, VertexArrayCache &vaos);
+    void flushReleases(VertexArrayCache &vaos);
+
+    void setDeferred(bool deferred);
+    void invalidateBuffer(GLuint buffer);
+    void invalidateTexture(GLuint texture);
+    void releaseBuffer(GLuint buffer);
+    void releaseTexture(GLuint texture);
+    void releaseProgram(GLuint program);
 
 private:
-    void initGLState();
+    enum class PendingKind {
+        InvalidateBuffer,
+        InvalidateTexture,
+        ReleaseBuffer,
+        ReleaseTexture,
+        ReleaseProgram,
+    };
+
+    struct Pending {
+        PendingKind kind;
+        GLuint handle;
+        uint64_t seq;
+    };
+
     void loadShaders();
     void getUniformLocations();
-    void createQuadVao();
+    void createQuadVbo();
+    void addPending(PendingKind kind, GLuint handle, uint64_t seq);
+    void applyPending(uint64_t seq, bool releases, VertexArrayCache &vaos);
+    void executeCommand(const DrawCommand &cmd, VertexArrayCache &vaos);
 
 private:
     GLuint _shdSpriteMulti {GL_NONE};
     GLuint _shdSpriteSingle {GL_NONE};
     GLuint _shdRect {GL_NONE};
     GLuint _shdText {GL_NONE};
-    GLuint _quadVao {GL_NONE};
     GLuint _quadVbo {GL_NONE};
     GLint _locations[Locations::Count];
     glm::mat4 _view {1.0f};
+
+    RenderSnapshot *_snapshot {nullptr};
+    uint64_t _seq {0};
+    bool _deferred {false};
+    std::mutex _pendingMutex;
+    std::vector<Pending> _pending;
 };
 
 }    // namespace bty
@@ -0,0 +1,180 @@
+#include "gfx/gpu-registry.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace bty {
+
+static constexpr const char *const kTypeNames[] = {
+    "buffer",
+    "texture",
+    "vertex array",
+    "program",
+};
+
+static constexpr const char *const kCategoryNames[] = {
+    "Core",
+    "Map",
+    "Text",
+    "UI",
+    "Units",
+};
+
+const char *gpuCategoryName(GpuCategory category)
+{
+    return kCategoryNames[static_cast<int>(category)];
+}
+
+GpuCategory gpuCategoryForTexture(const std::string &path)
+{
+    if (path.starts_with("tilesets/") || path.starts_with("maps/")) {
+        return GpuCategory::Map;
+    }
+    if (path.starts_with("fonts/")) {
+        return GpuCategory::Text;
+    }
+    if (path.starts_with("units/") || path.starts_with("villains/") || path.starts_with("hero/")) {
+        return GpuCategory::Units;
+    }
+    return GpuCategory::UI;
+}
+
+uint64_t GpuRegistry::key(GpuResourceType type, GLuint handle)
+{
+    return (static_cast<uint64_t>(type) << 32) | handle;
+}
+
+void GpuRegistry::add(GpuResourceType type, GLuint handle, GpuCategory category, size_t bytes, std::source_location site)
+{
+    if (handle == GL_NONE) {
+        return;
+    }
+
+    auto [it, inserted] = _resources.try_emplace(key(type, handle), GpuResource {type, handle, category, bytes, site, std::chrono::steady_clock::now()});
+
+    if (!inserted) {
+        spdlog::warn("GpuRegistry: {} {} registered twice ({}:{})", kTypeNames[static_cast<int>(type)], handle, site.file_name(), site.line());
+        return;
+    }
+
+    auto &totals = _totals[static_cast<int>(category)];
+    totals.count++;
+    totals.bytes += bytes;
+}
+
+void GpuRegistry::remove(GpuResourceType type, GLuint handle)
+{
+    if (handle == GL_NONE) {
+        return;
+    }
+
+    auto it = _resources.find(key(type, handle));
+    if (it == _resources.end()) {
+        spdlog::warn("GpuRegistry: removing unregistered {} {}", kTypeNames[static_cast<int>(type)], handle);
+        return;
+    }
+
+    auto &totals = _totals[static_cast<int>(it->second.category)];
+    totals.count--;
+    totals.bytes -= it->second.bytes;
+
+    _resources.erase(it);
+}
+
+void GpuRegistry::setBytes(GpuResourceType type, GLuint handle, size_t bytes)
+{
+    auto it = _resources.find(key(type, handle));
+    if (it == _resources.end()) {
+        return;
+    }
+
+    auto &totals = _totals[static_cast<int>(it->second.category)];
+    totals.bytes = totals.bytes - it->second.bytes + bytes;
+    it->second.bytes = bytes;
+}
+
+void GpuRegistry::setSite(GpuResourceType type, GLuint handle, std::source_location site)
+{
+    auto it = _resources.find(key(type, handle));
+    if (it != _resources.end()) {
+        it->second.site = site;
+    }
+}
+
+void GpuRegistry::addUpload(size_t bytes)
+{
+    _uploadBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+size_t GpuRegistry::takeUploads()
+{
+    return _uploadBytes.exchange(0, std::memory_order_relaxed);
+}
+
+const GpuCategoryTotals &GpuRegistry::getTotals(GpuCategory category) const
+{
+    return _totals[static_cast<int>(category)];
+}
+
+GpuCategoryTotals GpuRegistry::getTotals() const
+{
+    GpuCategoryTotals sum;
+    for (const auto &totals : _totals) {
+        sum.count += totals.count;
+        sum.bytes += totals.bytes;
+    }
+    return sum;
+}
+
+void GpuRegistry::dump() const
+{
+    using namespace std::chrono;
+
+    for (int i = 0; i < static_cast<int>(GpuCategory::Count); i++) {
+        spdlog::info("GpuRegistry: {:<5} {:>5} objects {:>10} bytes", kCategoryNames[i], _totals[i].count, _totals[i].bytes);
+    }
+
+    if (_resources.empty()) {
+        return;
+    }
+
+    /* Group by creation site; a leak shows up as one site with a large count. */
+    struct Site {
+        const GpuResource *oldest;
+        size_t count;
+        size_t bytes;
+    };
+
+    std::unordered_map<std::string, Site> sites;
+
+    for (const auto &[k, resource] : _resources) {
+        auto name = fmt::format("{} {}:{}", kTypeNames[static_cast<int>(resource.type)], resource.site.file_name(), resource.site.line());
+        auto &site = sites.try_emplace(name, Site {&resource, 0, 0}).first->second;
+        site.count++;
+        site.bytes += resource.bytes;
+        if (resource.created < site.oldest->created) {
+            site.oldest = &resource;
+        }
+    }
+
+    std::vector<std::pair<std::string, Site>> sorted(sites.begin(), sites.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+        return a.second.count > b.second.count;
+    });
+
+    const auto now = steady_clock::now();
+
+    spdlog::warn("GpuRegistry: {} live object(s)", _resources.size());
+    for (const auto &[name, site] : sorted) {
+        spdlog::warn("    {:>5} x {} ({}, {} bytes, oldest {:.1f}s)",
+                     site.count,
+                     name,
+                     kCategoryNames[static_cast<int>(site.oldest->category)],
+                     site.bytes,
+                     duration<float>(now - site.oldest->created).count());
+    }
+}
+
+}    // namespace bty
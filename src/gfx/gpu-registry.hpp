@@ -0,0 +1,80 @@
+#ifndef BTY_GFX_GPU_REGISTRY_HPP_
+#define BTY_GFX_GPU_REGISTRY_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <source_location>
+#include <string>
+#include <unordered_map>
+
+#include "engine/singleton.hpp"
+#include "gfx/gl.hpp"
+
+namespace bty {
+
+enum class GpuResourceType {
+    Buffer,
+    Texture,
+    VertexArray,
+    Program,
+};
+
+enum class GpuCategory {
+    Core,
+    Map,
+    Text,
+    UI,
+    Units,
+    Count,
+};
+
+struct GpuResource {
+    GpuResourceType type;
+    GLuint handle;
+    GpuCategory category;
+    size_t bytes;
+    std::source_location site;
+    std::chrono::steady_clock::time_point created;
+};
+
+struct GpuCategoryTotals {
+    size_t count {0};
+    size_t bytes {0};
+};
+
+/* Book-keeping for every GL object the game creates. Owners call add() right
+    after creating an object and remove() right before deleting it, so whatever is
+    left in here at shutdown has leaked. */
+class GpuRegistry {
+public:
+    void add(GpuResourceType type, GLuint handle, GpuCategory category, size_t bytes = 0, std::source_location site = std::source_location::current());
+    void remove(GpuResourceType type, GLuint handle);
+    void setBytes(GpuResourceType type, GLuint handle, size_t bytes);
+    void setSite(GpuResourceType type, GLuint handle, std::source_location site);
+    /* Bytes handed to GL for buffer and texture contents. */
+    void addUpload(size_t bytes);
+    size_t takeUploads();
+
+    const GpuCategoryTotals &getTotals(GpuCategory category) const;
+    GpuCategoryTotals getTotals() const;
+    void dump() const;
+
+private:
+    static uint64_t key(GpuResourceType type, GLuint handle);
+
+private:
+    std::unordered_map<uint64_t, GpuResource> _resources;
+    std::array<GpuCategoryTotals, static_cast<size_t>(GpuCategory::Count)> _totals;
+    std::atomic<size_t> _uploadBytes {0};
+};
+
+const char *gpuCategoryName(GpuCategory category);
+GpuCategory gpuCategoryForTexture(const std::string &path);
+
+}    // namespace bty
+
+using GpuResources = bty::SingletonProvider<bty::GpuRegistry>;
+
+#endif    // BTY_GFX_GPU_REGISTRY_HPP_
@@ -0,0 +1,71 @@
+#ifndef BTY_GFX_RENDER_SNAPSHOT_HPP_
+#define BTY_GFX_RENDER_SNAPSHOT_HPP_
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+#include "gfx/gl.hpp"
+
+namespace bty {
+
+enum class DrawKind : uint8_t {
+    SpriteArray,
+    Sprite,
+    Rect,
+    Text,
+    Mesh,
+};
+
+enum class VertexLayout : uint8_t {
+    /* vec2 position */
+    Pos2,
+    /* vec2 position, vec2 uv */
+    Pos2Uv2,
+};
+
+/* Everything needed to issue one draw, copied out of the scene at record
+    time so the render thread never touches game objects. */
+struct DrawCommand {
+    DrawKind kind;
+    VertexLayout layout {VertexLayout::Pos2};
+    bool flip {false};
+    bool repeat {false};
+    int frame {0};
+    GLuint program {GL_NONE};
+    GLint cameraLoc {-1};
+    GLint textureLoc {-1};
+    GLuint texture {GL_NONE};
+    GLuint vbo {GL_NONE};
+    GLsizei count {0};
+    glm::mat4 transform {1.0f};
+    glm::mat4 camera {1.0f};
+    glm::vec4 color {0.0f};
+    glm::vec2 size {1.0f};
+};
+
+struct RenderSnapshot {
+    uint64_t seq {0};
+    bool clear {false};
+    std::vector<DrawCommand> commands;
+    /* Signalled once the update thread's uploads for this snapshot are done. */
+    GLsync fence {nullptr};
+};
+
+/* A custom mesh drawn with its own program, e.g. the map. The program must
+    have a mat4 camera uniform and a sampler bound to unit 0. */
+struct Mesh {
+    GLuint program {GL_NONE};
+    GLint cameraLoc {-1};
+    GLint textureLoc {-1};
+    GLuint texture {GL_NONE};
+    GLuint vbo {GL_NONE};
+    VertexLayout layout {VertexLayout::Pos2Uv2};
+    GLsizei count {0};
+};
+
+}    // namespace bty
+
+#endif    // BTY_GFX_RENDER_SNAPSHOT_HPP_
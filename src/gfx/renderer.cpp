@@ -0,0 +1,213 @@
+#include "gfx/renderer.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include "engine/profiler.hpp"
+#include "gfx/command-recorder.hpp"
+#include "gfx/gfx.hpp"
+#include "window/window.hpp"
+
+namespace bty {
+
+void Renderer::start(Window *window, bool threaded)
+{
+    BTY_PROFILE_ZONE("Renderer::start");
+
+    _window = window;
+    _threaded = threaded && window_create_shared_context(_window);
+
+    GFX::instance().setDeferred(true);
+
+    if (!_threaded) {
+        spdlog::info("Renderer: drawing on the update thread");
+        return;
+    }
+
+    _stopping = false;
+    _published = 0;
+    _acquired = 0;
+
+    window_release_current();
+    _thread = std::thread(&Renderer::run, this);
+
+    window_make_current(_window, true);
+    /* Pixel store state is per context; match what the texture cache set up. */
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    spdlog::info("Renderer: drawing on a render thread");
+}
+
+void Renderer::stop()
+{
+    if (_threaded) {
+        {
+            std::scoped_lock lock(_mutex);
+            _stopping = true;
+        }
+        _cv.notify_all();
+        _thread.join();
+
+        window_make_current(_window, false);
+        window_destroy_shared_context(_window);
+        _threaded = false;
+    }
+    else {
+        GFX::instance().flushReleases(_vaos);
+        _vaos.clear();
+    }
+
+    GFX::instance().setDeferred(false);
+}
+
+bool Renderer::threaded() const
+{
+    return _threaded;
+}
+
+RenderSnapshot &Renderer::beginSnapshot()
+{
+    auto &snapshot = _snapshots.back();
+
+    /* The render thread let go of this slot before it came back to us, so
+        nothing is waiting on its old fence any more. */
+    if (snapshot.fence) {
+        glDeleteSync(snapshot.fence);
+        snapshot.fence = nullptr;
+    }
+
+    GFX::instance().beginSnapshot(snapshot);
+    return snapshot;
+}
+
+void Renderer::submit()
+{
+    BTY_PROFILE_ZONE("Renderer::submit");
+
+    GFX::instance().endSnapshot();
+
+    auto &snapshot = _snapshots.back();
+    _submitted = snapshot.seq;
+
+    if (!_threaded) {
+        present(snapshot);
+        return;
+    }
+
+    snapshot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    const auto seq = snapshot.seq;
+    _snapshots.publish();
+
+    {
+        std::scoped_lock lock(_mutex);
+        _published = seq;
+    }
+    _cv.notify_all();
+}
+
+void Renderer::pace(std::chrono::microseconds timeout)
+{
+    BTY_PROFILE_ZONE("Renderer::pace");
+
+    if (!_threaded) {
+        swap(_submitted);
+        return;
+    }
+
+    /* Stay at most one snapshot ahead of the display, but never block the
+        update thread for longer than a step while the render thread is stuck
+        in a swap. */
+    std::unique_lock lock(_mutex);
+    _cv.wait_for(lock, timeout, [this] {
+        return _acquired >= _published;
+    });
+}
+
+void Renderer::requestCapture(const std::string &path, int numFrames, int width, int height)
+{
+    if (!_threaded) {
+        Recorder::instance().start(path, numFrames, width, height);
+        return;
+    }
+
+    std::scoped_lock lock(_captureMutex);
+    _capture = {path, numFrames, width, height};
+    _capturePending = true;
+}
+
+bool Renderer::popPresented(PresentedFrame &frame)
+{
+    return _presented.pop(frame);
+}
+
+void Renderer::run()
+{
+    Profile::instance().setThreadName("Render");
+    window_make_current(_window, false);
+
+    while (true) {
+        {
+            std::unique_lock lock(_mutex);
+            _cv.wait(lock, [this] {
+                return _stopping || _published > _acquired;
+            });
+            if (_stopping) {
+                break;
+            }
+        }
+
+        if (!_snapshots.acquire()) {
+            continue;
+        }
+
+        auto &snapshot = _snapshots.front();
+
+        {
+            std::scoped_lock lock(_mutex);
+            _acquired = snapshot.seq;
+        }
+        _cv.notify_all();
+
+        glWaitSync(snapshot.fence, 0, GL_TIMEOUT_IGNORED);
+        present(snapshot);
+        swap(snapshot.seq);
+    }
+
+    GFX::instance().flushReleases(_vaos);
+    _vaos.clear();
+    glFinish();
+
+    window_release_current();
+}
+
+void Renderer::present(const RenderSnapshot &snapshot)
+{
+    BTY_PROFILE_ZONE("Renderer::present");
+
+    {
+        std::scoped_lock lock(_captureMutex);
+        if (_capturePending) {
+            Recorder::instance().start(_capture.path, _capture.numFrames, _capture.width, _capture.height);
+            _capturePending = false;
+        }
+    }
+
+    auto &rec {Recorder::instance()};
+
+    rec.beginFrame();
+    GFX::instance().execute(snapshot, _vaos);
+    rec.endFrame();
+}
+
+void Renderer::swap(uint64_t seq)
+{
+    window_swap(_window);
+
+    /* The swap returning is as close to the photons as GL lets us get. A
+        frame that doesn't fit in the ring just credits its input to a later
+        one. */
+    _presented.push({seq, std::chrono::steady_clock::now()});
+}
+
+}    // namespace bty
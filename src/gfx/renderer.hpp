@@ -0,0 +1,80 @@
+#ifndef BTY_GFX_RENDERER_HPP_
+#define BTY_GFX_RENDERER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "engine/spsc-ring.hpp"
+#include "engine/triple-buffer.hpp"
+#include "gfx/render-snapshot.hpp"
+#include "gfx/vertex-array-cache.hpp"
+
+namespace bty {
+
+struct Window;
+
+struct PresentedFrame {
+    uint64_t seq {0};
+    std::chrono::steady_clock::time_point time;
+};
+
+/* Owns the window's GL context and presents snapshots recorded by the
+    update thread. With a render thread, the update thread switches to a
+    hidden context sharing the same objects; a fence per snapshot makes its
+    uploads visible before the snapshot is drawn. Without one (disabled, or
+    no shared context available) submit() draws inline and pace() swaps. */
+class Renderer {
+public:
+    void start(Window *window, bool threaded);
+    void stop();
+    bool threaded() const;
+
+    RenderSnapshot &beginSnapshot();
+    void submit();
+    void pace(std::chrono::microseconds timeout);
+
+    void requestCapture(const std::string &path, int numFrames, int width, int height);
+
+    /* Snapshots as their swap returned, oldest first. For the update thread. */
+    bool popPresented(PresentedFrame &frame);
+
+private:
+    struct CaptureRequest {
+        std::string path;
+        int numFrames {0};
+        int width {0};
+        int height {0};
+    };
+
+    void run();
+    void present(const RenderSnapshot &snapshot);
+    void swap(uint64_t seq);
+
+private:
+    Window *_window {nullptr};
+    bool _threaded {false};
+    std::thread _thread;
+    TripleBuffer<RenderSnapshot> _snapshots;
+    VertexArrayCache _vaos;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stopping {false};
+    uint64_t _published {0};
+    uint64_t _acquired {0};
+
+    uint64_t _submitted {0};
+    SpscRing<PresentedFrame, 64> _presented;
+
+    std::mutex _captureMutex;
+    bool _capturePending {false};
+    CaptureRequest _capture;
+};
+
+}    // namespace bty
+
+#endif    // BTY_GFX_RENDERER_HPP_
@@ -4,13 +4,15 @@
 
 #include <fstream>
 
+#include "gfx/command-recorder.hpp"
+
 bool compileShader(GLuint shader);
 bool linkProgram(GLuint program);
 std::string readText(const std::string &path);
 
 namespace bty {
 
-GLuint loadShader(const std::string &vsPath, const std::string &fsPath)
+GLuint loadShader(const std::string &vsPath, const std::string &fsPath, GpuCategory category, std::source_location site)
 {
     GLuint vs = glCreateShader(GL_VERTEX_SHADER);
     GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
@@ -51,6 +53,9 @@ GLuint loadShader(const std::string &vsPath, const std::string &fsPath)
     glDeleteShader(vs);
     glDeleteShader(fs);
 
+    Recorder::instance().registerProgram(program, shader_sources[0], shader_sources[1]);
+    GpuResources::instance().add(GpuResourceType::Program, program, category, 0, site);
+
     return program;
 }
 
@@ -1,13 +1,15 @@
 #ifndef BTY_GFX_SHADER_HPP_
 #define BTY_GFX_SHADER_HPP_
 
+#include <source_location>
 #include <string>
 
 #include "gfx/gl.hpp"
+#include "gfx/gpu-registry.hpp"
 
 namespace bty {
 
-GLuint loadShader(const std::string &vertShader, const std::string &fragShader);
+GLuint loadShader(const std::string &vertShader, const std::string &fragShader, GpuCategory category = GpuCategory::Core, std::source_location site = std::source_location::current());
 
 }    // namespace bty
 
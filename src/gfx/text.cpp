@@ -2,19 +2,20 @@
 
 #include <spdlog/spdlog.h>
 
+#include "engine/frame-arena.hpp"
 #include "engine/texture-cache.hpp"
 #include "gfx/font.hpp"
+#include "gfx/gfx.hpp"
+#include "gfx/gpu-registry.hpp"
 #include "gfx/texture.hpp"
 
 namespace bty {
 
 Text::~Text()
 {
-    if (_vao != GL_NONE) {
-        glDeleteVertexArrays(1, &_vao);
-    }
     if (_vbo != GL_NONE) {
-        glDeleteBuffers(1, &_vbo);
+        GpuResources::instance().remove(GpuResourceType::Buffer, _vbo);
+        GFX::instance().releaseBuffer(_vbo);
     }
 }
 
@@ -24,28 +25,34 @@ Text::Text(Text &&other)
     _string = other._string;
     _numVerts = other._numVerts;
     _font = other._font;
+    _site = other._site;
 
     /* Move constructor to prevent automatic destruction
         of the OpenGL resources. */
-    _vao = other._vao;
     _vbo = other._vbo;
-    other._vao = GL_NONE;
     other._vbo = GL_NONE;
 }
 
-Text::Text()
+Text::Text(std::source_location site)
+    : _site(site)
 {
-    glCreateVertexArrays(1, &_vao);
 }
 
-void Text::create(int x, int y, const std::string &string)
+void Text::create(int x, int y, const std::string &string, std::source_location site)
 {
+    /* The constructor usually runs as part of some owner's member
+        initialization, so the create() call is the more useful site. */
+    _site = site;
+    if (_vbo != GL_NONE) {
+        GpuResources::instance().setSite(GpuResourceType::Buffer, _vbo, _site);
+    }
+
     _font = &Textures::instance().getFont();
     setString(string);
     setPosition({x * 8.0f, y * 8.0f});
 }
 
-void Text::setString(const std::string &string)
+void Text::setString(std::string_view string)
 {
     if (_string == string) {
         return;
@@ -59,9 +66,9 @@ void Text::setString(const std::string &string)
     }
 }
 
-GLuint Text::getVao() const
+GLuint Text::getVbo() const
 {
-    return _vao;
+    return _vbo;
 }
 
 GLuint Text::getNumVerts() const
@@ -95,7 +102,10 @@ void Text::updateVbo()
         glm::vec2 texCoord;
     };
 
-    std::vector<Vertex> vertices(_numVerts);
+    /* Staged in the frame arena and given back once uploaded. Newlines and
+        tabs leave their slots zeroed. */
+    ArenaScope scratch(FrameArena::instance());
+    FrameVector<Vertex> vertices(_numVerts);
 
     float x = 0;
     float y = 0;
@@ -128,23 +138,20 @@ void Text::updateVbo()
         x += 8;
     }
 
+    auto &registry {GpuResources::instance()};
+
     if (_vbo != GL_NONE) {
-        glDeleteBuffers(1, &_vbo);
+        registry.remove(GpuResourceType::Buffer, _vbo);
+        GFX::instance().releaseBuffer(_vbo);
     }
 
     glGenBuffers(1, &_vbo);
+    registry.add(GpuResourceType::Buffer, _vbo, GpuCategory::Text, vertices.size() * sizeof(vertices[0]), _site);
 
     glBindBuffer(GL_ARRAY_BUFFER, _vbo);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STATIC_DRAW);
+    registry.addUpload(vertices.size() * sizeof(vertices[0]));
     glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
-
-    glBindVertexArray(_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4, nullptr);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4, (const void *)(sizeof(GLfloat) * 2));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(GL_NONE);
 }
 
 void Text::hide()
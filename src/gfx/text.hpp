@@ -1,7 +1,9 @@
 #ifndef BTY_GFX_TEXT_HPP_
 #define BTY_GFX_TEXT_HPP_
 
+#include <source_location>
 #include <string>
+#include <string_view>
 
 #include "gfx/texture.hpp"
 #include "gfx/transformable.hpp"
@@ -12,14 +14,14 @@ class Font;
 
 class Text : public Transformable {
 public:
-    Text();
+    Text(std::source_location site = std::source_location::current());
     virtual ~Text();
     Text(Text &&other);
 
-    void create(int x, int y, const std::string &string);
-    void setString(const std::string &string);
+    void create(int x, int y, const std::string &string, std::source_location site = std::source_location::current());
+    void setString(std::string_view string);
     const std::string getString() const;
-    GLuint getVao() const;
+    GLuint getVbo() const;
     GLuint getNumVerts() const;
     void setFont(const Font &font);
     const Font *getFont() const;
@@ -32,11 +34,11 @@ private:
 
 private:
     GLuint _vbo {GL_NONE};
-    GLuint _vao {GL_NONE};
     GLuint _numVerts {0};
     std::string _string {""};
     const Font *_font {nullptr};
     bool _visible {true};
+    std::source_location _site;
 };
 
 }    // namespace bty
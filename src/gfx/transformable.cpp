@@ -4,30 +4,76 @@
 
 namespace bty {
 
+static uint32_t sSimStep {1};
+static bool sInSimStep {false};
+static float sAlpha {1.0f};
+
+void Transformable::beginSimStep()
+{
+    sSimStep++;
+    sInSimStep = true;
+}
+
+void Transformable::endSimStep()
+{
+    sInSimStep = false;
+}
+
+void Transformable::setInterpolation(float alpha)
+{
+    sAlpha = alpha;
+}
+
+void Transformable::beforeMove()
+{
+    /* First move in this step: remember where the step started. */
+    if (sInSimStep && _step != sSimStep) {
+        _prevPosition = _position;
+        _step = sSimStep;
+    }
+}
+
+void Transformable::afterMove()
+{
+    if (!sInSimStep) {
+        _prevPosition = _position;
+    }
+    _dirty = true;
+}
+
+void Transformable::snap()
+{
+    _prevPosition = _position;
+}
+
 void Transformable::setPosition(float x, float y)
 {
+    beforeMove();
     _position = {x, y, 0.0f};
-    _dirty = true;
+    afterMove();
 }
 
 void Transformable::setPosition(const glm::vec2 &position)
 {
+    beforeMove();
     _position = {position.x, position.y, 0.0f};
-    _dirty = true;
+    afterMove();
 }
 
 void Transformable::move(float dx, float dy)
 {
+    beforeMove();
     _position.x += dx;
     _position.y += dy;
-    _dirty = true;
+    afterMove();
 }
 
 void Transformable::move(glm::vec2 d)
 {
+    beforeMove();
     _position.x += d.x;
     _position.x += d.y;
-    _dirty = true;
+    afterMove();
 }
 
 glm::vec2 Transformable::getPosition() const
@@ -45,6 +91,25 @@ glm::mat4 &Transformable::getTransform()
     return _transform;
 }
 
+glm::vec2 Transformable::getRenderPosition() const
+{
+    /* Only objects that moved during the last step have anything to blend. */
+    if (_step != sSimStep) {
+        return _position;
+    }
+
+    return _prevPosition + (_position - _prevPosition) * sAlpha;
+}
+
+glm::mat4 Transformable::getRenderTransform()
+{
+    if (_step != sSimStep || _prevPosition == _position) {
+        return getTransform();
+    }
+
+    return glm::translate(glm::vec3 {getRenderPosition(), 0.0f}) * glm::scale(_scale);
+}
+
 void Transformable::setSize(float x, float y)
 {
     _scale = {x, y, 1.0f};
@@ -1,6 +1,7 @@
 #ifndef BTY_GFX_TRANSFORMABLE_HPP_
 #define BTY_GFX_TRANSFORMABLE_HPP_
 
+#include <cstdint>
 #include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
@@ -22,13 +23,29 @@ public:
     glm::vec2 getSize() const;
     glm::mat4 &getTransform();
 
+    /* Position and transform blended between the start and end of the last
+        simulation step, for drawing. Outside of a step, moves are immediate. */
+    glm::vec2 getRenderPosition() const;
+    glm::mat4 getRenderTransform();
+    void snap();
+
+    static void beginSimStep();
+    static void endSimStep();
+    static void setInterpolation(float alpha);
+
 protected:
     glm::vec3 _position {0.0f};
     glm::vec3 _scale {1.0f};
 
+private:
+    void beforeMove();
+    void afterMove();
+
 private:
     glm::mat4 _transform {1.0f};
     bool _dirty {false};
+    glm::vec3 _prevPosition {0.0f};
+    uint32_t _step {0};
 };
 
 }    // namespace bty
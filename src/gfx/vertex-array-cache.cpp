@@ -0,0 +1,66 @@
+#include "gfx/vertex-array-cache.hpp"
+
+#include "gfx/command-recorder.hpp"
+
+namespace bty {
+
+uint64_t VertexArrayCache::key(GLuint vbo, VertexLayout layout)
+{
+    return (static_cast<uint64_t>(vbo) << 8) | static_cast<uint64_t>(layout);
+}
+
+GLuint VertexArrayCache::get(GLuint vbo, VertexLayout layout)
+{
+    auto [it, inserted] = _vaos.try_emplace(key(vbo, layout), GL_NONE);
+    if (!inserted) {
+        return it->second;
+    }
+
+    GLuint vao = GL_NONE;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    switch (layout) {
+        case VertexLayout::Pos2:
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, nullptr);
+            glEnableVertexAttribArray(0);
+            break;
+        case VertexLayout::Pos2Uv2:
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4, nullptr);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4, (const void *)(sizeof(GLfloat) * 2));
+            glEnableVertexAttribArray(0);
+            glEnableVertexAttribArray(1);
+            break;
+    }
+
+    glBindVertexArray(GL_NONE);
+    glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+
+    it->second = vao;
+    return vao;
+}
+
+void VertexArrayCache::release(GLuint vbo)
+{
+    for (auto layout : {VertexLayout::Pos2, VertexLayout::Pos2Uv2}) {
+        auto it = _vaos.find(key(vbo, layout));
+        if (it != _vaos.end()) {
+            Recorder::instance().forgetVertexArray(it->second);
+            glDeleteVertexArrays(1, &it->second);
+            _vaos.erase(it);
+        }
+    }
+    Recorder::instance().forgetBuffer(vbo);
+}
+
+void VertexArrayCache::clear()
+{
+    for (auto &[k, vao] : _vaos) {
+        Recorder::instance().forgetVertexArray(vao);
+        glDeleteVertexArrays(1, &vao);
+    }
+    _vaos.clear();
+}
+
+}    // namespace bty
@@ -0,0 +1,29 @@
+#ifndef BTY_GFX_VERTEX_ARRAY_CACHE_HPP_
+#define BTY_GFX_VERTEX_ARRAY_CACHE_HPP_
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "gfx/gl.hpp"
+#include "gfx/render-snapshot.hpp"
+
+namespace bty {
+
+/* Vertex arrays are the one object type contexts don't share, so the
+    context that draws builds its own from a buffer and a layout. */
+class VertexArrayCache {
+public:
+    GLuint get(GLuint vbo, VertexLayout layout);
+    void release(GLuint vbo);
+    void clear();
+
+private:
+    static uint64_t key(GLuint vbo, VertexLayout layout);
+
+private:
+    std::unordered_map<uint64_t, GLuint> _vaos;
+};
+
+}    // namespace bty
+
+#endif    // BTY_GFX_VERTEX_ARRAY_CACHE_HPP_
@@ -1,8 +1,17 @@
 #include <spdlog/spdlog.h>
 
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 
+#include "engine/alloc-tracker.hpp"
 #include "engine/engine.hpp"
+#include "engine/job-system.hpp"
+#include "engine/metrics-server.hpp"
+#include "engine/profiler.hpp"
+#include "engine/telemetry.hpp"
+#include "game/state-mirror.hpp"
+#include "gfx/gpu-registry.hpp"
 #include "window/glfw.hpp"
 #include "window/window.hpp"
 
@@ -37,8 +46,47 @@ int main(int argc, char *argv[])
 
     spdlog::info("Using base path '{}'", base_path);
 
-    (void)argc;
-    (void)argv;
+    /* --workers=N caps the job system, e.g. when sharing a machine.
+        --trace-startup=N traces from here to the end of the Nth frame.
+        --strict-allocs reports heap allocations made while walking the
+        overworld and fails the run if there were any.
+        --telemetry writes gameplay events to telemetry/.
+        --metrics=PORT or --metrics=/path/to.sock serves Prometheus metrics
+        on localhost or a Unix socket.
+        --shared-state=NAME mirrors the game state into shared memory. */
+    int numWorkers = -1;
+    int traceStartupFrames = 0;
+    bool telemetry = false;
+    std::string metricsAddress;
+    std::string sharedStateName;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--workers=", 10) == 0) {
+            numWorkers = std::atoi(argv[i] + 10);
+        }
+        else if (std::strncmp(argv[i], "--trace-startup=", 16) == 0) {
+            traceStartupFrames = std::atoi(argv[i] + 16);
+        }
+        else if (std::strcmp(argv[i], "--strict-allocs") == 0) {
+            if (!bty::AllocTracker::kCompiledIn) {
+                spdlog::warn("--strict-allocs needs a build with BTY_TRACK_ALLOCS");
+            }
+            bty::AllocTracker::setStrict(true);
+        }
+        else if (std::strcmp(argv[i], "--telemetry") == 0) {
+            telemetry = true;
+        }
+        else if (std::strncmp(argv[i], "--metrics=", 10) == 0) {
+            metricsAddress = argv[i] + 10;
+        }
+        else if (std::strncmp(argv[i], "--shared-state=", 15) == 0) {
+            sharedStateName = argv[i] + 15;
+        }
+    }
+
+    Profile::instance().setThreadName("Main");
+    if (traceStartupFrames > 0) {
+        Profile::instance().capture("traces/startup.json", traceStartupFrames);
+    }
 
     spdlog::default_logger()->set_level(spdlog::level::debug);
 
@@ -52,6 +100,18 @@ int main(int argc, char *argv[])
     glDebugMessageCallback(glDebugOutput, nullptr);
     glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
 
+    Jobs::instance().init(numWorkers);
+
+    if (telemetry) {
+        Telemetry::instance().init("telemetry");
+    }
+    if (!metricsAddress.empty()) {
+        Metrics::instance().init(metricsAddress);
+    }
+    if (!sharedStateName.empty()) {
+        SharedState::instance().init(sharedStateName);
+    }
+
     Textures::instance().init(base_path);
     {
         bty::Engine engine(*window);
@@ -59,8 +119,25 @@ int main(int argc, char *argv[])
     }
     Textures::instance().deinit();
 
+    Telemetry::instance().deinit();
+    Metrics::instance().deinit();
+    SharedState::instance().deinit();
+
+    Jobs::instance().dump();
+    Jobs::instance().deinit();
+
+    /* Gfx is a static singleton, so its shaders and quad are expected here. */
+    GpuResources::instance().dump();
+
     window_free(window);
 
+    bty::AllocTracker::dump();
+
+    if (bty::AllocTracker::strict() && bty::AllocTracker::numViolations() > 0) {
+        spdlog::error("{} allocations while walking the overworld", bty::AllocTracker::numViolations());
+        return 1;
+    }
+
     return 0;
 }
 
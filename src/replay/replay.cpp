@@ -0,0 +1,575 @@
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/capture-format.hpp"
+#include "window/glfw.hpp"
+
+/* bounty-replay: plays back a .btyc capture written by the F2 recorder in the
+    game, without any game code, and reports per-frame timings. Usage:
+
+        bounty-replay <capture.btyc> [iterations]
+*/
+
+namespace {
+
+struct Command {
+    bty::CaptureOp op;
+    GLuint object {GL_NONE};
+    GLint location {-1};
+    GLint i[3] {};
+    std::array<GLfloat, 16> f {};
+};
+
+struct Stats {
+    double min {1e9};
+    double max {0};
+    double total {0};
+    int count {0};
+
+    void add(double ms)
+    {
+        min = std::min(min, ms);
+        max = std::max(max, ms);
+        total += ms;
+        count++;
+    }
+
+    double mean() const
+    {
+        return count ? total / count : 0;
+    }
+};
+
+class Reader {
+public:
+    Reader(const std::vector<char> &data, size_t offset)
+        : _data(data)
+        , _pos(offset)
+    {
+    }
+
+    bool good() const
+    {
+        return _good;
+    }
+
+    bool done() const
+    {
+        return _pos >= _data.size();
+    }
+
+    template <typename T>
+    T read()
+    {
+        T value {};
+        read(&value, sizeof(T));
+        return value;
+    }
+
+    void read(void *out, size_t size)
+    {
+        if (_pos + size > _data.size()) {
+            _good = false;
+            _pos = _data.size();
+            return;
+        }
+        std::memcpy(out, _data.data() + _pos, size);
+        _pos += size;
+    }
+
+    std::string readString()
+    {
+        auto length = read<uint32_t>();
+        std::string str(length, '\0');
+        read(str.data(), length);
+        return str;
+    }
+
+private:
+    const std::vector<char> &_data;
+    size_t _pos;
+    bool _good {true};
+};
+
+/* Resources may be recaptured mid-stream (a Text changed, a map tile was
+    replaced). Each definition creates a fresh object, and commands are bound
+    to whatever was live at that point in the stream. */
+class Replay {
+public:
+    ~Replay()
+    {
+        for (auto program : _programs) {
+            glDeleteProgram(program);
+        }
+        glDeleteTextures(static_cast<GLsizei>(_textures.size()), _textures.data());
+        glDeleteBuffers(static_cast<GLsizei>(_buffers.size()), _buffers.data());
+        glDeleteVertexArrays(static_cast<GLsizei>(_vaos.size()), _vaos.data());
+    }
+
+    bool parse(const std::vector<char> &data)
+    {
+        Reader r(data, sizeof(bty::CaptureHeader));
+
+        while (!r.done() && r.good()) {
+            auto op = static_cast<bty::CaptureOp>(r.read<uint8_t>());
+            Command cmd {op};
+
+            switch (op) {
+                case bty::CaptureOp::FrameBegin:
+                    _frames.push_back(_commands.size());
+                    break;
+                case bty::CaptureOp::FrameEnd:
+                    _frameEnds.push_back(_commands.size());
+                    break;
+                case bty::CaptureOp::Program:
+                    if (!createProgram(r)) {
+                        return false;
+                    }
+                    break;
+                case bty::CaptureOp::Texture:
+                    createTexture(r);
+                    break;
+                case bty::CaptureOp::Buffer:
+                    createBuffer(r);
+                    break;
+                case bty::CaptureOp::VertexArray:
+                    createVertexArray(r);
+                    break;
+                case bty::CaptureOp::Clear:
+                    r.read(cmd.f.data(), sizeof(GLfloat) * 4);
+                    _commands.push_back(cmd);
+                    break;
+                case bty::CaptureOp::UseProgram:
+                    cmd.object = resolve(_programMap, r.read<uint32_t>());
+                    _commands.push_back(cmd);
+                    break;
+                case bty::CaptureOp::UniformMat4:
+                case bty::CaptureOp::Uniform1i:
+                case bty::CaptureOp::Uniform2f:
+                case bty::CaptureOp::Uniform4f: {
+                    auto program = r.read<uint32_t>();
+                    auto location = r.read<int32_t>();
+                    cmd.object = resolve(_programMap, program);
+                    cmd.location = resolveLocation(program, location);
+                    if (op == bty::CaptureOp::Uniform1i) {
+                        cmd.i[0] = r.read<int32_t>();
+                    }
+                    else {
+                        int n = op == bty::CaptureOp::UniformMat4 ? 16 : op == bty::CaptureOp::Uniform4f ? 4 : 2;
+                        r.read(cmd.f.data(), sizeof(GLfloat) * n);
+                    }
+                    _commands.push_back(cmd);
+                    break;
+                }
+                case bty::CaptureOp::BindTexture:
+                    cmd.i[0] = r.read<uint32_t>();
+                    cmd.object = resolve(_textureMap, r.read<uint32_t>());
+                    _commands.push_back(cmd);
+                    break;
+                case bty::CaptureOp::BindVertexArray:
+                    cmd.object = resolve(_vaoMap, r.read<uint32_t>());
+                    _commands.push_back(cmd);
+                    break;
+                case bty::CaptureOp::DrawArrays:
+                    cmd.i[0] = r.read<uint32_t>();
+                    cmd.i[1] = r.read<int32_t>();
+                    cmd.i[2] = r.read<int32_t>();
+                    _commands.push_back(cmd);
+                    break;
+                case bty::CaptureOp::End:
+                    return true;
+                default:
+                    spdlog::error("Unknown capture op {}", static_cast<int>(op));
+                    return false;
+            }
+        }
+
+        if (!r.good()) {
+            spdlog::error("Capture is truncated");
+            return false;
+        }
+
+        return true;
+    }
+
+    int numFrames() const
+    {
+        return static_cast<int>(std::min(_frames.size(), _frameEnds.size()));
+    }
+
+    int numCommands(int frame) const
+    {
+        return static_cast<int>(_frameEnds[frame] - _frames[frame]);
+    }
+
+    void execute(int frame) const
+    {
+        for (size_t i = _frames[frame]; i < _frameEnds[frame]; i++) {
+            const auto &cmd = _commands[i];
+            switch (cmd.op) {
+                case bty::CaptureOp::Clear:
+                    glClearColor(cmd.f[0], cmd.f[1], cmd.f[2], cmd.f[3]);
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    break;
+                case bty::CaptureOp::UseProgram:
+                    glUseProgram(cmd.object);
+                    break;
+                case bty::CaptureOp::UniformMat4:
+                    glProgramUniformMatrix4fv(cmd.object, cmd.location, 1, GL_FALSE, cmd.f.data());
+                    break;
+                case bty::CaptureOp::Uniform1i:
+                    glProgramUniform1i(cmd.object, cmd.location, cmd.i[0]);
+                    break;
+                case bty::CaptureOp::Uniform2f:
+                    glProgramUniform2fv(cmd.object, cmd.location, 1, cmd.f.data());
+                    break;
+                case bty::CaptureOp::Uniform4f:
+                    glProgramUniform4fv(cmd.object, cmd.location, 1, cmd.f.data());
+                    break;
+                case bty::CaptureOp::BindTexture:
+                    glBindTextureUnit(cmd.i[0], cmd.object);
+                    break;
+                case bty::CaptureOp::BindVertexArray:
+                    glBindVertexArray(cmd.object);
+                    break;
+                case bty::CaptureOp::DrawArrays:
+                    glDrawArrays(cmd.i[0], cmd.i[1], cmd.i[2]);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+private:
+    GLuint resolve(const std::unordered_map<GLuint, GLuint> &map, GLuint id) const
+    {
+        if (id == GL_NONE) {
+            return GL_NONE;
+        }
+        auto it = map.find(id);
+        if (it == map.end()) {
+            spdlog::warn("Capture references undefined object {}", id);
+            return GL_NONE;
+        }
+        return it->second;
+    }
+
+    GLint resolveLocation(GLuint program, GLint location) const
+    {
+        auto it = _locationMap.find(program);
+        if (it == _locationMap.end()) {
+            return -1;
+        }
+        auto loc = it->second.find(location);
+        return loc == it->second.end() ? -1 : loc->second;
+    }
+
+    bool createProgram(Reader &r)
+    {
+        auto id = r.read<uint32_t>();
+        auto vsSrc = r.readString();
+        auto fsSrc = r.readString();
+
+        GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+        GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+        const char *vsPtr = vsSrc.c_str();
+        const char *fsPtr = fsSrc.c_str();
+        glShaderSource(vs, 1, &vsPtr, nullptr);
+        glShaderSource(fs, 1, &fsPtr, nullptr);
+        glCompileShader(vs);
+        glCompileShader(fs);
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        glLinkProgram(program);
+        glDetachShader(program, vs);
+        glDetachShader(program, fs);
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            spdlog::error("Failed to link captured program {}", id);
+            glDeleteProgram(program);
+            return false;
+        }
+
+        auto &locations = _locationMap[id];
+        locations.clear();
+        auto numUniforms = r.read<uint32_t>();
+        for (uint32_t i = 0; i < numUniforms; i++) {
+            auto location = r.read<int32_t>();
+            auto name = r.readString();
+            locations[location] = glGetUniformLocation(program, name.c_str());
+        }
+
+        _programs.push_back(program);
+        _programMap[id] = program;
+        return true;
+    }
+
+    void createTexture(Reader &r)
+    {
+        auto id = r.read<uint32_t>();
+        auto target = r.read<uint32_t>();
+        auto width = r.read<int32_t>();
+        auto height = r.read<int32_t>();
+        auto depth = r.read<int32_t>();
+        auto minFilter = r.read<int32_t>();
+        auto magFilter = r.read<int32_t>();
+        auto wrapS = r.read<int32_t>();
+        auto wrapT = r.read<int32_t>();
+        auto size = r.read<uint32_t>();
+        std::vector<char> pixels(size);
+        r.read(pixels.data(), size);
+
+        GLuint texture = GL_NONE;
+        glCreateTextures(target, 1, &texture);
+
+        if (target == GL_TEXTURE_2D_ARRAY) {
+            glTextureStorage3D(texture, 1, GL_RGBA8, width, height, depth);
+            glTextureSubImage3D(texture, 0, 0, 0, 0, width, height, depth, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        }
+        else {
+            glTextureStorage2D(texture, 1, GL_RGBA8, width, height);
+            glTextureSubImage2D(texture, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        }
+
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, minFilter);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, magFilter);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_S, wrapS);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_T, wrapT);
+
+        _textures.push_back(texture);
+        _textureMap[id] = texture;
+    }
+
+    void createBuffer(Reader &r)
+    {
+        auto id = r.read<uint32_t>();
+        auto size = r.read<uint32_t>();
+        std::vector<char> data(size);
+        r.read(data.data(), size);
+
+        GLuint buffer = GL_NONE;
+        glCreateBuffers(1, &buffer);
+        glNamedBufferData(buffer, size, data.data(), GL_STATIC_DRAW);
+
+        _buffers.push_back(buffer);
+        _bufferMap[id] = buffer;
+    }
+
+    void createVertexArray(Reader &r)
+    {
+        auto id = r.read<uint32_t>();
+        auto numAttribs = r.read<uint32_t>();
+
+        GLuint vao = GL_NONE;
+        glCreateVertexArrays(1, &vao);
+
+        for (uint32_t i = 0; i < numAttribs; i++) {
+            auto index = r.read<uint32_t>();
+            auto size = r.read<int32_t>();
+            auto type = r.read<uint32_t>();
+            auto stride = r.read<int32_t>();
+            auto offset = r.read<uint32_t>();
+            auto buffer = r.read<uint32_t>();
+
+            /* glVertexAttribPointer treats 0 as tightly packed, the DSA
+                binding does not. Every attribute in the game is float. */
+            if (stride == 0) {
+                stride = size * static_cast<int32_t>(sizeof(GLfloat));
+            }
+
+            glEnableVertexArrayAttrib(vao, index);
+            glVertexArrayAttribFormat(vao, index, size, type, GL_FALSE, 0);
+            glVertexArrayVertexBuffer(vao, index, resolve(_bufferMap, buffer), offset, stride);
+            glVertexArrayAttribBinding(vao, index, index);
+        }
+
+        _vaos.push_back(vao);
+        _vaoMap[id] = vao;
+    }
+
+private:
+    std::vector<Command> _commands;
+    std::vector<size_t> _frames;
+    std::vector<size_t> _frameEnds;
+
+    std::vector<GLuint> _programs;
+    std::vector<GLuint> _textures;
+    std::vector<GLuint> _buffers;
+    std::vector<GLuint> _vaos;
+
+    std::unordered_map<GLuint, GLuint> _programMap;
+    std::unordered_map<GLuint, GLuint> _textureMap;
+    std::unordered_map<GLuint, GLuint> _bufferMap;
+    std::unordered_map<GLuint, GLuint> _vaoMap;
+    std::unordered_map<GLuint, std::unordered_map<GLint, GLint>> _locationMap;
+};
+
+bool readCapture(const std::string &path, std::vector<char> &data, bty::CaptureHeader &header)
+{
+    std::ifstream f(path, std::ios::in | std::ios::binary);
+
+    if (!f.good()) {
+        spdlog::error("Failed to open '{}'", path);
+        return false;
+    }
+
+    f.seekg(0, std::ios::end);
+    data.resize(f.tellg());
+    f.seekg(0);
+    f.read(data.data(), data.size());
+
+    if (data.size() < sizeof(header)) {
+        spdlog::error("'{}' is too small to be a capture", path);
+        return false;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, bty::kCaptureMagic, sizeof(header.magic)) != 0) {
+        spdlog::error("'{}' is not a capture", path);
+        return false;
+    }
+
+    if (header.version != bty::kCaptureVersion) {
+        spdlog::error("'{}' has version {}, expected {}", path, header.version, bty::kCaptureVersion);
+        return false;
+    }
+
+    return true;
+}
+
+}    // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        spdlog::error("Usage: {} <capture.btyc> [iterations]", argv[0]);
+        return 1;
+    }
+
+    const std::string path = argv[1];
+    const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+
+    std::vector<char> data;
+    bty::CaptureHeader header;
+    if (!readCapture(path, data, header)) {
+        return 1;
+    }
+
+    if (glfwInit() == GLFW_FALSE) {
+        spdlog::error("glfwInit failed");
+        return 1;
+    }
+
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+
+    GLFWwindow *window = glfwCreateWindow(header.width, header.height, "Bounty Replay", nullptr, nullptr);
+    if (!window) {
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    glewExperimental = GL_TRUE;
+    auto err = glewInit();
+    if (err != GLEW_OK) {
+        spdlog::error("glewInit failed: {}", reinterpret_cast<const char *>(glewGetErrorString(err)));
+        glfwTerminate();
+        return 1;
+    }
+
+    /* Fixed state set once by Gfx::initGLState, not part of the stream. */
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    int result = 0;
+
+    {
+        Replay replay;
+
+        if (!replay.parse(data)) {
+            result = 1;
+        }
+        else if (replay.numFrames() == 0) {
+            spdlog::error("'{}' contains no frames", path);
+            result = 1;
+        }
+        else {
+            using namespace std::chrono;
+
+            data.clear();
+            data.shrink_to_fit();
+
+            spdlog::info("Replaying {} frame(s) x {} iterations at {}x{}", replay.numFrames(), iterations, header.width, header.height);
+
+            std::vector<Stats> cpu(replay.numFrames());
+            std::vector<Stats> gpu(replay.numFrames());
+
+            GLuint query = GL_NONE;
+            glGenQueries(1, &query);
+
+            for (int i = 0; i < iterations && !glfwWindowShouldClose(window); i++) {
+                for (int frame = 0; frame < replay.numFrames(); frame++) {
+                    glBeginQuery(GL_TIME_ELAPSED, query);
+
+                    auto start = steady_clock::now();
+                    replay.execute(frame);
+                    auto submitted = steady_clock::now();
+
+                    glEndQuery(GL_TIME_ELAPSED);
+                    glFinish();
+
+                    GLuint64 elapsed = 0;
+                    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+
+                    cpu[frame].add(duration<double, std::milli>(submitted - start).count());
+                    gpu[frame].add(static_cast<double>(elapsed) / 1e6);
+
+                    glfwSwapBuffers(window);
+                    glfwPollEvents();
+                }
+            }
+
+            glDeleteQueries(1, &query);
+
+            for (int frame = 0; frame < replay.numFrames(); frame++) {
+                spdlog::info("Frame {} ({} commands): cpu min {:.3f} mean {:.3f} max {:.3f} ms | gpu min {:.3f} mean {:.3f} max {:.3f} ms",
+                             frame,
+                             replay.numCommands(frame),
+                             cpu[frame].min,
+                             cpu[frame].mean(),
+                             cpu[frame].max,
+                             gpu[frame].min,
+                             gpu[frame].mean(),
+                             gpu[frame].max);
+            }
+        }
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return result;
+}
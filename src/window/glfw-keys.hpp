@@ -14,8 +14,11 @@ enum Key {
     K = GLFW_KEY_K,
     L = GLFW_KEY_L,
     R = GLFW_KEY_R,
+    T = GLFW_KEY_T,
     Q = GLFW_KEY_Q,
     V = GLFW_KEY_V,
+    Minus = GLFW_KEY_MINUS,
+    Equal = GLFW_KEY_EQUAL,
     Left = GLFW_KEY_LEFT,
     Right = GLFW_KEY_RIGHT,
     Up = GLFW_KEY_UP,
@@ -24,6 +27,10 @@ enum Key {
     Enter = GLFW_KEY_ENTER,
     Backspace = GLFW_KEY_BACKSPACE,
     F1 = GLFW_KEY_F1,
+    F2 = GLFW_KEY_F2,
+    F3 = GLFW_KEY_F3,
+    F4 = GLFW_KEY_F4,
+    F5 = GLFW_KEY_F5,
 };
 
 #endif    // BTY_WINDOW_GLFW_KEYS_HPP
@@ -1,10 +1,23 @@
 #include "window/window-engine-interface.hpp"
 
+#include <spdlog/spdlog.h>
+
 #include "engine/engine.hpp"
 #include "engine/events.hpp"
 
 namespace bty {
 
+static void queueEvent(GLFWwindow* window, const Event& event)
+{
+    auto* input = static_cast<InputHandler*>(glfwGetWindowUserPointer(window));
+
+    if (!input->events.push({event, std::chrono::steady_clock::now()})) {
+        /* Better late-ordered than lost. */
+        spdlog::warn("Input queue full, handling event immediately");
+        input->engine->event(event);
+    }
+}
+
 void key(GLFWwindow* window, int key, int, int action, int)
 {
     Event event;
@@ -21,7 +34,7 @@ void key(GLFWwindow* window, int key, int, int action, int)
             return;
     }
 
-    static_cast<InputHandler*>(glfwGetWindowUserPointer(window))->engine->event(event);
+    queueEvent(window, event);
 }
 
 void close(GLFWwindow* window)
@@ -29,7 +42,7 @@ void close(GLFWwindow* window)
     Event event;
     event.id = EventId::Quit;
 
-    static_cast<InputHandler*>(glfwGetWindowUserPointer(window))->engine->event(event);
+    queueEvent(window, event);
 }
 
 }    // namespace bty
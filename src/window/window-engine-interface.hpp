@@ -1,6 +1,10 @@
 #ifndef BTY_WINDOW_WINDOW_ENGINE_INTERFACE_HPP_
 #define BTY_WINDOW_WINDOW_ENGINE_INTERFACE_HPP_
 
+#include <chrono>
+
+#include "engine/events.hpp"
+#include "engine/spsc-ring.hpp"
 #include "glfw.hpp"
 
 namespace bty {
@@ -10,9 +14,16 @@ class Engine;
 void key(GLFWwindow *window, int key, int scancode, int action, int mods);
 void close(GLFWwindow *window);
 
-/* GLFW -> static key callback -> InputHandler.key -> Engine.key */
+struct InputEvent {
+    Event event;
+    std::chrono::steady_clock::time_point time;
+};
+
+/* GLFW -> static key callback -> InputHandler.events, drained by the Engine
+    at a fixed point in the frame. */
 struct InputHandler {
     Engine *engine;
+    SpscRing<InputEvent, 256> events {};
 };
 
 }    // namespace bty
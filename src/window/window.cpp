@@ -2,6 +2,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include "engine/profiler.hpp"
 #include "window/window-engine-interface.hpp"
 
 namespace bty {
@@ -34,6 +35,8 @@ void window_error(int error_code, const char *description)
 
 Window *window_init()
 {
+    BTY_PROFILE_ZONE("window_init");
+
     glfwSetErrorCallback(window_error);
 
     if (glfwInit() == GLFW_FALSE) {
@@ -77,6 +80,7 @@ Window *window_init()
 void window_free(Window *window)
 {
     if (window) {
+        window_destroy_shared_context(window);
         glfwDestroyWindow(window->handle);
         delete window;
     }
@@ -101,6 +105,43 @@ void window_swap(Window *window)
     glfwSwapBuffers(window->handle);
 }
 
+bool window_create_shared_context(Window *window)
+{
+    if (window->shared) {
+        return true;
+    }
+
+    /* Other hints are left as they were for the main window. */
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window->shared = glfwCreateWindow(1, 1, "Bounty", nullptr, window->handle);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if (!window->shared) {
+        spdlog::warn("Failed to create shared context");
+        return false;
+    }
+
+    return true;
+}
+
+void window_destroy_shared_context(Window *window)
+{
+    if (window->shared) {
+        glfwDestroyWindow(window->shared);
+        window->shared = nullptr;
+    }
+}
+
+void window_make_current(Window *window, bool shared)
+{
+    glfwMakeContextCurrent(shared ? window->shared : window->handle);
+}
+
+void window_release_current()
+{
+    glfwMakeContextCurrent(nullptr);
+}
+
 int window_width(Window *window)
 {
     int w, h;
@@ -7,6 +7,9 @@ namespace bty {
 
 struct Window {
     GLFWwindow *handle;
+    /* Hidden window whose context shares objects with handle's, so GL
+        objects can be created on a thread other than the one drawing. */
+    GLFWwindow *shared {nullptr};
 };
 
 struct InputHandler;
@@ -16,6 +19,10 @@ void window_free(Window *window);
 void window_events(Window *window);
 void window_init_callbacks(Window *window, InputHandler *input);
 void window_swap(Window *window);
+bool window_create_shared_context(Window *window);
+void window_destroy_shared_context(Window *window);
+void window_make_current(Window *window, bool shared);
+void window_release_current();
 int window_width(Window *window);
 int window_height(Window *window);
 